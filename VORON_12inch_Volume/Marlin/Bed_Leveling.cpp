@@ -25,6 +25,11 @@
 
 #if ENABLED(UNIFIED_BED_LEVELING_FEATURE)
 #include "Bed_Leveling.h"
+#include "configuration_store.h"
+#if ENABLED(UBL_SD_MESHES)
+  #include "cardreader.h"
+  #include "temperature.h"
+#endif
 
 
 // These variables used to be declared inside the bed_leveling class.  We are going to still declare
@@ -36,6 +41,10 @@
 float last_specified_z;
 float fade_scaling_factor_for_current_height;
 float z_values[MESH_NUM_X_POINTS][MESH_NUM_Y_POINTS];
+#if ENABLED(SMART_PROBING)
+uint8_t z_samples[MESH_NUM_X_POINTS][MESH_NUM_Y_POINTS];
+uint8_t z_spread[MESH_NUM_X_POINTS][MESH_NUM_Y_POINTS];
+#endif
 float mesh_index_to_X_location[MESH_NUM_X_POINTS+1];	// +1 just because of paranoia that we might end up on the
 float mesh_index_to_Y_location[MESH_NUM_Y_POINTS+1];	// the last Mesh Line and that is the start of a whole new cell
 
@@ -53,16 +62,22 @@ bed_leveling::bed_leveling()    {
 
 
 void bed_leveling::store_state()    {
-int k;
-	k = E2END - sizeof( blm.state );
-	eeprom_write_block( (void *) &blm.state , (void *) k, sizeof(blm.state) );
+	eeprom_record_write( EEPROM_RECORD_UBL_STATE, 0, UBL_STATE_VERSION, &blm.state, sizeof(blm.state) );
 	return;
 }
 
 void bed_leveling::load_state()    {
 int k;
-	k = E2END - sizeof( blm.state );
-	eeprom_read_block( (void *) &blm.state , (void *) k, sizeof(blm.state) );
+uint8_t version;
+uint16_t length;
+
+	blm.state = blm.pre_initialized;		// Anything the stored state doesn't cover keeps its default
+	k = eeprom_record_find( EEPROM_RECORD_UBL_STATE, 0, version, length );
+	if ( k < 0 || version != UBL_STATE_VERSION ) {
+	   SERIAL_PROTOCOLLNPGM("?No UBL state stored.  Using defaults.\n");
+	   return;
+	}
+	eeprom_read_block( (void *) &blm.state , (void *) k, min( length, sizeof(blm.state) ) );
 	if ( this->sanity_check() != 0 ) {
 	   SERIAL_PROTOCOLLNPGM("?In load_state() sanity_check() failed. \n");
 	}
@@ -76,10 +91,25 @@ int k;
 	return;
 }
 
+//
+// Where in the EEPROM the Mesh stored in slot m is, or -1 if there isn't one that fits
+// the current Mesh size.
+//
+int bed_leveling::mesh_address(int m) {
+uint8_t version;
+uint16_t length;
+int k;
+
+	if ( m < 0 || m >= EEPROM_MESH_SLOTS )
+		return -1;
+	k = eeprom_record_find( EEPROM_RECORD_MESH, m, version, length );
+	if ( k < 0 || version != UBL_MESH_VERSION || length != sizeof( z_values ) )
+		return -1;
+	return k;
+}
+
 void bed_leveling::load_mesh(int m) {
-int j, k;
-	k = E2END - sizeof( blm.state );
-	j = (k - Unified_Bed_Leveling_EEPROM_start) / sizeof( z_values );
+int j;
 
 	if ( m == -1 ) {
 		SERIAL_PROTOCOLLNPGM("?No mesh saved in EEPROM.  Zeroing mesh in memory.\n");
@@ -87,13 +117,16 @@ int j, k;
 		return;
 	}
 
-	if ( m<0 || m>=j || Unified_Bed_Leveling_EEPROM_start<=0) {
-		SERIAL_PROTOCOLLNPGM("?EEPROM storage not available to load mesh.\n");
+	j = mesh_address( m );
+	if ( j < 0 ) {
+		SERIAL_PROTOCOLLNPGM("?No Mesh of this size stored in that slot.\n");
 		return;
 	}
 
-	j = k-(m+1)*sizeof(z_values);	
 	eeprom_read_block( (void *) &z_values , (void *) j, sizeof(z_values) );
+#if ENABLED(SMART_PROBING)
+	memset( z_samples, 0, sizeof(z_samples) );	// We don't know how a stored Mesh was probed
+#endif
 
 	SERIAL_PROTOCOLPGM("Mesh loaded from slot ");
 	SERIAL_PROTOCOL( m );
@@ -102,40 +135,275 @@ int j, k;
 	SERIAL_PROTOCOLPGM("\n");
 }
 
-void bed_leveling:: store_mesh(int m) {
-int j, k;
-
-	k = E2END - sizeof( state );
-	j = (k - Unified_Bed_Leveling_EEPROM_start) / sizeof( z_values );
-
-	if ( m<0 || m>=j || Unified_Bed_Leveling_EEPROM_start<=0) {
-		SERIAL_PROTOCOLLNPGM("?EEPROM storage not available to load mesh.\n");
-SERIAL_PROTOCOL(m);
-SERIAL_PROTOCOL(" mesh slots available.\n"  );
-SERIAL_PROTOCOLPAIR("\nE2END     : ", E2END  );
-SERIAL_PROTOCOLPAIR("\nk         : ", k  );
-SERIAL_PROTOCOLPAIR("\nj         : ", j  );
-SERIAL_PROTOCOLPAIR("\nm         : ", m  );
-SERIAL_PROTOCOL("\n");
-		return;
+bool bed_leveling:: store_mesh(int m) {
+millis_t started;
+
+	if ( m<0 || m>=EEPROM_MESH_SLOTS ) {
+		SERIAL_PROTOCOLLNPGM("?EEPROM storage not available to store mesh.\n");
+		return false;
 	}
 
-	j = k-(m+1)*sizeof( z_values);	
-	eeprom_write_block( (const void *) &z_values , (void *) j, sizeof(z_values) );
+	started = millis();
+	eeprom_bytes_written = 0;
+	if ( !eeprom_record_write( EEPROM_RECORD_MESH, m, UBL_MESH_VERSION, &z_values, sizeof(z_values) ) ) {
+		SERIAL_PROTOCOLLNPGM("?Mesh not saved.\n");
+		return false;
+	}
 
 	SERIAL_PROTOCOLPGM("Mesh saved in slot ");
 	SERIAL_PROTOCOL( m );
 	SERIAL_PROTOCOLPGM("  at offset 0x");
-	prt_hex_word(j);
-	SERIAL_PROTOCOLPGM("\n");
+	prt_hex_word( mesh_address( m ) );
+	SERIAL_PROTOCOLPAIR("  (", eeprom_bytes_written );		// Includes any records moved to make room
+	SERIAL_PROTOCOLPAIR(" bytes written, ", millis() - started );
+	SERIAL_PROTOCOLPGM(" ms)\n");
+	return true;
+}
+
+#if ENABLED(UBL_MESH_BANK)
+
+//
+// Select the Mesh for a bed temperature.  The stored Meshes that were probed nearest to the
+// requested temperature on either side of it are found.  If only one side has a Mesh (or the
+// temperature matches one exactly) that Mesh is loaded.  Otherwise the two Meshes are blended
+// point by point in proportion to where the temperature falls between them.   The second Mesh
+// is read straight out of the EEPROM so no extra RAM is needed for it.
+//
+// Returns false if no stored Mesh has a bed temperature recorded against it.
+//
+bool bed_leveling::load_mesh_for_temperature(int temp) {
+int i, j, lo = -1, hi = -1;
+float f, z;
+
+	if ( temp <= 0 || temp == state.mesh_bed_temp )
+		return true;
+
+	for (i = 0; i < UBL_MESH_BANK_SLOTS; i++) {
+		if ( state.mesh_bank_temp[i] <= 0 || mesh_address(i) < 0 )
+			continue;
+		if ( state.mesh_bank_temp[i] <= temp && (lo < 0 || state.mesh_bank_temp[i] > state.mesh_bank_temp[lo]) )
+			lo = i;
+		if ( state.mesh_bank_temp[i] >= temp && (hi < 0 || state.mesh_bank_temp[i] < state.mesh_bank_temp[hi]) )
+			hi = i;
+	}
+
+	if ( lo < 0 && hi < 0 )
+		return false;
+	if ( lo < 0 )
+		lo = hi;
+	if ( hi < 0 || state.mesh_bank_temp[hi] == state.mesh_bank_temp[lo] )
+		hi = lo;
+
+	load_mesh( lo );
+	state.EEPROM_storage_slot = lo;
+
+	if ( hi != lo ) {
+		f = (float) (temp - state.mesh_bank_temp[lo]) / (float) (state.mesh_bank_temp[hi] - state.mesh_bank_temp[lo]);
+		j = mesh_address( hi );
+		for (int x = 0; x < MESH_NUM_X_POINTS; x++)
+			for (int y = 0; y < MESH_NUM_Y_POINTS; y++) {
+				eeprom_read_block( (void *) &z, (void *) (j + (x * MESH_NUM_Y_POINTS + y) * sizeof(float)), sizeof(float) );
+				z_values[x][y] += (z - z_values[x][y]) * f;
+			}
+		state.EEPROM_storage_slot = -1;		// A blended Mesh doesn't belong to any slot.  Don't let M500 or
+							// G29 S overwrite the slot it started from.
+		SERIAL_PROTOCOLPGM("Mesh blended with slot ");
+		SERIAL_PROTOCOL( hi );
+		SERIAL_PROTOCOLPGM(" for ");
+		SERIAL_PROTOCOL( temp );
+		SERIAL_PROTOCOLPGM("C\n");
+	}
+
+	state.mesh_bed_temp = temp;
+	return true;
+}
+
+#endif
+
+#if ENABLED(UBL_SD_MESHES)
+
+//
+// Named Meshes on the SD card.  Each one is a file (see CardReader::openMeshFile()) holding a
+// ubl_sd_mesh_header and z_values[][].  A file starts on a block boundary and up to 11 x 11 Mesh
+// Points fit in the first block along with the header, so a load or a store is a single block
+// transfer of a few milliseconds.  The CRC catches a file that was cut short or damaged.
+//
+
+static bool valid_mesh_name( const char *name ) {
+	if ( name == NULL || *name == '\0' || strlen( name ) > 8 )
+		return false;
+	for (; *name; name++)
+		if ( !isalnum( *name ) && *name != '-' && *name != '_' )
+			return false;
+	return true;
+}
+
+bool bed_leveling::store_mesh_sd(const char *name, uint32_t date) {
+ubl_sd_mesh_header h;
+millis_t started;
+SdFile f;
+bool ok;
+
+	if ( !valid_mesh_name( name ) ) {
+		SERIAL_PROTOCOLLNPGM("?Mesh names are 1 to 8 letters, digits, - or _\n");
+		return false;
+	}
+
+	started = millis();
+	memset( &h, 0, sizeof(h) );
+	h.magic = UBL_SD_MESH_MAGIC;
+	h.version = UBL_SD_MESH_VERSION;
+	h.n_x = MESH_NUM_X_POINTS;
+	h.n_y = MESH_NUM_Y_POINTS;
+#if ENABLED(UBL_MESH_BANK)
+	h.bed_temp = state.mesh_bed_temp;
+#else
+	h.bed_temp = thermalManager.degTargetBed();	// The best guess we have
+#endif
+	h.date = date;
+#if ENABLED(SMART_PROBING)
+	for (int x = 0; x < MESH_NUM_X_POINTS; x++)
+		for (int y = 0; y < MESH_NUM_Y_POINTS; y++)
+			if ( z_samples[x][y] ) {
+				h.probed_points++;
+				h.samples += z_samples[x][y];
+				h.widest_spread = max( h.widest_spread, z_spread[x][y] );
+			}
+#endif
+	eeprom_16_bit_CRC = 0xffff;
+	crc16mp( (void *) &h, offsetof(ubl_sd_mesh_header, crc) );
+	h.crc = crc16mp( (void *) &z_values, sizeof(z_values) );
+
+	if ( !card.openMeshFile( f, name, true ) ) {
+		SERIAL_PROTOCOLLNPGM("?Can't create the Mesh file on the SD card.\n");
+		return false;
+	}
+	ok = f.write( &h, sizeof(h) ) == sizeof(h) && f.write( &z_values, sizeof(z_values) ) == sizeof(z_values);
+	ok = f.close() && ok;
+	if ( !ok ) {
+		SERIAL_PROTOCOLLNPGM("?Mesh file not written completely.\n");
+		return false;
+	}
+
+	SERIAL_PROTOCOLPGM("Mesh saved as ");
+	SERIAL_PROTOCOL( name );
+	SERIAL_PROTOCOLPAIR(" on the SD card  (", millis() - started );
+	SERIAL_PROTOCOLPGM(" ms)\n");
+	return true;
 }
 
+bool bed_leveling::load_mesh_sd(const char *name) {
+ubl_sd_mesh_header h;
+millis_t started;
+uint8_t buf[16];
+int16_t n, k;
+SdFile f;
+bool ok;
+
+	if ( !valid_mesh_name( name ) ) {
+		SERIAL_PROTOCOLLNPGM("?Mesh names are 1 to 8 letters, digits, - or _\n");
+		return false;
+	}
+
+	started = millis();
+	if ( !card.openMeshFile( f, name, false ) ) {
+		SERIAL_PROTOCOLLNPGM("?No Mesh of that name on the SD card.\n");
+		return false;
+	}
+
+	if ( f.read( &h, sizeof(h) ) != sizeof(h) || h.magic != UBL_SD_MESH_MAGIC || h.version != UBL_SD_MESH_VERSION
+	     || h.n_x != MESH_NUM_X_POINTS || h.n_y != MESH_NUM_Y_POINTS ) {
+		f.close();
+		SERIAL_PROTOCOLLNPGM("?That file doesn't hold a Mesh of this size.\n");
+		return false;
+	}
+
+	// Check the CRC before z_values[][] is touched.  The block is in SdFat's cache by now, so reading
+	// the Mesh a second time costs no SD card access.
+	eeprom_16_bit_CRC = 0xffff;
+	crc16mp( (void *) &h, offsetof(ubl_sd_mesh_header, crc) );
+	ok = true;
+	for (n = sizeof(z_values); ok && n > 0; n -= k) {
+		k = min( n, (int16_t) sizeof(buf) );
+		ok = f.read( buf, k ) == k;
+		crc16mp( buf, k );
+	}
+	ok = ok && eeprom_16_bit_CRC == h.crc && f.seekSet( sizeof(h) )
+		&& f.read( &z_values, sizeof(z_values) ) == sizeof(z_values);
+	f.close();
+	if ( !ok ) {
+		SERIAL_PROTOCOLLNPGM("?Mesh file is damaged.\n");
+		return false;
+	}
+
+#if ENABLED(SMART_PROBING)
+	memset( z_samples, 0, sizeof(z_samples) );	// We don't know how a stored Mesh was probed
+#endif
+	state.EEPROM_storage_slot = -1;			// A Mesh from the SD card doesn't belong to any EEPROM slot
+#if ENABLED(UBL_MESH_BANK)
+	state.mesh_bed_temp = h.bed_temp;
+#endif
+
+	SERIAL_PROTOCOLPGM("Mesh ");
+	SERIAL_PROTOCOL( name );
+	SERIAL_PROTOCOLPAIR(" loaded from the SD card  (", millis() - started );
+	SERIAL_PROTOCOLPGM(" ms)\n");
+	return true;
+}
+
+void bed_leveling::list_meshes_sd() {
+ubl_sd_mesh_header h;
+char name[13], *dot;
+SdFile dir, f;
+int n = 0;
+
+	if ( card.openMeshDir( dir ) ) {
+		while ( f.openNext( &dir, O_READ ) ) {
+			if ( f.isFile() && f.read( &h, sizeof(h) ) == sizeof(h) && h.magic == UBL_SD_MESH_MAGIC ) {
+				f.getFilename( name );
+				if ( (dot = strchr( name, '.' )) != NULL )
+					*dot = '\0';
+				SERIAL_PROTOCOLPGM("  ");
+				SERIAL_PROTOCOL( name );
+				SERIAL_ECHOPAIR("  ", h.n_x );
+				SERIAL_ECHOPAIR("x", h.n_y );
+				if ( h.bed_temp > 0 ) {
+					SERIAL_ECHOPAIR("  probed at ", h.bed_temp );
+					SERIAL_PROTOCOLPGM("C");
+				}
+				if ( h.probed_points ) {
+					SERIAL_ECHOPAIR("  ", h.probed_points );
+					SERIAL_ECHOPAIR(" points probed, ", (float) h.samples / h.probed_points );
+					SERIAL_ECHOPAIR(" samples each, widest spread ", h.widest_spread / 1000.0 );
+				}
+				if ( h.date )
+					SERIAL_ECHOPAIR("  date ", h.date );
+				SERIAL_PROTOCOLPGM("\n");
+				n++;
+				idle();
+			}
+			f.close();
+		}
+		dir.close();
+	}
+	SERIAL_PROTOCOL( n );
+	SERIAL_PROTOCOLPGM(" Meshes on the SD card.\n");
+}
+
+#endif
+
 void bed_leveling::reset() {
     this->state.active = 0;
     this->state.z_offset = 0;
+  #if ENABLED(UBL_MESH_BANK)
+    this->state.mesh_bed_temp = 0;
+  #endif
     for (int x=0; x<MESH_NUM_X_POINTS; x++)
 	for (int y=0; y<MESH_NUM_Y_POINTS; y++)
 		z_values[x][y] = 0.0;
+#if ENABLED(SMART_PROBING)
+    memset( z_samples, 0, sizeof(z_samples) );
+#endif
 
     last_specified_z = -999.9;				// We can't pre-initialize these values in the declaration 
     fade_scaling_factor_for_current_height = 0.0;	// due to C++11 constraints  
@@ -152,6 +420,9 @@ SERIAL_EOL;
     for (int x=0; x<MESH_NUM_X_POINTS; x++)
 	for (int y=0; y<MESH_NUM_Y_POINTS; y++)
 		z_values[x][y] = NAN;
+#if ENABLED(SMART_PROBING)
+    memset( z_samples, 0, sizeof(z_samples) );
+#endif
 
     return;
 }
@@ -253,7 +524,7 @@ int i, j;
 }
 
 int bed_leveling::sanity_check() {
-  int j, k, error_flag = 0;
+  int error_flag = 0;
 
 	if (this->state.n_x !=  MESH_NUM_X_POINTS)  {
 	   SERIAL_PROTOCOLLNPGM("?MESH_NUM_X_POINTS set wrong\n");
@@ -295,11 +566,8 @@ int bed_leveling::sanity_check() {
 	   error_flag++;
 	}
 
-	k = E2END - sizeof( blm.state );
-	j = (k - Unified_Bed_Leveling_EEPROM_start) / sizeof( z_values );
-
-	if (j<1) {
-	  SERIAL_PROTOCOLLNPGM("?No EEPROM storage available for a mesh of this size.\n");
+	if ( !eeprom_store_is_ready() ) {
+	  SERIAL_PROTOCOLLNPGM("?No EEPROM storage available for a mesh.\n");
 	  error_flag++;
 	}
 
@@ -279,6 +279,7 @@
                                   // is more than PID_FUNCTIONAL_RANGE then the PID will be shut off and the heater will be set to min/max.
   #define PID_INTEGRAL_DRIVE_MAX PID_MAX  //limit for the integral term
   #define K1 0.95 //smoothing factor within the PID
+  #define PID_FIXED_POINT // Run the hotend and bed PID loops in integer math (gains are derived from Kp, Ki, Kd)
 
   // If you are using a pre-configured hotend then you can use one of the value sets by uncommenting it
   // Ultimaker
@@ -298,6 +299,30 @@
 
 #endif // PIDTEMP
 
+//===========================================================================
+//============================= MPC Settings ================================
+//===========================================================================
+// Model Predictive Control for the hotends. Rather than reacting to the temperature error
+// like PID, MPC keeps a thermal model of each hotend (heater block, sensor lag, losses to
+// ambient, the part fan and the filament being melted) and applies the power the model says
+// is needed to reach and hold the target. Fan and extrusion changes are compensated for
+// before the sensor sees them.
+//
+// Set MPC_HEATER_POWER to the rating of your heater cartridge, then run "M306 T" to measure
+// the rest of the model and M500 to save it. M306 sets and reports the values by hand.
+// MPC replaces PID for the hotends only. The bed keeps using PIDTEMPBED or bang-bang.
+//#define MPCTEMP
+#if ENABLED(MPCTEMP)
+  #define MPC_HEATER_POWER 40.0                 // (W) Heater power at full PWM. Not measured by M306 T.
+  #define MPC_BLOCK_HEAT_CAPACITY 16.7          // (J/K) Heat capacity of the heater block
+  #define MPC_SENSOR_RESPONSIVENESS 0.22        // (1/s) Rate at which the sensor follows the heater block
+  #define MPC_AMBIENT_XFER_COEFF 0.068          // (W/K) Heat lost to ambient with the part fan off
+  #define MPC_AMBIENT_XFER_COEFF_FAN255 0.097   // (W/K) Heat lost to ambient with the part fan at full speed
+  #define FILAMENT_HEAT_CAPACITY_PERMM 0.0056   // (J/K/mm) 1.75mm PLA/PETG: 0.0056, 2.85mm PLA: 0.0143, 1.75mm ABS: 0.0036
+  #define MPC_SMOOTHING_FACTOR 0.5              // (0.0...1.0) Fraction of the model error corrected each second
+  #define MPC_AUTOTUNE_TEMP 200                 // (°C) Temperature held by M306 T
+#endif // MPCTEMP
+
 //===========================================================================
 //============================= PID > Bed Temperature Control ===============
 //===========================================================================
@@ -550,6 +575,22 @@ const bool Z_MIN_PROBE_ENDSTOP_INVERTING = false; // set to true to invert the l
 #define Z_RAISE_PROBE_DEPLOY_STOW 13 // Raise to make room for the probe to deploy / stow
 #define Z_RAISE_BETWEEN_PROBINGS 5  // Raise between probing points.
 
+//
+// Smart probing: one fast touch finds the bed, then slow touches from SMART_PROBE_BUMP_MM above
+// it are repeated until the samples agree. Each point takes at least SMART_PROBE_MIN_SAMPLES
+// (the fast touch counts if the first slow one confirms it), and more while the samples spread
+// wider than SMART_PROBE_TOLERANCE, up to SMART_PROBE_MAX_SAMPLES. Samples more than 3 MADs from
+// the median are dropped and the rest averaged. UBL keeps the count and spread for each Mesh point
+// and reports them after G29 P1 and in G29 W.
+//
+#define SMART_PROBING
+#if ENABLED(SMART_PROBING)
+  #define SMART_PROBE_BUMP_MM      0.5   // (mm) Back off this far for each slow touch
+  #define SMART_PROBE_MIN_SAMPLES  2
+  #define SMART_PROBE_MAX_SAMPLES  6     // 2 to 10
+  #define SMART_PROBE_TOLERANCE    0.01  // (mm) Samples this close together agree
+#endif
+
 //
 // For M851 give a range for adjusting the Z probe offset
 //
@@ -611,6 +652,40 @@ const bool Z_MIN_PROBE_ENDSTOP_INVERTING = false; // set to true to invert the l
     #define MBL_Z_STEP 0.025  // Step size while manually probing Z axis.
   #endif  // MANUAL_BED_LEVELING
 
+  // Keep a Mesh per bed temperature. "G29 S<slot>" records the bed temperature the Mesh was
+  // probed at (G29 P1 takes the bed target) for the first UBL_MESH_BANK_SLOTS slots. M140/M190
+  // then load the Mesh for the new bed target, blending the two nearest Meshes when the
+  // target falls between them. Probe and store e.g. one Mesh at 60C and one at 110C.
+  // Only done before the print starts moving. After G29 P1 only once the bed target changes,
+  // G29 L/S or M501 has run or the job has ended.
+  #define UBL_MESH_BANK
+  #if ENABLED(UBL_MESH_BANK)
+    #define UBL_MESH_BANK_SLOTS 8  // 2 to 16
+  #endif
+
+  // Run G26 and the long G29 phases (P1, P2, P4) from the main loop instead of inside the
+  // command. Meanwhile only reports, M117 and job control are taken from the queue; the rest
+  // waits. M423 P pauses the job, M423 R resumes it, M423 A or M410 stops it. Progress is
+  // reported after each point, and M423 reports it on request.
+  #define UBL_BACKGROUND_JOBS
+
+  // "G29 P1 J" only probes the Mesh cells under the print area plus UBL_REGION_MARGIN (mm) all around,
+  // and moves the rest of the Mesh by the average change of those points. Give the area with
+  // "G29 P1 X Y J<margin>", or enable UBL_PRINT_AREA_FROM_GCODE to read it from the ;MINX: ;MINY:
+  // ;MAXX: ;MAXY: comments (as written by Cura) at the top of the file selected on the SD card.
+  #define UBL_REGION_MARGIN 10
+  #define UBL_PRINT_AREA_FROM_GCODE
+
+  // Save and load any number of named Meshes on the SD card with G29 S"name" and G29 L"name"
+  // (up to 8 letters, digits, - or _). Each is a file in /MESHES with the bed temperature,
+  // the probe statistics and an optional date from the host: G29 S"PEI" U<date>. G29 W lists them.
+  #define UBL_SD_MESHES
+
+  // M422 sends the Mesh and the UBL State to the host as one CRC-checked base64 line and M422 S
+  // takes them back the same way, instead of a map to parse or a line of M421 per point.
+  // See scripts/ublmesh.py.
+  #define UBL_MESH_TRANSFER
+
   //#define Z_PROBE_END_SCRIPT "G1 Z10 F12000\nG1 X15 Y330\nG1 Z0.5\nG1 Z10" // These commands will be executed in the end of G29 routine.
                                                                              // Useful to retract a deployable Z probe.
 
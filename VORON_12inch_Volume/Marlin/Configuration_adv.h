@@ -112,9 +112,10 @@
   #define WATCH_BED_TEMP_INCREASE 2               // Degrees Celsius
 #endif
 
-#if ENABLED(PIDTEMP)
+#if ENABLED(PIDTEMP) || ENABLED(MPCTEMP)
   // this adds an experimental additional term to the heating power, proportional to the extrusion speed.
   // if Kc is chosen well, the additional required power due to increased melting should be compensated.
+  // With MPCTEMP the extrusion rate feeds the model's filament heat loss instead, and Kc isn't used.
   #define PID_ADD_EXTRUSION_RATE
   #if ENABLED(PID_ADD_EXTRUSION_RATE)
     #define DEFAULT_Kc (100) //heating power=Kc*(e_speed)
@@ -122,6 +123,34 @@
   #endif
 #endif
 
+/**
+ * Heat in background:
+ * Start the heaters with M140/M104 at the start of a print instead of M190/M109 and
+ * let homing and the mesh probe run while they heat. G29 waits for the bed to settle
+ * (TEMP_BED_RESIDENCY_TIME) before probing and the first extruding move waits for the
+ * hotend and bed to reach their targets. Only a non-zero M104 while the hotend is below
+ * EXTRUDE_MINTEMP, or a non-zero M140 on a cold bed before any moves are queued, starts
+ * this, so temperature changes during a print don't pause it. M109/M190 end it.
+ */
+#define HEAT_IN_BACKGROUND
+
+/**
+ * Bed stability detection:
+ * A 300mm bed keeps moving for a while after its sensor reaches the target. Rather than
+ * a fixed dwell, G29 probing and G26 wait for the bed temperature to stop drifting.
+ * The bed is sampled every BED_STABILITY_INTERVAL ms and a line is fitted through the
+ * last BED_STABILITY_SAMPLES readings. The bed is stable when the line is flatter than
+ * BED_STABILITY_MAX_SLOPE and the readings stay within BED_STABILITY_MAX_STDDEV of it.
+ * While waiting, the estimated time left is reported as "W:" like M190.
+ */
+#define BED_STABILITY_DETECTION
+#if ENABLED(BED_STABILITY_DETECTION)
+  #define BED_STABILITY_SAMPLES 30      // Readings in the window (4 bytes of RAM each)
+  #define BED_STABILITY_INTERVAL 2000   // (ms) Time between readings
+  #define BED_STABILITY_MAX_SLOPE 0.2   // (degC/min) Drift allowed when stable
+  #define BED_STABILITY_MAX_STDDEV 0.2  // (degC) Scatter allowed around the fitted line
+#endif
+
 /**
  * Automatic Temperature:
  * The hotend target temperature is calculated by all the buffered lines of gcode.
@@ -407,6 +436,21 @@
   // With ENDSTOPS_ONLY_FOR_HOMING you must send "M120" to enable endstops.
   //#define ABORT_ON_ENDSTOP_HIT_FEATURE_ENABLED
 
+  // Print SD files converted by scripts/gcode2bin.py. Commands are stored already
+  // parsed (code plus typed fixed-point parameters), so reading them skips the text
+  // parser and strtod. Files are recognized by their header; plain G-code still works.
+  #define BINARY_GCODE
+
+  // Stream the file being printed ahead of the parser with a multiple block read
+  // (CMD18) into two 512 byte buffers, refilled from idle(). The cluster chain is
+  // looked up ahead of time so the FAT isn't read in the middle of a block.
+  // The buffers cost 1K of RAM, an eighth of an ATmega2560's 8K. Only enable it
+  // if the build leaves that much free (see the avr-size data figure).
+  //#define SD_READ_AHEAD
+  #if ENABLED(SD_READ_AHEAD)
+    #define SD_READ_AHEAD_CLUSTERS 4 // Cluster numbers of the file to look up at once
+  #endif
+
 #endif // SDSUPPORT
 
 // for dogm lcd displays you can choose some additional fonts:
@@ -508,6 +552,8 @@ const unsigned int dropsegments = 5; //everything with less than this number of
 // @section serial
 
 // The ASCII buffer for serial input
+// Commands are packed into BUFSIZE * MAX_CMD_SIZE bytes, so many more than
+// BUFSIZE short commands (like G1 moves) can be queued at once.
 #define MAX_CMD_SIZE 96
 #define BUFSIZE 4
 
@@ -520,6 +566,21 @@ const unsigned int dropsegments = 5; //everything with less than this number of
 // Some clients will have this feature soon. This could make the NO_TIMEOUTS unnecessary.
 //#define ADVANCED_OK
 
+// Act on M108, M112 and M410 as soon as they arrive over serial, even when the
+// command queue is full, instead of when the line is read into the queue.
+#define EMERGENCY_PARSER
+
+// Let hosts switch to a binary protocol with M888: commands encoded like
+// BINARY_GCODE files, sent in CRC-checked frames without waiting for each "ok".
+// See scripts/binhost.py. Requires BINARY_GCODE.
+#define BINARY_HOST_PROTOCOL
+
+// Send temperatures every M155 S<seconds> and the position every M154 S<seconds>
+// from idle(), so hosts don't poll M105 and M114 through the command queue.
+// M155 can't be used with EXPERIMENTAL_I2CBUS.
+#define AUTO_REPORT_TEMPERATURES
+#define AUTO_REPORT_POSITION
+
 // @section fwretract
 
 // Firmware based and LCD controlled retract
@@ -68,14 +68,14 @@
 // the intersections of those lines (respectively).
 //
 // This action allows the user to immediately see where the Mesh is properly defined and where it needs to 
-// be edited.   The command will generate the Mesh lines closest to the nozzle's starting position.  Alternatively
-// the user can specify the X and Y position of interest with command parameters.  This allows the user to
-// focus on a particular area of the Mesh where attention is needed.
+// be edited.   The whole pattern is planned as one continuous path that starts at the corner of the Mesh
+// closest to the nozzle's starting position.  Alternatively the user can specify the X and Y position of
+// interest with command parameters to pick the corner the drawing starts from.
 //
 // B #	Bed		Set the Bed Temperature.  If not specified, a default of 60 C. will be assumed.
 //
-// C    Current 	When searching for Mesh Intersection points to draw, use the current nozzle location
-// 			as the base for any distance comparison.  
+// C    Current 	Start the drawing at the Mesh corner closest to the current nozzle location even if
+// 			X or Y are specified.
 //
 // D    Disable		Disable the Unified Bed Leveling System.  In the normal case the user is invoking this
 // 			command to see how well a Mesh as been adjusted to match a print surface.  In order to do
@@ -111,15 +111,17 @@
 // 			printing the Mesh.  You can carefully remove the spent filament with a needle nose 
 // 			pliers while holding the LCD Click wheel in a depressed state. 
 //
-// R #  Random		Randomize the order that the circles are drawn on the bed.  The search for the closest 
-// 			undrawn cicle is still done.  But the distance to the location for each circle has a 
-// 			random number of the size specified added to it.  Specifying R50 will give an interesting
-// 			deviation from the normal behaviour on a 10 x 10 Mesh.
-//
 // X #	X coordinate	Specify the starting location of the drawing activity.
 //
 // Y #	Y coordinate	Specify the starting location of the drawing activity.
 //
+// The path:  The circles and the Mesh lines connecting them are printed in a fixed order that needs no
+// retractions.  First the rows are printed back and forth.  Each circle is printed completely as the
+// nozzle passes through it, followed by the line to the next circle in the row.  At the end of each row
+// the line up to the next row is printed.  Then the columns are walked back and forth to print the
+// remaining vertical lines.  Any time the nozzle has to get somewhere without printing, it moves along
+// lines that have already been printed, so it never needs to retract or cross open bed.
+//
 
 extern int UBL_has_control_of_LCD_Panel;
 extern float feedrate;
@@ -132,20 +134,24 @@ void gcode_G28();
 void sync_plan_position_e();
 void un_retract_filament();
 void retract_filament();
-void look_for_lines_to_connect();
 void bit_clear( unsigned int bits[16], int , int );
 void bit_set( unsigned int bits[16], int , int );
 bool is_bit_set( unsigned int bits[16], int , int );
 bool parse_G26_parameters();
 void move_to( float, float, float, float);
-void print_line_from_here_to_there( float sx, float sy, float sz, float ex, float ey, float ez );
-bool turn_on_heaters();
-void prime_nozzle();
+void turn_on_heaters();
+bool heaters_are_ready();
+void prime_nozzle_start();
+bool prime_nozzle_step();
+void prime_nozzle_fixed_length();
 void chirp_at_user();
 
-static unsigned circle_flags[16], horizontal_mesh_line_flags[16], vertical_mesh_line_flags[16], Continue_with_closest=0;
+static void G26_start_tour( float, float );
+static bool G26_tour_step();
+
+static unsigned vertical_mesh_line_flags[16], Continue_with_closest=0;
 static float G26_E_AXIS_feedrate = 0.030;
-static float Random_Deviation = 0.0, Layer_Height=LAYER_HEIGHT;
+static float Layer_Height=LAYER_HEIGHT;
 
 static bool retracted=false;	// We keep track of the state of the nozzle to know if it
 				// is currently retracted or not.  This allows us to be
@@ -157,24 +163,25 @@ static bool retracted=false;	// We keep track of the state of the nozzle to know
 void lcd_setstatus(const char* message, bool persist);
 #endif
 
-float valid_trig_angle( float );
-struct mesh_index_pair find_closest_circle_to_print( float, float );	
 void mesh_buffer_line(float, float, float, float, float, uint8_t );
 //		uint16_t x_splits = 0xffff, uint16_t y_splits = 0xffff);  /* needed for the old mesh_buffer_line() routine */
 
-static float E_Pos_Delta, Filament_Factor=FILAMENT_FACTOR;
+static float Filament_Factor=FILAMENT_FACTOR;
 static float Retraction_Multiplier=RETRACTION_MULTIPLIER;
 static float Nozzle=NOZZLE , Filament=FILAMENT, Prime_Length=PRIME_LENGTH;
 static float X_Pos, Y_Pos, bed_temp=BED_TEMP, hotend_temp=HOTEND_TEMP, Ooooze_Amount=OOOOZE_AMOUNT;
 static int Prime_Flag=0, Keep_Heaters_On=0; 
 
 
+// G26 runs as a UBL job (see ubl_job_step() in G29_Unified_Bed_Leveling.cpp).  gcode_G26() checks the
+// parameters and turns the heaters on.  G26_job_step() then waits for the heat, primes the nozzle and
+// queues the pattern a circle at a time while the main loop keeps going.
+
+#define G26_HEATING	0
+#define G26_PRIMING	1
+#define G26_PRINTING	2
+
 void gcode_G26() {
-float circle_x, circle_y, x, y, dx, dy, xe, ye, tmp;
-float start_angle, end_angle;
-float E_Pos=0.0;
-int   i, j, k, xi, yi; 
-struct mesh_index_pair location;
 
   if ( axis_unhomed_error(true, true, true) )	 // Don't allow Mesh Validation without homing first
     gcode_G28();
@@ -188,17 +195,80 @@ struct mesh_index_pair location;
 	set_current_to_destination();
   }
 
-  if ( turn_on_heaters() )			// Turn on the heaters, leave the command if anything
-	  goto LEAVE;				// has gone wrong.
+  turn_on_heaters();				// M108 or M423 A aborts the job, e.g. while it waits for the heat
 
-  axis_relative_modes[E_AXIS] = false;		// Get things setup so we can take control of the
-  relative_mode = false;			// planner and stepper motors!
-  current_position[E_AXIS] = 0.0;
-  sync_plan_position_e();
+  // One step for each circle in the rows, each line up or down a column, and each move over to the next column
+  ubl_job_start( G26_JOB, MESH_NUM_X_POINTS*MESH_NUM_Y_POINTS + MESH_NUM_X_POINTS*(MESH_NUM_Y_POINTS-1) + MESH_NUM_X_POINTS-1 );
+
+#if DISABLED(UBL_BACKGROUND_JOBS)
+  while ( ubl_job_step() )
+	idle();
+#endif
+}
 
-  if (Prime_Flag)  
-	prime_nozzle();
-  
+
+bool G26_job_step() {
+int   i; 
+
+  switch ( ubl_job.state ) {
+    case G26_HEATING:
+	if ( G29_lcd_clicked() ) {
+		strcpy( lcd_status_message, "Leaving G26    "); // We can't do lcd_setstatus() without having it continue;
+  		while ( G29_lcd_clicked() )			// Debounce the switch
+			idle();
+            	lcd_setstatus( "Leaving G26     ", true);	// Now we do it right.
+		set_destination_to_current();
+		goto LEAVE;
+	}
+	if ( ubl_job.abort ) {
+		set_destination_to_current();
+		goto LEAVE;
+	}
+	if ( !heaters_are_ready() ) 
+		return true;
+
+	axis_relative_modes[E_AXIS] = false;		// Get things setup so we can take control of the
+	relative_mode = false;			// planner and stepper motors!
+	current_position[E_AXIS] = 0.0;
+	sync_plan_position_e();
+
+	if ( Prime_Flag == -1 )	{		// The user decides how much to purge, with a click
+		prime_nozzle_start();
+		ubl_job.state = G26_PRIMING;
+		return true;
+	}
+	if ( Prime_Flag )  
+		prime_nozzle_fixed_length();
+	break;
+
+    case G26_PRIMING:
+	if ( prime_nozzle_step() )
+		return true;
+	if ( ubl_job.abort ) 
+		goto LEAVE;
+	break;
+
+    case G26_PRINTING:
+	if ( G29_lcd_clicked() || ubl_job.abort ) {	// Check if the user wants to stop the Mesh Validation
+		strcpy( lcd_status_message, "Mesh Validation Stopped.");// We can't do lcd_setstatus() without having it continue;
+		while ( G29_lcd_clicked() )				// Debounce the switch click
+	       		idle();	
+	        #if ENABLED(ULTRA_LCD)
+                  lcd_setstatus( "Mesh Validation Stopped.", true);
+	          lcd_quick_feedback();
+                #endif
+		goto LEAVE;
+	}
+
+	if ( planner.movesplanned() >= BLOCK_BUFFER_SIZE/2 )	// Keep the planner busy, but don't wait for it
+		return true;					// to have room.  There are other things to do.
+
+	if ( G26_tour_step() ) {			// Queue up the next circle and the line leaving it
+		ubl_job_point_done();
+		return true;
+	}
+	goto LEAVE;
+  }
 
 //
 //			Bed is preheated
@@ -214,132 +284,28 @@ struct mesh_index_pair location;
 //
 // Clear all of the flags we need
 //
-  for(i=0; i<16; i++) {		
-	circle_flags[i]			= 0;	
-	horizontal_mesh_line_flags[i]	= 0;
+  for(i=0; i<16; i++) 
 	vertical_mesh_line_flags[i]	= 0;
-  }
 
 //
-// Move nozzle to the specified height for the first layer
+// Pick the corner to start from and go there.  Then move the nozzle to the specified height for the
+// first layer.
 //
   set_destination_to_current();
-  destination[Z_AXIS] = Layer_Height;
   move_to( destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], 0.0 );
-  move_to( destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], Ooooze_Amount );
-
-  UBL_has_control_of_LCD_Panel = 1;	// Take control of the LCD Panel!
-  do {
-	if ( G29_lcd_clicked() ) {	// Check if the user wants to stop the Mesh Validation
-		strcpy( lcd_status_message, "Mesh Validation Stopped.");// We can't do lcd_setstatus() without having it continue;
-		while ( G29_lcd_clicked() )				// Debounce the switch click
-	       		idle();	
-	        #if ENABLED(ULTRA_LCD)
-                  lcd_setstatus( "Mesh Validation Stopped.", true);
-	          lcd_quick_feedback();
-                #endif
-		goto LEAVE;
-	}
-	
-	if ( Continue_with_closest ) {
-	   location = find_closest_circle_to_print( current_position[X_AXIS], current_position[Y_AXIS]);
-	} else
-	   location = find_closest_circle_to_print( X_Pos, Y_Pos );	// Find the closest Mesh Intersection to where
-									// we are now.
-    	if (location.x_index>=0 && location.y_index>=0 ) {
-		circle_x = blm.map_x_index_to_bed_location(location.x_index); 
-		circle_y = blm.map_y_index_to_bed_location(location.y_index);
-
-// Let's do a couple of quick sanity checks.  We can pull this code out later if we never see it catch a problem
-
-#ifdef DELTA
-		if ( sqrt( circle_x*circle_x + circle_y*circle_y) > DELTA_PRINTABLE_RADIUS) {
-    			SERIAL_PROTOCOLLNPGM("?Error: Attempt to print outside of DELTA_PRINTABLE_RADIUS.");
-			goto LEAVE;
-		}
-#endif
-		if ( circle_x<X_MIN_POS || circle_x>X_MAX_POS || circle_y<Y_MIN_POS || circle_y>Y_MAX_POS)  {
-    			SERIAL_PROTOCOLLNPGM("?Error: Attempt to print off the bed.");
-			goto LEAVE;
-		}
 
-		xi = location.x_index; 	// Just to shrink the next few lines and make them easier to understand	
-		yi = location.y_index;
-
-		start_angle = 0.0;		// assume it is going to be a full circle
-		end_angle   = 360.0;
-		if ( xi==0 )	{		// Check for bottom edge
-			start_angle = -90.0;	
-			end_angle   =  90.0;
-			if ( yi==0 )		// it is an edge, check for the two left corners
-			   start_angle = 0.0;
-			else
-			   if ( yi==MESH_NUM_Y_POINTS-1 )
-			     end_angle   =  0.0;
-			goto GOT_ANGLES;
-		}
-		if ( xi==MESH_NUM_X_POINTS-1 ){	// Check for top edge
-			start_angle =  90.0;	
-			end_angle   = 270.0;
-			if ( yi==0 )		// it is an edge, check for the two right corners
-			   end_angle = 180.0;
-			else
-			   if ( yi==MESH_NUM_Y_POINTS-1 )
-			     start_angle   =  180.0;
-			goto GOT_ANGLES;
-		}
-		if ( yi==0 )	{
-			start_angle =   0.0;	// only do the top   side of the cirlce
-			end_angle   = 180.0;
-		}
-		if ( yi==MESH_NUM_Y_POINTS-1 )  {	
-			start_angle = 180.0;	// only do the bottom side of the cirlce
-			end_angle   = 360.0;
-		}
-
-GOT_ANGLES:
-
-//
-// Declare and generate a sin() & cos() table to be used during the circle drawing.   This will lighten 
-// the CPU load and make the arc drawing faster and more smooth
-//
-		float sin_table[360/30+1], cos_table[360/30+1];
-		int tmp_div_30;
-		for(i=0; i<=360/30; i++) {
-			cos_table[i] = SIZE_OF_INTERSECTION_CIRCLES * cos( RADIANS( valid_trig_angle(i*30.0)) );
-			sin_table[i] = SIZE_OF_INTERSECTION_CIRCLES * sin( RADIANS( valid_trig_angle(i*30.0)) );
-		}
-
-		for(tmp=start_angle; tmp<end_angle-.1; tmp+=30.0 ) {
-			tmp_div_30 = tmp/30.0;
-			if ( tmp_div_30 < 0 )
-				tmp_div_30 += 360/30;
-
-			x = circle_x + cos_table[tmp_div_30]; // for speed, these are now a lookup table entry
-			y = circle_y + sin_table[tmp_div_30];
-
-			if ( tmp_div_30 > 11 )
-				tmp_div_30 -= 360/30;
-			xe = circle_x + cos_table[tmp_div_30+1]; // for speed, these are now a lookup table entry
-			ye = circle_y + sin_table[tmp_div_30+1];
-#ifdef DELTA
-			if ((x*x+y*y) > (DELTA_PRINTABLE_RADIUS*DELTA_PRINTABLE_RADIUS)) // Check to make sure this part of
-				continue;						// the 'circle' is on the bed.  If
-#else											// not, we need to skip
-
-			x = constrain( x, X_MIN_POS+1, X_MAX_POS-1); 	// This keeps us from bumping the endstops	
-			y = constrain( y, Y_MIN_POS+1, Y_MAX_POS-1); 			
-			xe= constrain( xe, X_MIN_POS+1, X_MAX_POS-1); 			
-			ye= constrain( ye, Y_MIN_POS+1, Y_MAX_POS-1); 			
-#endif
-
-			print_line_from_here_to_there( x, y, Layer_Height, xe, ye, Layer_Height);
-		}
+  if ( Continue_with_closest ) 
+	G26_start_tour( current_position[X_AXIS], current_position[Y_AXIS] );
+  else
+	G26_start_tour( X_Pos, Y_Pos );
 
-		look_for_lines_to_connect();
-	}
+  move_to( destination[X_AXIS], destination[Y_AXIS], Layer_Height, 0.0 );
+  move_to( destination[X_AXIS], destination[Y_AXIS], Layer_Height, Ooooze_Amount );
+  un_retract_filament();
 
-  } while (location.x_index>=0 && location.y_index>=0 );
+  UBL_has_control_of_LCD_Panel = 1;	// Take control of the LCD Panel!
+  ubl_job.state = G26_PRINTING;
+  return true;
 
 LEAVE:
   retract_filament();
@@ -356,57 +322,220 @@ LEAVE:
   	thermalManager.setTargetBed( 0.0 );
 	thermalManager.setTargetHotend( 0.0 , 0 );
   }
+  return false;
 }
 
 
-float valid_trig_angle( float d ) {
-	while ( d > 360.0 )
-		d -= 360.0;
+// The tour through the Mesh is worked out in a 'logical' frame where the drawing always starts at
+// index (0,0) and the rows are printed first.   G26_x_dir and G26_y_dir flip that frame so the
+// drawing can start at whichever corner of the bed is closest to where the user asked.   Points on
+// a circle are numbered in 30 degree steps counter clockwise from the +X side, so points 0, 3, 6
+// and 9 are where the Mesh lines leave the circle.   Positions along a circle are counted in
+// quarters (90 degrees) from some starting quarter.
+
+#define G26_ROWS	0
+#define G26_COLUMNS	1
+#define G26_DONE	2
+
+static struct {
+	int phase;		// Printing the rows, walking the columns, or finished
+	int i, j;		// The logical Mesh index of the circle the nozzle is at
+	int entry;		// The quarter (0=+X, 1=+Y, 2=-X, 3=-Y) of that circle the nozzle is at
+	int col_dir, row_dir;	// Which way the column walk is heading across and along the columns
+} tour;
 
-	while ( d < 0.0 )
-		d += 360.0;
-	return d;
+static int G26_x_dir, G26_y_dir;
+
+static const float G26_cos[360/30] = { 1.0, 0.866025, 0.5, 0.0, -0.5, -0.866025, -1.0, -0.866025, -0.5, 0.0, 0.5, 0.866025 };
+
+// Figure out which quarters of the circle at logical index (i,j) are printed.  Circles along the
+// edges of the Mesh only get the half (or the quarter in the corners) that faces the inside of the bed.
+// Bit k is the quarter from point 3*k to point 3*(k+1).
+
+static int G26_circle_quarters( int i, int j ) {
+int q = 0;
+
+	if ( i < MESH_NUM_X_POINTS-1 && j < MESH_NUM_Y_POINTS-1 ) q |= 1;
+	if ( i > 0                   && j < MESH_NUM_Y_POINTS-1 ) q |= 2;
+	if ( i > 0                   && j > 0 )                   q |= 4;
+	if ( i < MESH_NUM_X_POINTS-1 && j > 0 )                   q |= 8;
+	return q;
 }
 
-struct mesh_index_pair find_closest_circle_to_print( float X, float Y )	
-{
-  int i, j;
-  float f, mx, my, dx, dy, closest=99999.99;
-  struct mesh_index_pair return_val;
-
-	return_val.x_index = -1;
-	return_val.y_index = -1;
-
-	for(i=0; i<MESH_NUM_X_POINTS; i++) {
-		for(j=0; j<MESH_NUM_Y_POINTS; j++) {
-			if ( !is_bit_set( circle_flags, i, j) )  {
-				mx = blm.map_x_index_to_bed_location(i);	// We found a circle that needs to be printed
-				my = blm.map_y_index_to_bed_location(j);
-
-				dx = X - mx;				// Get the distance to this intersection
-				dy = Y - my;	
-				f = sqrt(dx*dx+dy*dy);
-
-				dx = X_Pos - mx; 			// It is possible that we are being called with the values 
-				dy = Y_Pos - my; 			// to let us find the closest circle to the start position.
-				f += sqrt(dx*dx+dy*dy) / 15.0;		// But if this is not the case, we are going to add in a small
-									// weighting to the distance calculation to help it choose
-									// a better place to continue.  
-
-				if (Random_Deviation > 1.0)
-					f +=random(0.0,Random_Deviation);// Add in the specified amount of Random Noise to our search
-
-				if ( f < closest ) {	
-					closest = f;			// We found a closer location that is still
-					return_val.x_index = i;		// un-printed  --- save the data for it
-					return_val.y_index = j;	
-					return_val.distance= closest;	
-				}
+// Find point k of the circle at logical index (i,j) on the bed.
+
+static void G26_point( int i, int j, int k, float &x, float &y ) {
+	k = ((k % (360/30)) + 360/30) % (360/30);
+	x = blm.map_x_index_to_bed_location( G26_x_dir > 0 ? i : MESH_NUM_X_POINTS-1-i );
+	y = blm.map_y_index_to_bed_location( G26_y_dir > 0 ? j : MESH_NUM_Y_POINTS-1-j );
+	x += G26_x_dir * SIZE_OF_INTERSECTION_CIRCLES * G26_cos[k];
+	y += G26_y_dir * SIZE_OF_INTERSECTION_CIRCLES * G26_cos[(k+9) % (360/30)];	// sin(a) == cos(a-90)
+#ifndef DELTA
+	x = constrain( x, X_MIN_POS+1, X_MAX_POS-1); 	// This keeps us from bumping the endstops	
+	y = constrain( y, Y_MIN_POS+1, Y_MAX_POS-1); 			
+#endif
+}
+
+// Move the nozzle in a straight line to point k of the circle at logical index (i,j), either printing
+// on the way or just traveling.
+
+static void G26_line_to_point( int i, int j, int k, bool print ) {
+float x, y, dx, dy;
+
+	G26_point( i, j, k, x, y );
+	dx = x - destination[X_AXIS];
+	dy = y - destination[Y_AXIS];
+	move_to( x, y, Layer_Height, print ? sqrt(dx*dx+dy*dy) * G26_E_AXIS_feedrate * Filament_Factor : 0.0 );
+}
+
+// Walk around the circle at (i,j) in 30 degree chords from position 'from' to position 'to'.  The
+// positions are counted in quarters starting at quarter 'start'.  Counting up goes counter clockwise.
+
+static void G26_arc( int i, int j, int start, int from, int to, bool print ) {
+int k, step = from < to ? 1 : -1;
+
+	for(k=from*3; k!=to*3; ) {
+		k += step;
+		G26_line_to_point( i, j, start*3 + k, print );
+	}
+}
+
+// Find where the partial circle at (i,j) with quarters q starts (counter clockwise) and how many
+// quarters long it is.
+
+static void G26_partial_circle( int q, int &start, int &length ) {
+int k;
+
+	length = 0;
+	for(k=0; k<4; k++) {
+		if ( q & (1<<k) ) {
+			length++;
+			if ( !(q & (1<<((k+3)&3))) )
+				start = k;
+		}
+	}
+}
+
+// The nozzle is at quarter 'entry' of a circle that hasn't been printed yet.  Print all of it and end
+// up at quarter 'exit' while traveling over as little of the already printed circle as possible.
+
+static void G26_print_circle( int i, int j, int entry, int exit ) {
+int q, start, length, from, to, d;
+
+	q = G26_circle_quarters( i, j );
+	if ( q == 0xF ) {
+		G26_arc( i, j, entry, 0, 4, true );		// All the way around, and back to the shorter
+		d = (exit-entry) & 3;				// side of the way out.
+		G26_arc( i, j, entry, 4, d<=2 ? 4+d : 3, false );
+		return;
+	}
+
+	G26_partial_circle( q, start, length );
+	from = (entry-start) & 3;
+	to   = (exit -start) & 3;
+	if ( from + length - to <= length - from + to ) {	// Print back to the start of the arc first
+		G26_arc( i, j, start, from, 0, true );
+		G26_arc( i, j, start, 0, from, false );
+		G26_arc( i, j, start, from, length, true );
+		G26_arc( i, j, start, length, to, false );
+	} else {						// or out to the end of it first
+		G26_arc( i, j, start, from, length, true );
+		G26_arc( i, j, start, length, from, false );
+		G26_arc( i, j, start, from, 0, true );
+		G26_arc( i, j, start, 0, to, false );
+	}
+}
+
+// The circle has already been printed.  Travel the short way around it from 'entry' to 'exit'.
+
+static void G26_pass_circle( int i, int j, int entry, int exit ) {
+int q, start, length, d;
+
+	q = G26_circle_quarters( i, j );
+	if ( q == 0xF ) {
+		d = (exit-entry) & 3;
+		G26_arc( i, j, entry, 0, d<=2 ? d : -1, false );
+		return;
+	}
+	G26_partial_circle( q, start, length );
+	G26_arc( i, j, start, (entry-start) & 3, (exit-start) & 3, false );
+}
+
+// Set up the tour to start at the corner of the Mesh closest to (X,Y) and travel there.
+
+static void G26_start_tour( float X, float Y ) {
+	G26_x_dir = abs(X - blm.map_x_index_to_bed_location(0)) <= abs(X - blm.map_x_index_to_bed_location(MESH_NUM_X_POINTS-1)) ? 1 : -1;
+	G26_y_dir = abs(Y - blm.map_y_index_to_bed_location(0)) <= abs(Y - blm.map_y_index_to_bed_location(MESH_NUM_Y_POINTS-1)) ? 1 : -1;
+
+	tour.phase = G26_ROWS;
+	tour.i = 0;
+	tour.j = 0;
+	tour.entry = 1;				// The corner circle is printed from its +Y end towards the first row line
+
+	float x, y;
+	G26_point( tour.i, tour.j, tour.entry*3, x, y );
+	retract_filament();
+	move_to( x, y, destination[Z_AXIS], 0.0 );
+}
+
+// Queue up the moves for the circle the nozzle is at and the Mesh line leaving it.  Returns false once
+// the whole pattern has been queued.
+
+static bool G26_tour_step() {
+int exit, next_j;
+
+	switch ( tour.phase ) {
+	  case G26_ROWS:				// Even rows go towards +X, odd rows go back towards -X
+		tour.row_dir = (tour.j & 1) ? -1 : 1;
+		if ( tour.i != (tour.row_dir>0 ? MESH_NUM_X_POINTS-1 : 0) ) {
+			exit = tour.row_dir>0 ? 0 : 2;
+			G26_print_circle( tour.i, tour.j, tour.entry, exit );
+			tour.i += tour.row_dir;
+			tour.entry = exit ^ 2;
+			G26_line_to_point( tour.i, tour.j, tour.entry*3, true );
+		} else if ( tour.j < MESH_NUM_Y_POINTS-1 ) {	// End of the row.  Print the line up to the next one.
+			G26_print_circle( tour.i, tour.j, tour.entry, 1 );
+			bit_set( vertical_mesh_line_flags, tour.i, tour.j );
+			tour.j++;
+			tour.entry = 3;
+			G26_line_to_point( tour.i, tour.j, tour.entry*3, true );
+		} else {					// Last row is done.  Walk back down the column we are in.
+			G26_print_circle( tour.i, tour.j, tour.entry, 3 );
+			tour.entry = 3;
+			tour.phase = G26_COLUMNS;
+			tour.col_dir = tour.i ? -1 : 1;
+			tour.row_dir = -1;
+		}
+		return true;
+
+	  case G26_COLUMNS:
+		if ( tour.j != (tour.row_dir>0 ? MESH_NUM_Y_POINTS-1 : 0) ) {
+			exit = tour.row_dir>0 ? 1 : 3;
+			G26_pass_circle( tour.i, tour.j, tour.entry, exit );
+			next_j = tour.j + tour.row_dir;
+			tour.entry = exit ^ 2;
+			if ( is_bit_set( vertical_mesh_line_flags, tour.i, min(tour.j, next_j) ) )
+				G26_line_to_point( tour.i, next_j, tour.entry*3, false );	// The line up at the end of a row
+			else {
+				bit_set( vertical_mesh_line_flags, tour.i, min(tour.j, next_j) );
+				G26_line_to_point( tour.i, next_j, tour.entry*3, true );
 			}
+			tour.j = next_j;
+			return true;
 		}
+		if ( tour.i + tour.col_dir >= 0 && tour.i + tour.col_dir < MESH_NUM_X_POINTS ) {
+			exit = tour.col_dir>0 ? 0 : 2;		// Over to the next column along the edge row
+			G26_pass_circle( tour.i, tour.j, tour.entry, exit );
+			tour.i += tour.col_dir;
+			tour.entry = exit ^ 2;
+			G26_line_to_point( tour.i, tour.j, tour.entry*3, false );
+			tour.row_dir = -tour.row_dir;
+			return true;
+		}
+		tour.phase = G26_DONE;
+		return false;
 	}
-	bit_set( circle_flags, return_val.x_index, return_val.y_index);		// Mark this location as done.
-	return return_val;
+	return false;
 }
 
 
@@ -441,73 +570,6 @@ unsigned mask;
 }
 
 
-
-void look_for_lines_to_connect()
-{
-float sx, sy, ex, ey, dx, dy;
-int i, j, k;
-
-	for(i=0; i<MESH_NUM_X_POINTS; i++ ) {
-		for(j=0; j<MESH_NUM_Y_POINTS; j++ ) {
-			
-			if ( i < MESH_NUM_X_POINTS)	// We can't connect to anything to the right than MESH_NUM_X_POINTS.  
-							// This is already a half circle because we are at the edge of the bed.
-							
-			if ( is_bit_set( circle_flags, i, j) && is_bit_set( circle_flags, i+1, j) ) {	// check if we can do a line to the left
-				if ( !is_bit_set( horizontal_mesh_line_flags, i, j) )  {
-
-//
-// We found two circles that need a horizontal line to connect them
-// Print it!
-//
-					sx = blm.map_x_index_to_bed_location(i);	
-					sx = sx + SIZE_OF_INTERSECTION_CIRCLES;			// get the right edge of the circle
-					sy = blm.map_y_index_to_bed_location(j);
-
-					ex = blm.map_x_index_to_bed_location(i+1);	
-					ex = ex - SIZE_OF_INTERSECTION_CIRCLES;			// get the left edge of the circle
-					ey = sy;
-
-					sx= constrain( sx, X_MIN_POS+1, X_MAX_POS-1); 	// This keeps us from bumping the endstops	
-					sy= constrain( sy, Y_MIN_POS+1, Y_MAX_POS-1); 			
-					ex= constrain( ex, X_MIN_POS+1, X_MAX_POS-1); 			
-					ey= constrain( ey, Y_MIN_POS+1, Y_MAX_POS-1); 			
-
-					print_line_from_here_to_there( sx, sy, Layer_Height, ex, ey, Layer_Height );
-					bit_set( horizontal_mesh_line_flags, i, j);		// Mark it as done so we don't do it again
-				}
-			}
-
-
-			if ( j < MESH_NUM_Y_POINTS)	// We can't connect to anything further back than MESH_NUM_Y_POINTS.  
-							// This is already a half circle because we are at the edge  of the bed.
-							
-			if ( is_bit_set( circle_flags, i, j) && is_bit_set( circle_flags, i, j+1) ) {	// check if we can do a line straight down
-				if ( !is_bit_set( vertical_mesh_line_flags, i, j) )  {
-//
-// We found two circles that need a vertical line to connect them
-// Print it!
-					sx = blm.map_x_index_to_bed_location(i);	
-					sy = blm.map_y_index_to_bed_location(j);
-					sy = sy + SIZE_OF_INTERSECTION_CIRCLES;			// get the top edge of the circle
-
-					ex = sx;
-					ey = blm.map_y_index_to_bed_location(j+1); 
-					ey = ey - SIZE_OF_INTERSECTION_CIRCLES;			// get the bottom edge of the circle
-
-					sx= constrain( sx, X_MIN_POS+1, X_MAX_POS-1); 	// This keeps us from bumping the endstops	
-					sy= constrain( sy, Y_MIN_POS+1, Y_MAX_POS-1); 			
-					ex= constrain( ex, X_MIN_POS+1, X_MAX_POS-1); 			
-					ey= constrain( ey, Y_MIN_POS+1, Y_MAX_POS-1); 			
-
-					print_line_from_here_to_there( sx, sy, Layer_Height, ex, ey, Layer_Height );
-					bit_set( vertical_mesh_line_flags, i, j);		// Mark it as done so we don't do it again
-				}
-			}
-		}
-	}
-}
-
 void debug_current_and_destination(char *title) {
 SERIAL_ECHO("    current=( ");
 SERIAL_ECHO_F( current_position[X_AXIS], 6 );
@@ -574,6 +636,8 @@ static float last_z = -999.99;
 
   if ( x!=destination[X_AXIS] || y!=destination[Y_AXIS])  {	// Check if X or Y is involved in the movement.
 	feed_value = PLANNER_XY_FEEDRATE()/(10.0);		// Yes!  It is a 'normal' movement
+	if ( e_delta == 0.0 )					// Traveling along lines that are already printed
+		feed_value *= 2.0;				// doesn't need to be as careful.
   } else  {
 	feed_value = planner.max_feedrate[E_AXIS]/(1.5);	// it is just a retract() or un_retract()
   }
@@ -606,62 +670,6 @@ void un_retract_filament()
 }
 
 
-// print_line_from_here_to_there() takes two cartesian coordinates and draws a line from one
-// to the other.  But there are really three sets of coordinates involved.  The first coordinate
-// is the present location of the nozzle.   We don't necessarily want to print from this location.
-// We first need to move the nozzle to the start of line segment where we want to print.  Once
-// there, we can use the two coordinates supplied to draw the line.
-//
-// Note:  Although we assume the first set of coordinates is the start of the line and the second
-// set of coordinates is the end of the line, it does not always work out that way.  This function
-// optimizes the movement to minimize the travel distance before it can start printing.  This saves
-// a lot of time and eleminates a lot of non-sensical movement of the nozzle.   However, it does 
-// cause a lot of very little short retracement of th nozzle when it draws the very first line 
-// segment of a 'circle'.   The time this requires is very short and is easily saved by the other
-// cases where the optimization comes into play.   
-
-
-void print_line_from_here_to_there( float sx, float sy, float sz, float ex, float ey, float ez ) {
-     float dx, dy, dx_s, dy_s, dx_e, dy_e, dist_start, dist_end, E_Pos_Deltai, Line_Length;
-
-	dx_s = current_position[X_AXIS] - sx;		// find our distance from the start of the actual line segment
-	dy_s = current_position[Y_AXIS] - sy;
-	dist_start = dx_s*dx_s + dy_s*dy_s;		// We don't need to do a sqrt(), we can compare the distance^2
-							// to save computation time
-
-	dx_e = current_position[X_AXIS] - ex;		// find our distance from the end of the actual line segment
-	dy_e = current_position[Y_AXIS] - ey;
-	dist_end  = dx_e*dx_e + dy_e*dy_e;
-
-     	dx = ex - sx;
-	dy = ey - sy;
-	Line_Length= sqrt(dx*dx+dy*dy);
-				
-
-	// If the end point of the line is closer to the nozzle, we are going to
-	// flip the direction of this line.   We will print it from the end to the start.
-	// On very small lines we don't do the optimization because it just isn't worth it.
-	//
-	if ( (dist_end < dist_start) && ( SIZE_OF_INTERSECTION_CIRCLES < abs(Line_Length)) )	{	
-		print_line_from_here_to_there( ex, ey, ez, sx, sy, sz );
-		return;
-	}
-
-	// Now decide if we should retract.
-
-	if ( dist_start > 2.0 )  {
-		retract_filament();
-	}
-	move_to( sx, sy, sz, 0.0 );	// Get to the starting point with no extrusion
-     	dx = ex - sx;
-	dy = ey - sy;
-
-	E_Pos_Delta = Line_Length * G26_E_AXIS_feedrate * Filament_Factor;
-
-	un_retract_filament();
-	move_to( ex, ey, ez, E_Pos_Delta);	// Get to the ending point with an appropriate amount of extrusion
-}
-
 
 // The parse_G26_Parameters() function used to be inline code for the function.   But 
 // there are so many parameters, it made sense to turn the parameter variables into
@@ -692,8 +700,7 @@ bool parse_G26_parameters() {
 	}
   }
 
-  if (code_seen('C')) 
-	  Continue_with_closest++;
+  Continue_with_closest = code_seen('C');
 
   if (code_seen('L')) {
 	Layer_Height = code_value_float();
@@ -765,14 +772,6 @@ bool parse_G26_parameters() {
 	}
   }
 
-  if (code_seen('R') ) {
-  	randomSeed(millis());
-	if ( code_has_value() )
-		Random_Deviation = code_value_float();
-	else
-		Random_Deviation = 50.0;
-  }
-
   X_Pos = current_position[X_AXIS];
   Y_Pos = current_position[Y_AXIS];
 
@@ -810,110 +809,102 @@ bool parse_G26_parameters() {
 
 //
 //
-// Turn on the bed and  nozzle heat.   Wait for them to get up to temperature
+// Turn on the bed and  nozzle heat.   G26_job_step() waits for them to get up to temperature
 //
 //
 
-bool turn_on_heaters() {
+void turn_on_heaters() {
 #if ENABLED(ULTRA_LCD)
-  lcd_setstatus( "G26 Heating Bed.  ", true);
+  lcd_setstatus( "G26 Heating.      ", true);
   lcd_quick_feedback();
 #endif
   UBL_has_control_of_LCD_Panel++;
-  thermalManager.setTargetBed( bed_temp );
-  while( abs(thermalManager.degBed()-bed_temp) > 3 ) {
-  	if ( G29_lcd_clicked() ) {
-		strcpy( lcd_status_message, "Leaving G26    "); // We can't do lcd_setstatus() without having it continue;
-  		while ( G29_lcd_clicked() )			// Debounce the switch
-			idle();
-            	lcd_setstatus( "Leaving G26     ", true);	// Now we do it right.
-		return 1;
-	}
-	idle();
-  }
 
-#if ENABLED(ULTRA_LCD)
-  lcd_setstatus( "G26 Heating Nozzle. ", true);
-  lcd_quick_feedback();
-#endif
- 
 //
-// Now turn on the hotend (nozzle) and wait for it to come up to 
-// temperature.
-
+// Start the bed and the hotend (nozzle) together and wait for both of them to
+// come up to temperature.  There is no reason to leave the nozzle cold while the
+// much slower bed heats.
+//
+  thermalManager.setTargetBed( bed_temp );
   thermalManager.setTargetHotend( hotend_temp , 0 );
-  while( abs(thermalManager.degHotend(0)-hotend_temp) > 3 ) {
-  	if ( G29_lcd_clicked() ) {
-		strcpy( lcd_status_message, "Leaving G26    "); // We can't do lcd_setstatus() without having it continue;
-  		while ( G29_lcd_clicked() )			// Debounce the switch
-			idle();
-            	lcd_setstatus( "Leaving G26     ", true);	// Now we do it right.
-		return 1;
-	}
-	idle();
-  }
+}
+
+bool heaters_are_ready() {
+  if ( abs(thermalManager.degBed()-bed_temp) > 3 || abs(thermalManager.degHotend(0)-hotend_temp) > 3 ) 
+	return false;
+
+#if ENABLED(BED_STABILITY_DETECTION)
+  if ( !thermalManager.bedIsStable() )	// The pattern is only worth printing on a bed that has stopped moving
+	return false;
+#endif
 
 #if ENABLED(ULTRA_LCD)
   lcd_setstatus( "                  ", true);
   lcd_quick_feedback();
 #endif
-  return 0;
+  return true;
 }
 
 //
 // This block of code primes the nozzle if needed.
 //
 
-void prime_nozzle() {
-	if ( Prime_Flag == -1 )  {	// The user wants to control how much filament gets purged
-		lcd_setstatus( "User Controled Prime", true);
-		chirp_at_user();
+void prime_nozzle_start() {			// The user wants to control how much filament gets purged
+	lcd_setstatus( "User Controled Prime", true);
+	chirp_at_user();
 
-		set_destination_to_current();
+	set_destination_to_current();
 
-		un_retract_filament();		// Lets make sure the G26 command doesn't think the filament is
-						// retracted().   We are here because we want to prime the nozzle.
-						// So let's just unretract just to be sure.	
-		UBL_has_control_of_LCD_Panel++;
-		while( !G29_lcd_clicked() ) {
-			chirp_at_user();
-			destination[E_AXIS] += 0.25;
-			mesh_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], 
-//						planner.max_feedrate[E_AXIS]/(15.0), 0, 0xffff, 0xffff );
-						planner.max_feedrate[E_AXIS]/(15.0), 0 );
-
-			stepper.synchronize();		// Without this synchronize, the purge is more consistent,
-							// but because the planner has a buffer, we won't be able
-							// to stop as quickly.  So we put up with the less smooth
-							// action to give the user a more responsive 'Stop'.
-			set_destination_to_current();
-			idle();
-		}
+	un_retract_filament();		// Lets make sure the G26 command doesn't think the filament is
+					// retracted().   We are here because we want to prime the nozzle.
+					// So let's just unretract just to be sure.	
+	UBL_has_control_of_LCD_Panel++;
+}
 
-		strcpy( lcd_status_message, "Done Priming     ");	// We can't do lcd_setstatus() without having it continue;
-									// So...  We cheat to get a message up.
-
-		while ( G29_lcd_clicked() )				// Debounce the switch
-				;
-		#if ENABLED(ULTRA_LCD)
-		  UBL_has_control_of_LCD_Panel = 0;
-		  lcd_setstatus( "Done Priming     ", true);		// Now we do it right.
-		  lcd_quick_feedback();
-		#endif
-	  } else {
-		#if ENABLED(ULTRA_LCD)
-                  lcd_setstatus( "Fixed Length Prime.", true);
-	          lcd_quick_feedback();
-                #endif
-		set_destination_to_current();
-		destination[E_AXIS] += Prime_Length;
+// Purge a little more filament.  Returns false once the user has clicked (or the job is stopped).
+
+bool prime_nozzle_step() {
+	if ( !G29_lcd_clicked() && !ubl_job.abort ) {
+		chirp_at_user();
+		destination[E_AXIS] += 0.25;
 		mesh_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], 
 //					planner.max_feedrate[E_AXIS]/(15.0), 0, 0xffff, 0xffff );
 					planner.max_feedrate[E_AXIS]/(15.0), 0 );
-		stepper.synchronize();
+
+		stepper.synchronize();		// Without this synchronize, the purge is more consistent,
+						// but because the planner has a buffer, we won't be able
+						// to stop as quickly.  So we put up with the less smooth
+						// action to give the user a more responsive 'Stop'.
 		set_destination_to_current();
-		retract_filament();
-	  }
+		return true;
+	}
+
+	strcpy( lcd_status_message, "Done Priming     ");	// We can't do lcd_setstatus() without having it continue;
+								// So...  We cheat to get a message up.
+
+	while ( G29_lcd_clicked() )				// Debounce the switch
+			;
+	#if ENABLED(ULTRA_LCD)
+	  UBL_has_control_of_LCD_Panel = 0;
+	  lcd_setstatus( "Done Priming     ", true);		// Now we do it right.
+	  lcd_quick_feedback();
+	#endif
+	return false;
+}
+
+void prime_nozzle_fixed_length() {
+	#if ENABLED(ULTRA_LCD)
+          lcd_setstatus( "Fixed Length Prime.", true);
+          lcd_quick_feedback();
+        #endif
+	set_destination_to_current();
+	destination[E_AXIS] += Prime_Length;
+	mesh_buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], 
+//				planner.max_feedrate[E_AXIS]/(15.0), 0, 0xffff, 0xffff );
+				planner.max_feedrate[E_AXIS]/(15.0), 0 );
+	stepper.synchronize();
+	set_destination_to_current();
+	retract_filament();
 }
 
 
@@ -47,18 +47,27 @@ void axis_unhomed_error(bool);
 void dump( char *str, float f );
 bool G29_lcd_clicked(); 
 void probe_entire_mesh( float, float, bool );
+bool select_probe_region( float );
+void report_probe_statistics();
+bool probe_entire_mesh_step();
 void manually_probe_remaining_mesh( float, float, float, float, bool );
-struct vector tilt_mesh_based_on_3pts(float, float, float );
+bool manually_probe_remaining_mesh_step();
+int count_invalid_mesh_points( bool );
+void tilt_mesh_based_on_probed_grid( int );
 void new_set_bed_level_equation_3pts(float , float , float );
 float measure_business_card_thickness(float );
 struct mesh_index_pair find_closest_mesh_point_of_type( Mesh_Point_Type, float, float, bool, unsigned int [16] );
 void Find_Mean_Mesh_Height();
 void Shift_Mesh_Height();
+void Smart_Fill_Mesh();
 bool G29_Parameter_Parsing();
 void G29_What_Command();
 void G29_EEPROM_Dump();
 void G29_Kompare_Current_Mesh_to_Stored_Mesh();
 void fine_tune_mesh( float, float, float, bool );
+bool fine_tune_mesh_step();
+bool G26_job_step();
+void G29_finish();
 void bit_clear( unsigned int bits[16], int , int );
 void bit_set( unsigned int bits[16], int , int );
 bool is_bit_set( unsigned int bits[16], int , int );
@@ -95,7 +95,6 @@ typedef unsigned long millis_t;
 
 extern const char errormagic[] PROGMEM;
 extern const char echomagic[] PROGMEM;
-extern int Unified_Bed_Leveling_EEPROM_start;
 
 #define SERIAL_ERROR_START serialprintPGM(errormagic)
 #define SERIAL_ERROR(x) SERIAL_PROTOCOL(x)
@@ -284,7 +283,8 @@ enum DebugFlags {
 extern uint8_t marlin_debug_flags;
 #define DEBUGGING(F) (marlin_debug_flags & (DEBUG_## F))
 
-extern bool Running;
+extern bool Running, wait_for_heatup;
+void cancel_heatup_wait(); // M108
 inline bool IsRunning() { return  Running; }
 inline bool IsStopped() { return !Running; }
 
@@ -305,6 +305,13 @@ bool code_value_bool();
 bool code_has_value();
 int16_t code_value_short();
 bool code_seen(char);
+#if ENABLED(UBL_SD_MESHES)
+  char* code_string();
+  bool code_is_binary();
+#endif
+#if ENABLED(BINARY_HOST_PROTOCOL)
+  extern bool binary_host_mode; // M888 until the empty frame. What comes in is frames, not text.
+#endif
 
 float code_value_temp_abs();
 float code_value_temp_diff();
@@ -448,6 +455,15 @@ extern uint8_t active_extruder;
   void print_heaterstates();
 #endif
 
+#if ENABLED(HEAT_IN_BACKGROUND)
+  extern bool background_heating;
+#endif
+#if HAS_HEATER_WAIT
+  bool wait_for_heaters(bool hotend, bool bed, bool bed_settle);
+  bool bed_needs_wait_before_probing();
+  void wait_for_bed_before_probing();
+#endif
+
 void calculate_volumetric_multipliers();
 
 // Buzzer
@@ -470,18 +486,47 @@ void calculate_volumetric_multipliers();
 void status_LED( int pin, int action);
 
 #ifdef UNIFIED_BED_LEVELING_FEATURE
-  extern int Unified_Bed_Leveling_EEPROM_start;
-
   #include "vector_3.h"
   #include "Bed_Leveling.h"
-  #include "qr_solve.h"
 
 //extern bed_leveling blm;
   void gcode_G29();	// Unified Bed Leveling
   void gcode_G26();	// Mesh Validation Tool
+
+  // G26 and the long G29 phases run as a job, a step at a time
+  enum UBL_Job_Type { NO_UBL_JOB, G26_JOB, G29_PROBE_JOB, G29_MANUAL_PROBE_JOB, G29_FINE_TUNE_JOB };
+  struct ubl_job_status {
+    UBL_Job_Type type;
+    int state;                  // Where the job's step function is up to
+    bool paused, abort;         // Set by M423 (and abort by M410)
+    int points_done, points_total;
+    millis_t started, paused_at;
+  };
+  extern struct ubl_job_status ubl_job;
+  void ubl_job_start(UBL_Job_Type type, int points_total);
+  bool ubl_job_step();          // false once no job is running
+  void ubl_job_point_done();
+  void ubl_job_pause(bool pause);
+  void ubl_job_report();
+  #if ENABLED(UBL_BACKGROUND_JOBS)
+    void save_command_args();
+    void restore_command_args();
+  #endif
+  #if ENABLED(UBL_PRINT_AREA_FROM_GCODE)
+    // XY extent of the selected SD file's print, for G29 P1 J
+    struct print_area {
+      bool valid;
+      float min_x, min_y, max_x, max_y;
+    };
+    extern struct print_area print_footprint;
+  #endif
   void mesh_buffer_line(float, float, float, float, float, uint8_t );
   bool axis_unhomed_error(const bool, const bool, const bool );
   float probe_pt(float, float, bool stow=true, int verbose_level=1);
+  #if ENABLED(SMART_PROBING)
+    extern uint8_t probe_samples, probe_rejected; // How the last probe_pt() went
+    extern float probe_spread;
+  #endif
   void lcd_buttons_update();
   void set_current_to_destination();
   void set_destination_to_current();
@@ -30,6 +30,7 @@
 
 #include "Marlin.h"
 #include "MarlinSerial.h"
+#include "fastnum.h"
 
 #ifndef USBCON
 // this next line disables the entire HardwareSerial.cpp,
@@ -40,7 +41,97 @@
   ring_buffer rx_buffer  =  { { 0 }, 0, 0 };
 #endif
 
+#if ENABLED(EMERGENCY_PARSER)
+
+  volatile bool emergency_kill = false,
+                emergency_quickstop = false;
+
+  enum EmergencyParserState {
+    EP_RESET,   // At the start of a line
+    EP_N,       // In the line number
+    EP_M,
+    EP_M1,
+    EP_M10,
+    EP_M108,
+    EP_M11,
+    EP_M112,
+    EP_M4,
+    EP_M41,
+    EP_M410,
+    EP_IGNORE   // Skipping the rest of the line
+  };
+
+  /**
+   * Spot M108, M112 and M410 as the characters come in, so they work even
+   * when the command queue is full or a handler is blocking. M108 cancels
+   * a heatup wait right away. M112 and M410 are left to idle() to carry out,
+   * as they can't be done from inside the stepper interrupt (see checkRx).
+   * The command is still queued as usual after this.
+   *
+   * Binary host frames aren't text and any byte can turn up in them, so
+   * they're left alone. M108 and M112 in a frame act as soon as it's read.
+   */
+  void emergency_parser(unsigned char c) {
+    static uint8_t state = EP_RESET;
+
+    #if ENABLED(BINARY_HOST_PROTOCOL)
+      if (binary_host_mode) {
+        state = EP_RESET; // Text starts on a new line after the empty frame
+        return;
+      }
+    #endif
+
+    switch (state) {
+      case EP_RESET:
+        switch (c) {
+          case ' ': break;
+          case 'N': state = EP_N; break;
+          case 'M': state = EP_M; break;
+          default: state = EP_IGNORE;
+        }
+        break;
+
+      case EP_N:
+        if (c == 'M') state = EP_M;
+        else if (!NUMERIC_SIGNED(c) && c != ' ') state = EP_IGNORE;
+        break;
+
+      case EP_M:
+        state = c == '1' ? EP_M1 : c == '4' ? EP_M4 : EP_IGNORE;
+        break;
+
+      case EP_M1:
+        state = c == '0' ? EP_M10 : c == '1' ? EP_M11 : EP_IGNORE;
+        break;
+
+      case EP_M10: state = c == '8' ? EP_M108 : EP_IGNORE; break;
+      case EP_M11: state = c == '2' ? EP_M112 : EP_IGNORE; break;
+      case EP_M4:  state = c == '1' ? EP_M41 : EP_IGNORE; break;
+      case EP_M41: state = c == '0' ? EP_M410 : EP_IGNORE; break;
+
+      case EP_M108:
+      case EP_M112:
+      case EP_M410:
+        if (c == ' ' || c == '*' || c == ';' || c == '\n' || c == '\r') {
+          switch (state) {
+            case EP_M108: cancel_heatup_wait(); break;
+            case EP_M112: emergency_kill = true; break;
+            case EP_M410: emergency_quickstop = true; break;
+          }
+        }
+        state = EP_IGNORE;
+        break;
+    }
+
+    if (c == '\n' || c == '\r') state = EP_RESET;
+  }
+
+#endif // EMERGENCY_PARSER
+
 FORCE_INLINE void store_char(unsigned char c) {
+  #if ENABLED(EMERGENCY_PARSER)
+    emergency_parser(c);
+  #endif
   CRITICAL_SECTION_START;
     uint8_t h = rx_buffer.head;
     uint8_t i = (uint8_t)(h + 1)  & (RX_BUFFER_SIZE - 1);
@@ -249,6 +340,13 @@ void MarlinSerial::println(double n, int digits) {
 // Private Methods /////////////////////////////////////////////////////////////
 
 void MarlinSerial::printNumber(unsigned long n, uint8_t base) {
+  if (base == 10) {
+    char buf[11];
+    format_ulong(buf, n);
+    print(buf);
+    return;
+  }
+
   unsigned char buf[8 * sizeof(long)]; // Assumes 8-bit chars.
   unsigned long i = 0;
 
@@ -269,34 +367,9 @@ void MarlinSerial::printNumber(unsigned long n, uint8_t base) {
 }
 
 void MarlinSerial::printFloat(double number, uint8_t digits) {
-  // Handle negative numbers
-  if (number < 0.0) {
-    print('-');
-    number = -number;
-  }
-
-  // Round correctly so that print(1.999, 2) prints as "2.00"
-  double rounding = 0.5;
-  for (uint8_t i = 0; i < digits; ++i)
-    rounding /= 10.0;
-
-  number += rounding;
-
-  // Extract the integer part of the number and print it
-  unsigned long int_part = (unsigned long)number;
-  double remainder = number - (double)int_part;
-  print(int_part);
-
-  // Print the decimal point, but only if there are digits beyond
-  if (digits > 0) print('.');
-
-  // Extract digits from the remainder one at a time
-  while (digits-- > 0) {
-    remainder *= 10.0;
-    int toPrint = int(remainder);
-    print(toPrint);
-    remainder -= toPrint;
-  }
+  char buf[24];
+  format_float(buf, number, digits);
+  print(buf);
 }
 // Preinstantiate Objects //////////////////////////////////////////////////////
 
@@ -101,6 +101,12 @@ struct ring_buffer {
   extern ring_buffer rx_buffer;
 #endif
 
+#if ENABLED(EMERGENCY_PARSER)
+  // Set by the RX interrupt on M112 and M410, acted on by idle()
+  extern volatile bool emergency_kill, emergency_quickstop;
+  void emergency_parser(unsigned char c);
+#endif
+
 class MarlinSerial { //: public Stream
 
   public:
@@ -128,6 +134,9 @@ class MarlinSerial { //: public Stream
     FORCE_INLINE void checkRx(void) {
       if (TEST(M_UCSRxA, M_RXCx)) {
         unsigned char c  =  M_UDRx;
+        #if ENABLED(EMERGENCY_PARSER)
+          emergency_parser(c);
+        #endif
         CRITICAL_SECTION_START;
           uint8_t h = rx_buffer.head;
           uint8_t i = (uint8_t)(h + 1) & (RX_BUFFER_SIZE - 1);
@@ -37,7 +37,6 @@
 #if ENABLED(UNIFIED_BED_LEVELING_FEATURE)
   #include "Bed_Leveling.h"
   #include "vector_3.h"
-  #include "qr_solve.h"
 #endif // UNIFIED_BED_LEVELING_FEATURE
 
 
@@ -53,9 +52,14 @@
 #include "cardreader.h"
 #include "configuration_store.h"
 #include "language.h"
+#include "fastnum.h"
 #include "pins_arduino.h"
 #include "math.h"
 
+#if ENABLED(BINARY_HOST_PROTOCOL) || ENABLED(UBL_MESH_TRANSFER)
+  #include <util/crc16.h>
+#endif
+
 #if ENABLED(USE_WATCHDOG)
   #include "watchdog.h"
 #endif
@@ -160,7 +164,7 @@
  * M105 - Read current temp
  * M106 - Fan on
  * M107 - Fan off
- * M108 - Cancel heatup and wait for the hotend and bed, this G-code is asynchronously handled in the get_serial_commands() parser
+ * M108 - Cancel heatup and wait for the hotend and bed, and abort G26. Asynchronously handled in the get_serial_commands() parser
  * M109 - Sxxx Wait for extruder current temp to reach target temp. Waits only when heating
  *        Rxxx Wait for extruder current temp to reach target temp. Waits when heating and cooling
  *        IF AUTOTEMP is enabled, S<mintemp> B<maxtemp> F<factor>. Exit autotemp by any M109 without F
@@ -178,10 +182,12 @@
  * M127 - Solenoid Air Valve Closed (BariCUDA vent to atmospheric pressure by jmil)
  * M128 - EtoP Open (BariCUDA EtoP = electricity to air pressure transducer by jmil)
  * M129 - EtoP Closed (BariCUDA EtoP = electricity to air pressure transducer by jmil)
- * M140 - Set bed target temp
+ * M140 - Set bed target temp. With UBL_MESH_BANK also loads the mesh probed nearest that temperature, before the print starts.
  * M145 - Set the heatup state H<hotend> B<bed> F<fan speed> for S<material> (0=PLA, 1=ABS)
  * M149 - Set temperature units
  * M150 - Set BlinkM Color Output R: Red<0-255> U(!): Green<0-255> B: Blue<0-255> over i2c, G for green does not work.
+ * M154 - Report the position every S<seconds>, 0 to stop. (Requires AUTO_REPORT_POSITION)
+ * M155 - Report temperatures every S<seconds>, 0 to stop. (Requires AUTO_REPORT_TEMPERATURES)
  * M190 - Sxxx Wait for bed current temp to reach target temp. Waits only when heating
  *        Rxxx Wait for bed current temp to reach target temp. Waits when heating and cooling
  * M200 - Set filament diameter, D<diameter>, setting E axis units to cubic. (Use S0 to revert to linear units.)
@@ -210,6 +216,7 @@
  * M302 - Allow cold extrudes, or set the minimum extrude S<temperature>.
  * M303 - PID relay autotune S<temperature> sets the target temperature. (default target temperature = 150C)
  * M304 - Set bed PID parameters P I and D
+ * M306 - Set or report the MPC hotend model P C R A F H, or autotune it with T. (Requires MPCTEMP)
  * M380 - Activate solenoid on active extruder
  * M381 - Disable all solenoids
  * M400 - Finish all moves
@@ -222,6 +229,8 @@
  * M410 - Quickstop. Abort all the planned moves
  * M420 - Enable/Disable Mesh Leveling (with current values) S1=enable S0=disable
  * M421 - Set a single Z coordinate in the Mesh Leveling grid. X<units> Y<units> Z<units>
+ * M422 - Send the UBL Mesh and State to the host as one base64 frame, or take them back with S. (Requires UBL_MESH_TRANSFER)
+ * M423 - Report the G26 or G29 job, or P pause it, R resume it, A stop it. (Requires UBL_BACKGROUND_JOBS)
  * M428 - Set the home_offset logically based on the current_position
  * M500 - Store parameters in EEPROM
  * M501 - Read parameters from EEPROM (if you need reset them after you changed them temporarily).
@@ -251,6 +260,7 @@
  *
  * ************ Custom codes - This can change to suit future G-code regulations
  * M100 - Watch Free Memory (For Debugging Only)
+ * M888 - Switch the serial port to the binary host protocol (Requires BINARY_HOST_PROTOCOL)
  * M928 - Start SD logging (M928 filename.g) - ended by M29
  * M999 - Restart after being stopped by error
  *
@@ -291,11 +301,27 @@ bool axis_homed[3] = { false };
 
 static long gcode_N, gcode_LastN, Stopped_gcode_LastN = 0;
 
-static char command_queue[BUFSIZE][MAX_CMD_SIZE];
+/**
+ * The command queue is a ring of BUFSIZE * MAX_CMD_SIZE bytes holding
+ * commands back to back, so short commands take only the room they need.
+ * Each entry is a length byte, a flags byte and the command itself, and
+ * never wraps around the end of the ring. A zero length byte (or the end
+ * of the ring) tells the reader to continue from the start.
+ */
+#define CMD_QUEUE_SIZE (BUFSIZE * MAX_CMD_SIZE)
+#define CMD_HEADER_SIZE 2
+#define CMD_SEND_OK _BV(0)  // Reply "ok" once the command is done
+#define CMD_BINARY  _BV(1)  // The entry holds a pre-parsed SD command
+
+static char command_queue[CMD_QUEUE_SIZE];
 static char* current_command, *current_command_args;
-static uint8_t cmd_queue_index_r = 0,
-               cmd_queue_index_w = 0,
-               commands_in_queue = 0;
+static uint16_t cmd_queue_index_r = 0,
+                cmd_queue_index_w = 0;
+static uint8_t commands_in_queue = 0;
+
+#define CMD_QUEUE_LENGTH(I) ((uint8_t)command_queue[I])
+#define CMD_QUEUE_FLAGS(I) ((uint8_t)command_queue[(I) + 1])
+#define CMD_QUEUE_TEXT(I) (&command_queue[(I) + CMD_HEADER_SIZE])
 
 #if ENABLED(INCH_MODE_SUPPORT)
   float linear_unit_factor = 1.0;
@@ -339,6 +365,10 @@ bool relative_mode = false;
 
 bool wait_for_heatup = true;
 
+#if ENABLED(HEAT_IN_BACKGROUND)
+  bool background_heating = false; // M104/M140 on a cold heater, until M109/M190 or the first extruding move has waited
+#endif
+
 const char errormagic[] PROGMEM = "Error:";
 const char echomagic[] PROGMEM = "echo:";
 const char axis_codes[NUM_AXIS] = {'X', 'Y', 'Z', 'E'};
@@ -348,6 +378,19 @@ static int serial_count = 0;
 // GCode parameter pointer used by code_seen(), code_value_float(), etc.
 static char* seen_pointer;
 
+// Arguments of the current command, parsed once by parse_command_args().
+// param_pos holds the offset of each letter A-Z in the arguments, flagged
+// with PARAM_HAS_VALUE if a number follows it, or PARAM_NONE if it's absent.
+#define PARAM_NONE      0xFF
+#define PARAM_HAS_VALUE 0x80
+static uint8_t param_pos[26], seen_param;
+static float param_value[26];
+
+#if ENABLED(BINARY_GCODE)
+  // Parameters of a pre-parsed SD command, NULL for a text command
+  static const uint8_t *binary_args, *binary_seen;
+#endif
+
 // Next Immediate GCode Command pointer. NULL if none.
 const char* queued_commands_P = NULL;
 
@@ -509,8 +552,6 @@ static uint8_t target_extruder;
   FilamentChangeMenuResponse filament_change_menu_response;
 #endif
 
-static bool send_ok[BUFSIZE];
-
 #if HAS_SERVOS
   Servo servo[NUM_SERVOS];
   #define MOVE_SERVO(I, P) servo[I].move(P)
@@ -668,27 +709,120 @@ void enqueue_and_echo_commands_P(const char* pgcode) {
 }
 
 void clear_command_queue() {
-  cmd_queue_index_r = cmd_queue_index_w;
+  cmd_queue_index_r = cmd_queue_index_w = 0;
   commands_in_queue = 0;
 }
 
 /**
- * Once a new command is in the ring buffer, call this to commit it
+ * Find room for a command of up to 'size' bytes (including its nul)
+ * at the write end of the ring buffer, wrapping to the start if the
+ * tail is too short. Returns where to write the command, or NULL if
+ * there is no room yet. Nothing is queued until _commit_command().
+ */
+static char* _reserve_command(uint8_t size) {
+  uint16_t need = size + CMD_HEADER_SIZE;
+  if (!commands_in_queue) cmd_queue_index_r = cmd_queue_index_w = 0;
+  if (cmd_queue_index_w > cmd_queue_index_r || !commands_in_queue) {
+    if (CMD_QUEUE_SIZE - cmd_queue_index_w >= need)
+      return CMD_QUEUE_TEXT(cmd_queue_index_w);
+    if (cmd_queue_index_r < need) return NULL;
+    if (cmd_queue_index_w < CMD_QUEUE_SIZE) command_queue[cmd_queue_index_w] = 0; // wrap marker
+    cmd_queue_index_w = 0;
+  }
+  return cmd_queue_index_r - cmd_queue_index_w >= need ? CMD_QUEUE_TEXT(cmd_queue_index_w) : NULL;
+}
+
+/**
+ * Is there room for a command of any length?
  */
-inline void _commit_command(bool say_ok) {
-  send_ok[cmd_queue_index_w] = say_ok;
-  cmd_queue_index_w = (cmd_queue_index_w + 1) % BUFSIZE;
+inline bool command_queue_has_room() { return _reserve_command(MAX_CMD_SIZE) != NULL; }
+
+/**
+ * Once a new command of 'size' bytes is written to the space
+ * from _reserve_command(), call this to commit it
+ */
+inline void _commit_command(uint8_t size, bool say_ok
+  #if ENABLED(BINARY_GCODE)
+    , bool binary=false
+  #endif
+) {
+  command_queue[cmd_queue_index_w] = size;
+  command_queue[cmd_queue_index_w + 1] = (say_ok ? CMD_SEND_OK : 0)
+    #if ENABLED(BINARY_GCODE)
+      | (binary ? CMD_BINARY : 0)
+    #endif
+  ;
+  cmd_queue_index_w += size + CMD_HEADER_SIZE;
   commands_in_queue++;
 }
 
+#if ENABLED(BINARY_GCODE)
+  /**
+   * Write the name of a binary record's command ("G1") from its kind
+   * and code. Returns the size of the name including its nul.
+   */
+  inline uint8_t _binary_command_name(char* command, const uint8_t* kind_code) {
+    return sprintf_P(command, PSTR("%c%u"), kind_code[0], kind_code[1] | (kind_code[2] << 8)) + 1;
+  }
+
+  /**
+   * Check the 'len' bytes of a binary record's parameters before they're
+   * queued: each value must fit in 4 bytes, have at most 7 decimals (see
+   * binary_pow10[]) and end within the record.
+   */
+  inline bool _binary_params_valid(const uint8_t* p, uint8_t len) {
+    const uint8_t* const end = p + len;
+    while (p < end) {
+      uint8_t size = *p >> 5;
+      if (size) {
+        if (size > 4 || end - p < size + 2 || p[1] > 7) return false;
+        p += size + 2;
+      }
+      else
+        p++;
+    }
+    return true;
+  }
+#endif
+
+/**
+ * Drop the command at the read end of the ring buffer
+ */
+inline void _advance_command_queue() {
+  if (!--commands_in_queue) {
+    cmd_queue_index_r = cmd_queue_index_w = 0;
+    return;
+  }
+  cmd_queue_index_r += CMD_QUEUE_LENGTH(cmd_queue_index_r) + CMD_HEADER_SIZE;
+  if (cmd_queue_index_r >= CMD_QUEUE_SIZE || !CMD_QUEUE_LENGTH(cmd_queue_index_r))
+    cmd_queue_index_r = 0;
+}
+
+#if ENABLED(ADVANCED_OK) || ENABLED(BINARY_HOST_PROTOCOL)
+  /**
+   * Bytes left in the ring buffer, for hosts that fill it by size.
+   * Each command takes its length plus CMD_HEADER_SIZE.
+   */
+  inline uint16_t command_queue_free() {
+    if (!commands_in_queue) return CMD_QUEUE_SIZE;
+    return cmd_queue_index_w > cmd_queue_index_r
+      ? CMD_QUEUE_SIZE - cmd_queue_index_w + cmd_queue_index_r
+      : cmd_queue_index_r - cmd_queue_index_w;
+  }
+#endif
+
 /**
  * Copy a command directly into the main command buffer, from RAM.
  * Returns true if successfully adds the command
  */
 inline bool _enqueuecommand(const char* cmd, bool say_ok=false) {
-  if (*cmd == ';' || commands_in_queue >= BUFSIZE) return false;
-  strcpy(command_queue[cmd_queue_index_w], cmd);
-  _commit_command(say_ok);
+  if (*cmd == ';') return false;
+  size_t size = strlen(cmd) + 1;
+  if (size > MAX_CMD_SIZE) return false;
+  char* const command = _reserve_command(size);
+  if (!command) return false;
+  memcpy(command, cmd, size);
+  _commit_command(size, say_ok);
   return true;
 }
 
@@ -890,9 +1024,6 @@ void setup() {
   SERIAL_ECHOPGM(MSG_PLANNER_BUFFER_BYTES);
   SERIAL_ECHOLN((int)sizeof(block_t)*BLOCK_BUFFER_SIZE);
 
-  // Send "ok" after commands by default
-  for (int8_t i = 0; i < BUFSIZE; i++) send_ok[i] = true;
-
   // loads data from EEPROM if available else uses defaults (and resets step acceleration rate)
   Config_RetrieveSettings();
 
@@ -958,6 +1089,40 @@ void setup() {
   #endif
 }
 
+#if ENABLED(UBL_BACKGROUND_JOBS)
+
+  /**
+   * While a G26 or G29 job runs, only commands that don't move the machine
+   * or touch the mesh are taken from the queue: reports, M117 and the
+   * commands that pause, resume or stop the job. Everything else waits.
+   */
+  static bool command_waits_for_ubl_job() {
+    if (ubl_job.type == NO_UBL_JOB) return false;
+
+    const char *cmd = CMD_QUEUE_TEXT(cmd_queue_index_r);
+    while (*cmd == ' ') cmd++;
+    if (*cmd == 'N' && NUMERIC_SIGNED(cmd[1])) {
+      cmd += 2;
+      while (NUMERIC(*cmd)) cmd++;
+      while (*cmd == ' ') cmd++;
+    }
+    if (*cmd != 'M' || !NUMERIC(cmd[1])) return true;
+
+    switch (atoi(cmd + 1)) {
+      case 27: case 31:
+      case 105: case 108: case 112: case 113: case 114: case 115: case 117: case 119:
+      case 154: case 155: case 410: case 423:
+        return false;
+    }
+    return true;
+  }
+
+#else
+
+  #define command_waits_for_ubl_job() false
+
+#endif
+
 /**
  * The main Marlin program loop
  *
@@ -969,18 +1134,22 @@ void setup() {
  *  - Call LCD update
  */
 void loop() {
-  if (commands_in_queue < BUFSIZE) get_available_commands();
+  if (command_queue_has_room()) get_available_commands();
 
   #if ENABLED(SDSUPPORT)
     card.checkautostart(false);
   #endif
 
-  if (commands_in_queue) {
+  #if ENABLED(UBL_BACKGROUND_JOBS)
+    ubl_job_step();
+  #endif
+
+  if (commands_in_queue && !command_waits_for_ubl_job()) {
 
     #if ENABLED(SDSUPPORT)
 
       if (card.saving) {
-        char* command = command_queue[cmd_queue_index_r];
+        char* command = CMD_QUEUE_TEXT(cmd_queue_index_r);
         if (strstr_P(command, PSTR("M29"))) {
           // M29 closes the file
           card.closefile();
@@ -1006,10 +1175,7 @@ void loop() {
     #endif // SDSUPPORT
 
     // The queue may be reset by a command handler or by code invoked by idle() within a handler
-    if (commands_in_queue) {
-      --commands_in_queue;
-    cmd_queue_index_r = (cmd_queue_index_r + 1) % BUFSIZE;
-  }
+    if (commands_in_queue) _advance_command_queue();
   }
   endstops.report_state();
   idle();
@@ -1024,10 +1190,174 @@ void gcode_line_error(const char* err, bool doFlush = true) {
   serial_count = 0;
 }
 
+#if ENABLED(BINARY_HOST_PROTOCOL)
+
+  /**
+   * Binary host protocol, entered with M888 (see scripts/binhost.py)
+   *
+   * Each command comes in a frame:
+   *   0xA5, seq, len, body[len], crc (uint16, little-endian)
+   * The body is a binary G-code record without its length byte (see
+   * get_sdcard_binary_commands) and the crc is CRC-16/CCITT (0x1021,
+   * starting from 0xFFFF) over seq, len and body. An empty frame goes
+   * back to the text protocol.
+   *
+   * After reading what has arrived the printer replies "ack <seq> <limit>"
+   * for the last frame it queued. <limit> counts bytes since M888 (modulo
+   * 65536): the host may send up to there without waiting. A bad frame or
+   * a gap in seq gets one "nak <seq> <limit>" and the host resends from
+   * that frame. There's no RAM to keep frames that arrive after a lost one,
+   * so they are resent too, and acks keep coming while they are dropped.
+   */
+  #define BINARY_FRAME_SYNC 0xA5
+
+  enum BinaryFrameState {
+    FRAME_SYNC,
+    FRAME_SEQ,
+    FRAME_LEN,
+    FRAME_BODY,
+    FRAME_CRC_LOW,
+    FRAME_CRC_HIGH
+  };
+
+  bool binary_host_mode = false;
+  static uint8_t binary_frame_seq; // The next frame to queue
+  static uint16_t binary_bytes_read;
+
+  /**
+   * Print how far the host may send. Bytes wait in the RX buffer until the
+   * command queue has room for a command of any length, which leaves up to
+   * two such commands' worth of the queue unused (one at the end of the ring).
+   */
+  void binary_host_limit() {
+    int16_t window = (RX_BUFFER_SIZE - 1) + command_queue_free() - 2 * (MAX_CMD_SIZE + CMD_HEADER_SIZE);
+    NOLESS(window, RX_BUFFER_SIZE - 1);
+    SERIAL_PROTOCOL(' ');
+    SERIAL_PROTOCOLLN((unsigned int)(binary_bytes_read + window));
+  }
+
+  void binary_host_ack() {
+    SERIAL_PROTOCOLPGM(MSG_BINARY_ACK);
+    SERIAL_PROTOCOL((int)(uint8_t)(binary_frame_seq - 1));
+    binary_host_limit();
+  }
+
+  /**
+   * Queue the record from a frame. Returns false if it's malformed.
+   */
+  inline bool _enqueue_binary_record(const uint8_t* body, uint8_t len) {
+    char* const command = _reserve_command(MAX_CMD_SIZE);
+    if (!body[0]) {
+      if (len < 2 || len > MAX_CMD_SIZE) return false;
+      memcpy(command, &body[1], len - 1);
+      command[len - 1] = '\0';
+      _commit_command(len, false);
+      return true;
+    }
+    if (len < 3) return false;
+
+    if (body[0] == 'M') {
+      uint16_t code = body[1] | (body[2] << 8);
+      if (code == 112) kill(PSTR(MSG_KILLED));
+      if (code == 108) cancel_heatup_wait();
+    }
+
+    uint8_t n = _binary_command_name(command, body);
+    len -= 3;
+    if (n + 1 + len > MAX_CMD_SIZE || !_binary_params_valid(&body[3], len)) return false;
+    command[n] = len;
+    memcpy(&command[n + 1], &body[3], len);
+    _commit_command(n + 1 + len, false, true);
+    return true;
+  }
+
+  inline void get_serial_frames(uint8_t* const frame) {
+    static uint8_t state = FRAME_SYNC, seq, len, pos, crc_low;
+    static uint16_t crc;
+    static bool nak_sent = false;
+    bool queued = false, dropped = false;
+
+    while (binary_host_mode && command_queue_has_room() && MYSERIAL.available() > 0) {
+      uint8_t c = MYSERIAL.read();
+      binary_bytes_read++;
+      switch (state) {
+        case FRAME_SYNC:
+          if (c == BINARY_FRAME_SYNC) {
+            crc = 0xFFFF;
+            state = FRAME_SEQ;
+          }
+          continue;
+        case FRAME_SEQ:
+          seq = c;
+          state = FRAME_LEN;
+          break;
+        case FRAME_LEN:
+          len = c;
+          pos = 0;
+          state = len ? FRAME_BODY : FRAME_CRC_LOW;
+          if (len > MAX_CMD_SIZE) state = FRAME_SYNC;
+          break;
+        case FRAME_BODY:
+          frame[pos++] = c;
+          if (pos == len) state = FRAME_CRC_LOW;
+          break;
+        case FRAME_CRC_LOW:
+          crc_low = c;
+          state = FRAME_CRC_HIGH;
+          continue;
+        case FRAME_CRC_HIGH:
+          state = FRAME_SYNC;
+          if (crc == (crc_low | (c << 8))) {
+            if (seq == binary_frame_seq) {
+              nak_sent = false;
+              binary_frame_seq++;
+              queued = true;
+              if (!len)
+                binary_host_mode = false;
+              else if (!_enqueue_binary_record(frame, len)) {
+                SERIAL_ERROR_START;
+                SERIAL_ERRORPGM(MSG_ERR_BINARY_RECORD);
+                SERIAL_ERRORLN((int)seq);
+              }
+              continue;
+            }
+            if ((int8_t)(seq - binary_frame_seq) < 0) {
+              queued = true; // Resent after its ack was lost
+              continue;
+            }
+          }
+          break;
+      }
+      if (state != FRAME_SYNC) {
+        crc = _crc_xmodem_update(crc, c);
+        continue;
+      }
+      // A bad frame or one out of order
+      if (!nak_sent) {
+        SERIAL_PROTOCOLPGM(MSG_BINARY_NAK);
+        SERIAL_PROTOCOL((int)binary_frame_seq);
+        binary_host_limit();
+        nak_sent = true;
+      }
+      else
+        dropped = true;
+    }
+    if (queued || dropped) binary_host_ack();
+  }
+
+#endif // BINARY_HOST_PROTOCOL
+
 inline void get_serial_commands() {
   static char serial_line_buffer[MAX_CMD_SIZE];
   static boolean serial_comment_mode = false;
 
+  #if ENABLED(BINARY_HOST_PROTOCOL)
+    if (binary_host_mode) {
+      get_serial_frames((uint8_t*)serial_line_buffer);
+      return;
+    }
+  #endif
+
   // If the command buffer is empty for too long,
   // send "wait" to indicate Marlin is still waiting.
   #if defined(NO_TIMEOUTS) && NO_TIMEOUTS > 0
@@ -1042,7 +1372,7 @@ inline void get_serial_commands() {
   /**
    * Loop while serial characters are incoming and the queue is not full
    */
-  while (commands_in_queue < BUFSIZE && MYSERIAL.available() > 0) {
+  while (command_queue_has_room() && MYSERIAL.available() > 0) {
 
     char serial_char = MYSERIAL.read();
 
@@ -1121,8 +1451,10 @@ inline void get_serial_commands() {
       }
 
       // If command was e-stop process now
-      if (strcmp(command, "M112") == 0) kill(PSTR(MSG_KILLED));
-      if (strcmp(command, "M108") == 0) wait_for_heatup = false;
+      #if DISABLED(EMERGENCY_PARSER)
+        if (strcmp(command, "M112") == 0) kill(PSTR(MSG_KILLED));
+        if (strcmp(command, "M108") == 0) cancel_heatup_wait();
+      #endif
 
       #if defined(NO_TIMEOUTS) && NO_TIMEOUTS > 0
         last_command_time = ms;
@@ -1153,12 +1485,96 @@ inline void get_serial_commands() {
 
 #if ENABLED(SDSUPPORT)
 
+  inline void sdcard_print_finished() {
+    SERIAL_PROTOCOLLNPGM(MSG_FILE_PRINTED);
+    print_job_timer.stop();
+    char time[30];
+    millis_t t = print_job_timer.duration();
+    int hours = t / 60 / 60, minutes = (t / 60) % 60;
+    sprintf_P(time, PSTR("%i " MSG_END_HOUR " %i " MSG_END_MINUTE), hours, minutes);
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLN(time);
+    lcd_setstatus(time, true);
+    card.printingHasFinished();
+    card.checkautostart(true);
+  }
+
+  /**
+   * Stop the SD print on a read error. The command being read was only
+   * reserved in the queue, so it's simply dropped.
+   */
+  inline void sdcard_read_error() {
+    SERIAL_ERROR_START;
+    SERIAL_ECHOLNPGM(MSG_SD_ERR_READ);
+    card.stopSDPrint();
+  }
+
+  #if ENABLED(BINARY_GCODE)
+
+    /**
+     * Queue commands from a binary G-code file (see scripts/gcode2bin.py).
+     * Each record is a length byte followed by either:
+     *  - 0 and the text of a command that has to stay text, or
+     *  - 'G', 'M' or 'T', the code number (uint16) and the parameters.
+     *
+     * A parsed command is queued as its name ("G1"), a nul, the size of the
+     * parameters and the parameters themselves, where code_seen() finds them.
+     */
+    inline void get_sdcard_binary_commands() {
+      char* command;
+      while ((command = _reserve_command(MAX_CMD_SIZE))) {
+        if (card.eof()) {
+          sdcard_print_finished();
+          return;
+        }
+
+        uint8_t record[4]; // length, kind, code
+        bool ok = card.getBytes(record, 2) && record[0];
+        if (ok) {
+          uint8_t len = record[0] - 1;
+          if (!record[1]) {
+            ok = len < MAX_CMD_SIZE && card.getBytes((uint8_t*)command, len);
+            if (ok) {
+              command[len] = '\0';
+              if (len) _commit_command(len + 1, false);
+            }
+          }
+          else {
+            ok = len >= 2 && card.getBytes(&record[2], 2);
+            if (ok) {
+              uint8_t n = _binary_command_name(command, &record[1]);
+              len -= 2;
+              ok = n + 1 + len <= MAX_CMD_SIZE && card.getBytes((uint8_t*)&command[n + 1], len)
+                && _binary_params_valid((uint8_t*)&command[n + 1], len);
+              command[n] = len;
+              if (ok) _commit_command(n + 1 + len, false, true);
+            }
+          }
+        }
+        if (!ok) {
+          SERIAL_ERROR_START;
+          SERIAL_ECHOLNPGM(MSG_SD_ERR_BINARY_RECORD);
+          card.stopSDPrint();
+          return;
+        }
+      }
+    }
+
+  #endif // BINARY_GCODE
+
   inline void get_sdcard_commands() {
     static bool stop_buffering = false,
                 sd_comment_mode = false;
 
     if (!card.sdprinting) return;
 
+    #if ENABLED(BINARY_GCODE)
+      if (card.isBinary()) {
+        get_sdcard_binary_commands();
+        return;
+      }
+    #endif
+
     /**
      * '#' stops reading from SD to the buffer prematurely, so procedural
      * macro calls are possible. If it occurs, stop_buffering is triggered
@@ -1168,54 +1584,68 @@ inline void get_serial_commands() {
 
     if (commands_in_queue == 0) stop_buffering = false;
 
+    /**
+     * Lines are scanned straight out of the SD block cache, a block at a
+     * time, and copied into the command queue. Only a command that runs
+     * across a block boundary needs a second pass through the loop.
+     */
     uint16_t sd_count = 0;
     bool card_eof = card.eof();
-    while (commands_in_queue < BUFSIZE && !card_eof && !stop_buffering) {
-      int16_t n = card.get();
-      char sd_char = (char)n;
-      card_eof = card.eof();
-      if (card_eof || n == -1
-          || sd_char == '\n' || sd_char == '\r'
-          || ((sd_char == '#' || sd_char == ':') && !sd_comment_mode)
-      ) {
-        if (card_eof) {
-          SERIAL_PROTOCOLLNPGM(MSG_FILE_PRINTED);
-          print_job_timer.stop();
-          char time[30];
-          millis_t t = print_job_timer.duration();
-          int hours = t / 60 / 60, minutes = (t / 60) % 60;
-          sprintf_P(time, PSTR("%i " MSG_END_HOUR " %i " MSG_END_MINUTE), hours, minutes);
-          SERIAL_ECHO_START;
-          SERIAL_ECHOLN(time);
-          lcd_setstatus(time, true);
-          card.printingHasFinished();
-          card.checkautostart(true);
+    char* command;
+    while (!card_eof && !stop_buffering && (command = _reserve_command(MAX_CMD_SIZE))) {
+      uint8_t* data;
+      int16_t n = card.getSpan(&data);
+      if (n <= 0) {
+        sdcard_read_error();
+        sd_comment_mode = false;
+        return;
+      }
+
+      char sd_char = 0;
+      bool end_of_command = false;
+      int16_t i = 0;
+      while (i < n) {
+        sd_char = (char)data[i++];
+        if (sd_char == '\n' || sd_char == '\r'
+            || ((sd_char == '#' || sd_char == ':') && !sd_comment_mode)
+        ) {
+          end_of_command = true;
+          break;
         }
-        else if (n == -1) {
-          SERIAL_ERROR_START;
-          SERIAL_ECHOLNPGM(MSG_SD_ERR_READ);
+        if (sd_comment_mode || sd_count >= MAX_CMD_SIZE - 1) {
+          /**
+           * Keep fetching, but ignore comments and normal characters beyond
+           * the max length. The command will be injected when EOL is reached
+           */
+          if (sd_char == ';') sd_comment_mode = true;
+          continue;
         }
-        if (sd_char == '#') stop_buffering = true;
+        if (sd_char == ';')
+          sd_comment_mode = true;
+        else
+          command[sd_count++] = sd_char;
+      }
 
-        sd_comment_mode = false; //for new command
+      if (!card.advance(i)) {
+        sdcard_read_error();
+        sd_comment_mode = false;
+        return;
+      }
+      card_eof = card.eof();
 
-        if (!sd_count) continue; //skip empty lines
+      if (!end_of_command && !card_eof) continue; // command goes on in the next block
 
-        command_queue[cmd_queue_index_w][sd_count] = '\0'; //terminate string
-        sd_count = 0; //clear buffer
+      if (end_of_command && sd_char == '#') stop_buffering = true;
 
-        _commit_command(false);
-      }
-      else if (sd_count >= MAX_CMD_SIZE - 1) {
-        /**
-         * Keep fetching, but ignore normal characters beyond the max length
-         * The command will be injected when EOL is reached
-         */
-      }
-      else {
-        if (sd_char == ';') sd_comment_mode = true;
-        if (!sd_comment_mode) command_queue[cmd_queue_index_w][sd_count++] = sd_char;
+      sd_comment_mode = false; //for new command
+
+      if (sd_count) {
+        command[sd_count] = '\0'; //terminate string
+        _commit_command(sd_count + 1, false);
+        sd_count = 0; //clear buffer
       }
+
+      if (card_eof) sdcard_print_finished();
     }
   }
 
@@ -1239,37 +1669,147 @@ void get_available_commands() {
   #endif
 }
 
-bool code_has_value() {
+#if ENABLED(BINARY_GCODE)
+
+  /**
+   * A binary parameter is a byte with the letter (0-25) in the low 5 bits and
+   * the size of its value (0-4 bytes) in the top 3. A value is a decimal count
+   * followed by a little-endian signed mantissa: X-12.5 is 'X', 1, -125.
+   */
+
+  static int32_t binary_mantissa(uint8_t &decimals) {
+    uint8_t size = *binary_seen >> 5;
+    if (!size) { decimals = 0; return 0; }
+    decimals = binary_seen[1];
+    const uint8_t* m = &binary_seen[2];
+    uint32_t v = (m[size - 1] & 0x80) ? 0xFFFFFFFF : 0;
+    for (int8_t i = size - 1; i >= 0; i--) v = (v << 8) | m[i];
+    return (int32_t)v;
+  }
+
+  static const long binary_pow10[] PROGMEM = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+
+  static float binary_value_float() {
+    uint8_t decimals;
+    int32_t m = binary_mantissa(decimals);
+    float v = decimal_to_float(m < 0 ? -m : m, decimals);
+    return m < 0 ? -v : v;
+  }
+
+  static long binary_value_long() {
+    uint8_t decimals;
+    long v = binary_mantissa(decimals);
+    return decimals ? v / (long)pgm_read_dword(&binary_pow10[decimals]) : v;
+  }
+
+  #define CODE_VALUE_BINARY(V) if (binary_args) return V
+
+#else
+
+  #define CODE_VALUE_BINARY(V) NOOP
+
+#endif // BINARY_GCODE
+
+static bool arg_has_value(const char* arg) {
   int i = 1;
-  char c = seen_pointer[i];
-  while (c == ' ') c = seen_pointer[++i];
-  if (c == '-' || c == '+') c = seen_pointer[++i];
-  if (c == '.') c = seen_pointer[++i];
+  char c = arg[i];
+  while (c == ' ') c = arg[++i];
+  if (c == '-' || c == '+') c = arg[++i];
+  if (c == '.') c = arg[++i];
   return NUMERIC(c);
 }
 
-float code_value_float() {
-  float ret;
-  char* e = strchr(seen_pointer, 'E');
-  if (e) {
-    *e = 0;
-    ret = strtod(seen_pointer + 1, NULL);
-    *e = 'E';
+/**
+ * Parse the arguments of the current command into param_pos / param_value,
+ * so code_seen() and code_value_float() are lookups instead of a strchr()
+ * and a number conversion per call. As with strchr() the first occurrence of a letter
+ * is the one that counts.
+ */
+static void parse_command_args() {
+  memset(param_pos, PARAM_NONE, sizeof(param_pos));
+
+  #if ENABLED(BINARY_GCODE)
+    if (binary_args) {
+      const uint8_t *p = binary_args + 1, *end = p + binary_args[0];
+      for (; p < end; p += (*p >> 5) ? (*p >> 5) + 2 : 1) {
+        uint8_t i = *p & 0x1F;
+        if (i >= COUNT(param_pos) || param_pos[i] != PARAM_NONE) continue;
+        param_pos[i] = p - binary_args;
+        param_value[i] = 0;
+        if (*p >> 5) {
+          param_pos[i] |= PARAM_HAS_VALUE;
+          binary_seen = p;
+          param_value[i] = binary_value_float();
+        }
+      }
+      return;
+    }
+  #endif
+
+  for (char* p = current_command_args; *p; p++) {
+    #if ENABLED(UBL_SD_MESHES)
+      if (*p == '"') { // Skip over a quoted string, see code_string()
+        char* q = strchr(p + 1, '"');
+        if (!q) break;
+        p = q;
+        continue;
+      }
+    #endif
+    uint8_t i = *p - 'A';
+    if (i >= COUNT(param_pos) || param_pos[i] != PARAM_NONE) continue;
+    param_pos[i] = p - current_command_args;
+    param_value[i] = 0;
+    if (arg_has_value(p)) {
+      param_pos[i] |= PARAM_HAS_VALUE;
+      param_value[i] = parse_float(p + 1);
+    }
   }
-  else
-    ret = strtod(seen_pointer + 1, NULL);
-  return ret;
 }
 
-inline unsigned long code_value_ulong() { return strtoul(seen_pointer + 1, NULL, 10); }
+bool code_has_value() { return (param_pos[seen_param] & PARAM_HAS_VALUE) != 0; }
 
-inline long code_value_long() { return strtol(seen_pointer + 1, NULL, 10); }
+#if ENABLED(UBL_SD_MESHES)
+  /**
+   * The quoted string of the command, like the Mesh name in G29 S"PEI",
+   * or NULL if there is none. parse_command_args() skips over the string
+   * so its letters aren't taken for parameters, and parameters after it
+   * (G29 S"PEI" U20261018) still count.
+   */
+  char* code_string() {
+    #if ENABLED(BINARY_GCODE)
+      if (binary_args) return NULL;
+    #endif
+    char* s = strchr(current_command_args, '"');
+    if (!s) return NULL;
+    char* e = strchr(++s, '"');
+    if (e) *e = '\0';
+    return s;
+  }
 
-inline int code_value_int() { return (int)strtol(seen_pointer + 1, NULL, 10); }
+  /**
+   * Did the command come as a binary record? Its parameters can't carry
+   * a string, so a command that takes one has to be sent as text.
+   */
+  bool code_is_binary() {
+    #if ENABLED(BINARY_GCODE)
+      return binary_args != NULL;
+    #else
+      return false;
+    #endif
+  }
+#endif
+
+float code_value_float() { return param_value[seen_param]; }
+
+inline unsigned long code_value_ulong() { CODE_VALUE_BINARY(binary_value_long()); return strtoul(seen_pointer + 1, NULL, 10); }
 
-inline uint16_t code_value_ushort() { return (uint16_t)strtoul(seen_pointer + 1, NULL, 10); }
+inline long code_value_long() { CODE_VALUE_BINARY(binary_value_long()); return strtol(seen_pointer + 1, NULL, 10); }
 
-inline uint8_t code_value_byte() { return (uint8_t)(constrain(strtol(seen_pointer + 1, NULL, 10), 0, 255)); }
+inline int code_value_int() { CODE_VALUE_BINARY(binary_value_long()); return (int)strtol(seen_pointer + 1, NULL, 10); }
+
+inline uint16_t code_value_ushort() { CODE_VALUE_BINARY(binary_value_long()); return (uint16_t)strtoul(seen_pointer + 1, NULL, 10); }
+
+inline uint8_t code_value_byte() { CODE_VALUE_BINARY(constrain(binary_value_long(), 0, 255)); return (uint8_t)(constrain(strtol(seen_pointer + 1, NULL, 10), 0, 255)); }
 
 inline bool code_value_bool() { return code_value_byte() > 0; }
 
@@ -1339,8 +1879,18 @@ inline millis_t code_value_millis() { return code_value_ulong(); }
 inline millis_t code_value_millis_from_seconds() { return code_value_float() * 1000; }
 
 bool code_seen(char code) {
-  seen_pointer = strchr(current_command_args, code);
-  return (seen_pointer != NULL); // Return TRUE if the code-letter was found
+  uint8_t i = code - 'A';
+  if (i >= COUNT(param_pos) || param_pos[i] == PARAM_NONE) return false;
+  seen_param = i;
+  uint8_t pos = param_pos[i] & ~PARAM_HAS_VALUE;
+  #if ENABLED(BINARY_GCODE)
+    if (binary_args) {
+      binary_seen = binary_args + pos;
+      return true;
+    }
+  #endif
+  seen_pointer = current_command_args + pos;
+  return true; // Return TRUE if the code-letter was found
 }
 
 /**
@@ -2067,11 +2617,60 @@ void do_blocking_move_to_z(float z, float feed_rate) {
     return false;
   }
 
+  #if ENABLED(SMART_PROBING)
+
+    uint8_t probe_samples, probe_rejected;
+    float probe_spread;
+
+    /**
+     * Combine the samples of one probe point. Samples further than 3 MADs
+     * (or SMART_PROBE_TOLERANCE, if more) from the median are outliers.
+     * Sets probe_rejected and probe_spread (the range of the samples kept)
+     * and returns the mean of the samples kept.
+     */
+    static float probe_robust_mean(const float sample[], const uint8_t n) {
+      float sorted[SMART_PROBE_MAX_SAMPLES], dev[SMART_PROBE_MAX_SAMPLES];
+      uint8_t i, j;
+
+      for (i = 0; i < n; i++) {
+        float v = sample[i];
+        for (j = i; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = v;
+      }
+      float median = (n & 1) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) * 0.5;
+
+      for (i = 0; i < n; i++) {
+        float v = fabs(sample[i] - median);
+        for (j = i; j > 0 && dev[j - 1] > v; j--) dev[j] = dev[j - 1];
+        dev[j] = v;
+      }
+      float mad = (n & 1) ? dev[n / 2] : (dev[n / 2 - 1] + dev[n / 2]) * 0.5,
+            limit = max(3 * 1.4826 * mad, SMART_PROBE_TOLERANCE),
+            sum = 0, lo = 0, hi = 0;
+      uint8_t kept = 0;
+
+      for (i = 0; i < n; i++) {
+        if (fabs(sample[i] - median) > limit) continue;
+        if (!kept || sample[i] < lo) lo = sample[i];
+        if (!kept || sample[i] > hi) hi = sample[i];
+        sum += sample[i];
+        kept++;
+      }
+      probe_rejected = n - kept;
+      probe_spread = hi - lo;
+      return sum / kept;
+    }
+
+  #endif // SMART_PROBING
+
   // Do a single Z probe and return with current_position[Z_AXIS]
   // at the height where the probe triggered.
   float run_z_probe() {
 
     float old_feedrate = feedrate;
+    #if ENABLED(SMART_PROBING) && DISABLED(DELTA)
+      float measured_z;
+    #endif
 
     // Prevent stepper_inactive_time from running out and EXTRUDER_RUNOUT_PREVENT from extruding
     refresh_cmd_timeout();
@@ -2104,7 +2703,48 @@ void do_blocking_move_to_z(float z, float feed_rate) {
         if (DEBUGGING(LEVELING)) DEBUG_POS("run_z_probe (DELTA) 2", current_position);
       #endif
 
-    #else // !DELTA
+    #elif ENABLED(SMART_PROBING)
+
+      /**
+       * Come down fast to find the bed, then back off SMART_PROBE_BUMP_MM and
+       * touch it slowly until the samples agree. The fast touch only counts
+       * as a sample if the first slow touch confirms it.
+       */
+      float sample[SMART_PROBE_MAX_SAMPLES], fast_z, zPosition;
+      uint8_t n = 0;
+
+      feedrate = homing_feedrate[Z_AXIS];
+      line_to_z(-(Z_MAX_LENGTH + 10));
+      stepper.synchronize();
+      endstops.hit_on_purpose(); // clear endstop hit flags
+      fast_z = stepper.get_axis_position_mm(Z_AXIS);
+      planner.set_position_mm(current_position[X_AXIS], current_position[Y_AXIS], fast_z, current_position[E_AXIS]);
+      zPosition = fast_z;
+
+      do {
+        feedrate = homing_feedrate[Z_AXIS];
+        line_to_z(zPosition + SMART_PROBE_BUMP_MM);
+        set_homing_bump_feedrate(Z_AXIS);
+        line_to_z(zPosition - SMART_PROBE_BUMP_MM);
+        stepper.synchronize();
+        endstops.hit_on_purpose();
+
+        zPosition = stepper.get_axis_position_mm(Z_AXIS);
+        planner.set_position_mm(current_position[X_AXIS], current_position[Y_AXIS], zPosition, current_position[E_AXIS]);
+        sample[n++] = zPosition;
+        if (n == 1 && fabs(fast_z - zPosition) <= SMART_PROBE_TOLERANCE) sample[n++] = fast_z;
+
+        probe_samples = n;
+        measured_z = probe_robust_mean(sample, n);
+      } while (n < SMART_PROBE_MAX_SAMPLES && (n < SMART_PROBE_MIN_SAMPLES || probe_spread > SMART_PROBE_TOLERANCE));
+
+      current_position[Z_AXIS] = zPosition;
+
+      #if ENABLED(DEBUG_LEVELING_FEATURE)
+        if (DEBUGGING(LEVELING)) DEBUG_POS("run_z_probe", current_position);
+      #endif
+
+    #else // !DELTA && !SMART_PROBING
 
 //      #if ENABLED(UNIFIED_BED_LEVELING_FEATURE)
 //        planner.bed_level_matrix.set_to_identity();
@@ -2151,7 +2791,11 @@ void do_blocking_move_to_z(float z, float feed_rate) {
 
     feedrate = old_feedrate;
 
-    return current_position[Z_AXIS];
+    #if ENABLED(SMART_PROBING) && DISABLED(DELTA)
+      return measured_z;
+    #else
+      return current_position[Z_AXIS];
+    #endif
   }
 
 void do_blocking_move_to_xy(float x, float y, float feed_rate) {
@@ -4012,6 +4656,10 @@ inline void gcode_M104() {
     #endif
 
     if (temp > thermalManager.degHotend(target_extruder)) LCD_MESSAGEPGM(MSG_HEATING);
+
+    #if ENABLED(HEAT_IN_BACKGROUND)
+      if (temp && thermalManager.degHotend(target_extruder) < EXTRUDE_MINTEMP) background_heating = true;
+    #endif
   }
 }
 
@@ -4088,6 +4736,33 @@ inline void gcode_M104() {
   }
 #endif
 
+#if ENABLED(AUTO_REPORT_TEMPERATURES)
+
+  static uint8_t auto_report_temp_interval = 0;
+  static millis_t next_temp_report_ms;
+
+  /**
+   * M155: Report temperatures every S<seconds> (0 to stop), from idle()
+   * so the host doesn't have to poll M105 through the command queue.
+   */
+  inline void gcode_M155() {
+    if (code_seen('S')) {
+      auto_report_temp_interval = code_value_byte();
+      NOMORE(auto_report_temp_interval, 60);
+      next_temp_report_ms = millis() + 1000UL * auto_report_temp_interval;
+    }
+  }
+
+  inline void auto_report_temperatures() {
+    if (auto_report_temp_interval && ELAPSED(millis(), next_temp_report_ms)) {
+      next_temp_report_ms = millis() + 1000UL * auto_report_temp_interval;
+      print_heaterstates();
+      SERIAL_EOL;
+    }
+  }
+
+#endif // AUTO_REPORT_TEMPERATURES
+
 /**
  * M105: Read hot end and bed temperature
  */
@@ -4130,10 +4805,21 @@ inline void gcode_M105() {
 
 #endif // FAN_COUNT > 0
 
+/**
+ * End a wait for the hotend and bed to heat. G26 heats up as part of its
+ * job, so it's aborted too. Called by M108 and wherever M108 is spotted early.
+ */
+void cancel_heatup_wait() {
+  wait_for_heatup = false;
+  #if ENABLED(UNIFIED_BED_LEVELING_FEATURE)
+    if (ubl_job.type == G26_JOB) ubl_job.abort = true;
+  #endif
+}
+
 /**
  * M108: Cancel heatup and wait for the hotend and bed, this G-code is asynchronously handled in the get_serial_commands() parser
  */
-inline void gcode_M108() { wait_for_heatup = false; }
+inline void gcode_M108() { cancel_heatup_wait(); }
 
 /**
  * M109: Sxxx Wait for extruder(s) to reach temperature. Waits only when heating.
@@ -4259,10 +4945,29 @@ inline void gcode_M109() {
 
   } while (wait_for_heatup && TEMP_CONDITIONS);
 
+  #if ENABLED(HEAT_IN_BACKGROUND)
+    if (wait_for_heatup) background_heating = false; // Waited here, so the first extrusion needn't
+  #endif
+
   LCD_MESSAGEPGM(MSG_HEATING_COMPLETE);
   KEEPALIVE_STATE(IN_HANDLER);
 }
 
+#if ENABLED(UBL_MESH_BANK)
+
+  /**
+   * Load the Mesh for a new bed target, but only before the print gets going.
+   * With moves queued the Mesh in use is kept, and so is one G29 P1 probed
+   * until the bed target changes (or G29 L/S, M501 or the print job ending).
+   */
+  static void ubl_mesh_bank_select(float old_target) {
+    if (thermalManager.degTargetBed() != old_target) blm.mesh_bank_hold = false;
+    if (!blm.mesh_bank_hold && !planner.blocks_queued())
+      blm.load_mesh_for_temperature(thermalManager.degTargetBed());
+  }
+
+#endif
+
 #if HAS_TEMP_BED
 
   /**
@@ -4274,7 +4979,15 @@ inline void gcode_M109() {
 
     LCD_MESSAGEPGM(MSG_BED_HEATING);
     bool no_wait_for_cooling = code_seen('S');
-    if (no_wait_for_cooling || code_seen('R')) thermalManager.setTargetBed(code_value_temp_abs());
+    if (no_wait_for_cooling || code_seen('R')) {
+      #if ENABLED(UBL_MESH_BANK)
+        float old_target = thermalManager.degTargetBed();
+      #endif
+      thermalManager.setTargetBed(code_value_temp_abs());
+      #if ENABLED(UBL_MESH_BANK)
+        ubl_mesh_bank_select(old_target);
+      #endif
+    }
 
     #if TEMP_BED_RESIDENCY_TIME > 0
       millis_t residency_start_ms = 0;
@@ -4353,12 +5066,115 @@ inline void gcode_M109() {
 
     } while (wait_for_heatup && TEMP_BED_CONDITIONS);
 
+    #if ENABLED(HEAT_IN_BACKGROUND)
+      if (wait_for_heatup) background_heating = false; // Waited here, so the first extrusion needn't
+    #endif
+
     LCD_MESSAGEPGM(MSG_BED_DONE);
     KEEPALIVE_STATE(IN_HANDLER);
   }
 
 #endif // HAS_TEMP_BED
 
+#if HAS_HEATER_WAIT
+
+  /**
+   * Wait for heaters started with M104/M140 to come up to temperature.
+   * The active hotend and the bed heat at the same time and only heaters
+   * still below target (less the window) are waited on. With bed_settle
+   * the bed must also settle: hold within TEMP_BED_HYSTERESIS for
+   * TEMP_BED_RESIDENCY_TIME, or with BED_STABILITY_DETECTION stop drifting.
+   * Returns false if the wait was cancelled with M108.
+   */
+  bool wait_for_heaters(bool hotend, bool bed, bool bed_settle) {
+    millis_t now, next_temp_ms = 0, bed_residency_ms = 0;
+    bool reached;
+
+    wait_for_heatup = true;
+    KEEPALIVE_STATE(NOT_BUSY);
+
+    do {
+      now = millis();
+      reached = true;
+
+      if (hotend && thermalManager.degHotend(active_extruder) < thermalManager.degTargetHotend(active_extruder) - (TEMP_WINDOW))
+        reached = false;
+
+      #if HAS_TEMP_BED
+        if (bed && thermalManager.degTargetBed()) {
+          float bed_diff = thermalManager.degTargetBed() - thermalManager.degBed();
+          if (!bed_residency_ms) {
+            if (bed_diff < TEMP_BED_WINDOW) bed_residency_ms = now;
+          }
+          else if (bed_diff > TEMP_BED_HYSTERESIS) {
+            // Restart the timer whenever the temperature falls outside the hysteresis.
+            bed_residency_ms = now;
+          }
+          if (!bed_residency_ms)
+            reached = false;
+          else if (bed_settle) {
+            #if ENABLED(BED_STABILITY_DETECTION)
+              if (!thermalManager.bedIsStable()) reached = false;
+            #else
+              if (PENDING(now, bed_residency_ms + (TEMP_BED_RESIDENCY_TIME) * 1000UL)) reached = false;
+            #endif
+          }
+        }
+      #endif
+
+      if (reached) break;
+
+      if (ELAPSED(now, next_temp_ms)) { // Print temperatures every second while waiting
+        next_temp_ms = now + 1000UL;
+        print_heaterstates();
+        #if ENABLED(BED_STABILITY_DETECTION)
+          if (bed && bed_settle) {
+            // Estimated time for the bed to settle
+            long rem = thermalManager.bedStableRemainingSeconds();
+            SERIAL_PROTOCOLPGM(" W:");
+            if (rem >= 0) SERIAL_PROTOCOLLN(rem); else SERIAL_PROTOCOLLNPGM("?");
+          }
+          else
+        #endif
+            SERIAL_EOL;
+      }
+
+      idle();
+      refresh_cmd_timeout(); // to prevent stepper_inactive_time from running out
+
+    } while (wait_for_heatup);
+
+    KEEPALIVE_STATE(IN_HANDLER);
+    return reached;
+  }
+
+  /**
+   * Probing needs a bed at its final size. Wait for a bed that is still
+   * heating or drifting. Only the bed counts: a hotend heating in the
+   * background doesn't move the bed, and its wait comes with the first extrusion.
+   */
+  bool bed_needs_wait_before_probing() {
+    #if HAS_TEMP_BED
+      return
+        #if ENABLED(BED_STABILITY_DETECTION)
+          (thermalManager.degTargetBed() && !thermalManager.bedIsStable()) ||
+        #endif
+        thermalManager.degBed() < thermalManager.degTargetBed() - (TEMP_BED_WINDOW);
+    #else
+      return false;
+    #endif
+  }
+
+  void wait_for_bed_before_probing() {
+    if (bed_needs_wait_before_probing()) {
+      LCD_MESSAGEPGM(MSG_BED_HEATING);
+      wait_for_heaters(false, true, true);
+      LCD_MESSAGEPGM(MSG_BED_DONE);
+    }
+  }
+
+#endif // HAS_HEATER_WAIT
+
 /**
  * M110: Set Current Line Number
  */
@@ -4464,7 +5280,22 @@ inline void gcode_M112() { kill(PSTR(MSG_KILLED)); }
  */
 inline void gcode_M140() {
   if (DEBUGGING(DRYRUN)) return;
-  if (code_seen('S')) thermalManager.setTargetBed(code_value_temp_abs());
+  if (code_seen('S')) {
+    #if ENABLED(UBL_MESH_BANK)
+      float old_target = thermalManager.degTargetBed();
+    #endif
+    thermalManager.setTargetBed(code_value_temp_abs());
+
+    #if ENABLED(UBL_MESH_BANK)
+      ubl_mesh_bank_select(old_target);
+    #endif
+
+    #if ENABLED(HEAT_IN_BACKGROUND)
+      // Only a bed that still has to heat before anything has moved, not a change mid-print
+      if (thermalManager.degTargetBed() && thermalManager.degBed() < thermalManager.degTargetBed() - (TEMP_BED_WINDOW) && !planner.blocks_queued())
+        background_heating = true;
+    #endif
+  }
 }
 
 #if ENABLED(ULTIPANEL)
@@ -4707,11 +5538,42 @@ static void report_current_position() {
  */
 inline void gcode_M114() { report_current_position(); }
 
+#if ENABLED(AUTO_REPORT_POSITION)
+
+  static uint8_t auto_report_position_interval = 0;
+  static millis_t next_position_report_ms;
+
+  /**
+   * M154: Report the position every S<seconds> (0 to stop), as M114 does
+   */
+  inline void gcode_M154() {
+    if (code_seen('S')) {
+      auto_report_position_interval = code_value_byte();
+      NOMORE(auto_report_position_interval, 60);
+      next_position_report_ms = millis() + 1000UL * auto_report_position_interval;
+    }
+  }
+
+  inline void auto_report_position() {
+    if (auto_report_position_interval && ELAPSED(millis(), next_position_report_ms)) {
+      next_position_report_ms = millis() + 1000UL * auto_report_position_interval;
+      report_current_position();
+    }
+  }
+
+#endif // AUTO_REPORT_POSITION
+
 /**
  * M115: Capabilities string
  */
 inline void gcode_M115() {
   SERIAL_PROTOCOLPGM(MSG_M115_REPORT);
+  #if ENABLED(AUTO_REPORT_TEMPERATURES)
+    SERIAL_PROTOCOLLNPGM("Cap:AUTOREPORT_TEMP:1");
+  #endif
+  #if ENABLED(AUTO_REPORT_POSITION)
+    SERIAL_PROTOCOLLNPGM("Cap:AUTOREPORT_POS:1");
+  #endif
 }
 
 /**
@@ -5412,6 +6274,54 @@ inline void gcode_M303() {
   #endif
 }
 
+#if ENABLED(MPCTEMP)
+
+  /**
+   * M306: Set or report the MPC model of a hotend, or measure it
+   *
+   *   E<hotend>  Hotend to change (default 0)
+   *   T          Autotune the hotend and apply the result
+   *   P<watts>   Heater power
+   *   C<J/K>     Heater block heat capacity
+   *   R<1/s>     Sensor responsiveness
+   *   A<W/K>     Ambient heat transfer coefficient with the part fan off
+   *   F<W/K>     Ambient heat transfer coefficient with the part fan at full speed
+   *   H<J/K/mm>  Filament heat capacity per mm
+   */
+  inline void gcode_M306() {
+    int e = code_seen('E') ? code_value_int() : 0;
+    if (e < 0 || e >= HOTENDS) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLN(MSG_INVALID_EXTRUDER);
+      return;
+    }
+
+    if (code_seen('T')) {
+      stepper.synchronize();
+      KEEPALIVE_STATE(NOT_BUSY); // don't send "busy: processing" messages during autotune output
+      thermalManager.MPC_autotune(e);
+      KEEPALIVE_STATE(IN_HANDLER);
+      return;
+    }
+
+    Temperature::mpc_t &mpc = thermalManager.mpc_constants[e];
+    if (code_seen('P')) mpc.heater_power = code_value_float();
+    if (code_seen('C')) mpc.block_heat_capacity = code_value_float();
+    if (code_seen('R')) mpc.sensor_responsiveness = code_value_float();
+    if (code_seen('A')) {
+      float fan255 = mpc.ambient_xfer_coeff_fan0 + mpc.fan255_adjustment;
+      mpc.ambient_xfer_coeff_fan0 = code_value_float();
+      mpc.fan255_adjustment = fan255 - mpc.ambient_xfer_coeff_fan0;
+    }
+    if (code_seen('F')) mpc.fan255_adjustment = code_value_float() - mpc.ambient_xfer_coeff_fan0;
+    if (code_seen('H')) mpc.filament_heat_capacity_permm = code_value_float();
+
+    SERIAL_ECHO_START;
+    thermalManager.MPC_report(e);
+  }
+
+#endif // MPCTEMP
+
 #if ENABLED(SCARA)
   bool SCARA_move_to_cal(uint8_t delta_x, uint8_t delta_y) {
     //SoftEndsEnabled = false;              // Ignore soft endstops during calibration
@@ -5632,6 +6542,9 @@ inline void gcode_M400() { stepper.synchronize(); }
  * will be out of sync with the stepper position after this.
  */
 inline void gcode_M410() {
+  #if ENABLED(UBL_BACKGROUND_JOBS)
+    if (ubl_job.type != NO_UBL_JOB) ubl_job.abort = true;
+  #endif
   stepper.quick_stop();
   #if DISABLED(DELTA) && DISABLED(SCARA)
     set_current_position_from_planner();
@@ -5686,6 +6599,204 @@ inline void gcode_M410() {
     }
   }
 
+  #if ENABLED(UBL_MESH_TRANSFER)
+
+    /**
+     * M422: Send the Mesh and the UBL State to the host in one line:
+     *
+     *   ubl mesh <base64 frame>
+     *
+     * M422 S: Take them back the same way. The printer answers "ubl ready"
+     * and the host then sends the frame (base64, ending in a newline). The
+     * frame is read straight from the serial port, so the host must wait
+     * for "ubl ready" before sending it. "ubl mesh loaded" or an error
+     * follows. The Mesh isn't saved; use G29 S or M500 for that.
+     *
+     * The frame, little-endian like the printer's memory:
+     *   version (UBL_MESH_FRAME_VERSION), n_x, n_y, sizeof(state)
+     *   blm.state
+     *   z_values[n_x][n_y] (float)
+     *   crc (uint16): CRC-16/CCITT (0x1021, starting from 0xFFFF) of the above
+     *
+     * A frame is only taken if its size and Mesh geometry match this
+     * firmware and the CRC checks. It starts with the version byte, so it
+     * can't look like M108, M112 or M410 to the EMERGENCY_PARSER.
+     * See scripts/ublmesh.py.
+     */
+    #define UBL_MESH_FRAME_HEADER 4
+    #define UBL_MESH_FRAME_SIZE (UBL_MESH_FRAME_HEADER + sizeof(blm.state) + sizeof(z_values) + 2)
+    #define UBL_MESH_FRAME_TIMEOUT 2000UL // ms to wait for the next character
+
+    static const char base64_chars[] PROGMEM = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    static uint8_t base64_bytes[3], base64_count;
+    static uint16_t ubl_frame_crc;
+
+    // Send bytes as base64, 4 characters for every 3 bytes. base64_flush() pads the rest.
+    static void base64_send(const void* data, uint16_t n) {
+      for (const uint8_t* p = (const uint8_t*)data; n--; p++) {
+        ubl_frame_crc = _crc_xmodem_update(ubl_frame_crc, *p);
+        base64_bytes[base64_count++] = *p;
+        if (base64_count < 3) continue;
+        uint32_t bits = ((uint32_t)base64_bytes[0] << 16) | (base64_bytes[1] << 8) | base64_bytes[2];
+        for (int8_t s = 18; s >= 0; s -= 6)
+          MYSERIAL.write(pgm_read_byte(&base64_chars[(bits >> s) & 0x3F]));
+        base64_count = 0;
+      }
+    }
+
+    static void base64_flush() {
+      if (!base64_count) return;
+      uint8_t pad = 3 - base64_count;
+      while (base64_count < 3) base64_bytes[base64_count++] = 0;
+      uint32_t bits = ((uint32_t)base64_bytes[0] << 16) | (base64_bytes[1] << 8) | base64_bytes[2];
+      for (int8_t s = 18; s >= 6 * pad; s -= 6)
+        MYSERIAL.write(pgm_read_byte(&base64_chars[(bits >> s) & 0x3F]));
+      while (pad--) MYSERIAL.write('=');
+      base64_count = 0;
+    }
+
+    static int8_t base64_value(char c) {
+      if (c >= 'A' && c <= 'Z') return c - 'A';
+      if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+      if (c >= '0' && c <= '9') return c - '0' + 52;
+      if (c == '+') return 62;
+      if (c == '/') return 63;
+      return -1;
+    }
+
+    /**
+     * Read a base64 line from the serial port into frame. Returns the number
+     * of bytes it held, or -1 on a bad character or a timeout. Characters
+     * come in faster than the RX buffer could hold them while idle() runs,
+     * so only the heaters are looked after while waiting.
+     */
+    static int16_t base64_receive(uint8_t* frame, uint16_t size) {
+      millis_t timeout = millis() + UBL_MESH_FRAME_TIMEOUT;
+      uint16_t bits = 0, n = 0;
+      uint8_t nbits = 0;
+      bool bad = false;
+
+      for (;;) {
+        if (MYSERIAL.available() <= 0) {
+          thermalManager.manage_heater();
+          if (ELAPSED(millis(), timeout)) return -1;
+          continue;
+        }
+        char c = MYSERIAL.read();
+        timeout = millis() + UBL_MESH_FRAME_TIMEOUT;
+        if (c == '\n' || c == '\r') {
+          if (n || nbits) break; // Blank lines before the frame are left over from the command
+          continue;
+        }
+        if (c == '=') continue;
+        int8_t v = base64_value(c);
+        if (v < 0) { bad = true; continue; }
+        bits = (bits << 6) | v;
+        nbits += 6;
+        if (nbits >= 8) {
+          nbits -= 8;
+          if (n < size) frame[n] = bits >> nbits;
+          n++;
+        }
+      }
+      return bad ? -1 : n;
+    }
+
+    inline void gcode_M422() {
+      const uint8_t header[UBL_MESH_FRAME_HEADER] = { UBL_MESH_FRAME_VERSION, MESH_NUM_X_POINTS, MESH_NUM_Y_POINTS, sizeof(blm.state) };
+
+      if (!code_seen('S')) {
+        SERIAL_PROTOCOLPGM(MSG_UBL_MESH_FRAME);
+        ubl_frame_crc = 0xFFFF;
+        base64_count = 0;
+        base64_send(header, sizeof(header));
+        base64_send(&blm.state, sizeof(blm.state));
+        base64_send(&z_values, sizeof(z_values));
+        uint16_t crc = ubl_frame_crc;
+        base64_send(&crc, sizeof(crc));
+        base64_flush();
+        SERIAL_EOL;
+        return;
+      }
+
+      #if ENABLED(BINARY_HOST_PROTOCOL)
+        if (binary_host_mode) {
+          SERIAL_ERROR_START;
+          SERIAL_ERRORLNPGM(MSG_ERR_UBL_MESH_BINARY);
+          return;
+        }
+      #endif
+
+      uint8_t frame[UBL_MESH_FRAME_SIZE];
+      bed_leveling::ubl_state* const state = (bed_leveling::ubl_state*)&frame[UBL_MESH_FRAME_HEADER];
+      const char* error = NULL;
+
+      SERIAL_PROTOCOLLNPGM(MSG_UBL_MESH_READY);
+      int16_t n = base64_receive(frame, sizeof(frame));
+
+      uint16_t crc = 0xFFFF;
+      for (uint16_t i = 0; i < sizeof(frame) - 2; i++) crc = _crc_xmodem_update(crc, frame[i]);
+
+      if (n < 0)
+        error = PSTR("unreadable");
+      else if (n != (int16_t)sizeof(frame) || memcmp(frame, header, sizeof(header)))
+        error = PSTR("wrong size");
+      else if (crc != (frame[sizeof(frame) - 2] | (frame[sizeof(frame) - 1] << 8)))
+        error = PSTR("bad CRC");
+      else if (state->n_x != MESH_NUM_X_POINTS || state->n_y != MESH_NUM_Y_POINTS
+               || state->mesh_x_min != blm.pre_initialized.mesh_x_min || state->mesh_y_min != blm.pre_initialized.mesh_y_min
+               || state->mesh_x_max != blm.pre_initialized.mesh_x_max || state->mesh_y_max != blm.pre_initialized.mesh_y_max)
+        error = PSTR("different Mesh");
+      else if (state->G29_Correction_Fade_Height <= 0.0 || state->G29_Correction_Fade_Height > 100.0)
+        error = PSTR("fade height");
+
+      if (error) {
+        SERIAL_ERROR_START;
+        SERIAL_ERRORPGM(MSG_ERR_UBL_MESH_FRAME);
+        serialprintPGM(error);
+        SERIAL_EOL;
+        return;
+      }
+
+      blm.state = *state;
+      blm.state.G29_Fade_Height_Multiplier = 1.0 / blm.state.G29_Correction_Fade_Height;
+      blm.state.EEPROM_storage_slot = -1; // It doesn't belong to any slot until G29 S stores it
+      memcpy(z_values, &frame[UBL_MESH_FRAME_HEADER + sizeof(blm.state)], sizeof(z_values));
+      #if ENABLED(SMART_PROBING)
+        memset(z_samples, 0, sizeof(z_samples)); // Nothing is known about how it was probed
+      #endif
+      SERIAL_PROTOCOLLNPGM(MSG_UBL_MESH_LOADED);
+    }
+
+  #endif // UBL_MESH_TRANSFER
+
+  #if ENABLED(UBL_BACKGROUND_JOBS)
+
+    /**
+     * M423: Control the running G26 or G29 job
+     *
+     *   P  Pause the job after the current step
+     *   R  Resume a paused job
+     *   A  Stop the job, the same way as a long click on the LCD
+     *
+     * The job's progress is reported in every case.
+     */
+    inline void gcode_M423() {
+      if (code_seen('A')) {
+        if (ubl_job.type != NO_UBL_JOB) ubl_job.abort = true;
+        ubl_job_report();
+      }
+      else if (code_seen('P'))
+        ubl_job_pause(true);
+      else if (code_seen('R'))
+        ubl_job_pause(false);
+      else
+        ubl_job_report();
+    }
+
+  #endif // UBL_BACKGROUND_JOBS
+
 #endif
 
 /**
@@ -5744,6 +6855,9 @@ inline void gcode_M500() {
  */
 inline void gcode_M501() {
   Config_RetrieveSettings();
+  #if ENABLED(UBL_MESH_BANK)
+    blm.mesh_bank_hold = false; // The stored UBL State is back in charge
+  #endif
 }
 
 /**
@@ -6129,6 +7243,23 @@ inline void gcode_M907() {
 
 #endif // HAS_MICROSTEPS
 
+#if ENABLED(BINARY_HOST_PROTOCOL)
+
+  /**
+   * M888: Switch the serial port to the binary host protocol.
+   *
+   * Replies with an ack for frame 255 giving the first limit, then "ok".
+   * Frames start from sequence number 0. An empty frame switches back.
+   */
+  inline void gcode_M888() {
+    binary_host_mode = true;
+    binary_frame_seq = 0;
+    binary_bytes_read = 0;
+    binary_host_ack();
+  }
+
+#endif // BINARY_HOST_PROTOCOL
+
 /**
  * M999: Restart after being stopped
  *
@@ -6352,7 +7483,11 @@ inline void gcode_T(uint8_t tmp_extruder) {
  * This is called from the main loop()
  */
 void process_next_command() {
-  current_command = command_queue[cmd_queue_index_r];
+  current_command = CMD_QUEUE_TEXT(cmd_queue_index_r);
+
+  #if ENABLED(BINARY_GCODE)
+    binary_args = (CMD_QUEUE_FLAGS(cmd_queue_index_r) & CMD_BINARY) ? (uint8_t*)current_command + strlen(current_command) + 1 : NULL;
+  #endif
 
   if (DEBUGGING(ECHO)) {
     SERIAL_ECHO_START;
@@ -6397,6 +7532,7 @@ void process_next_command() {
 
   // The command's arguments (if any) start here, for sure!
   current_command_args = cmd_ptr;
+  parse_command_args();
 
   KEEPALIVE_STATE(IN_HANDLER);
 
@@ -6755,6 +7891,18 @@ void process_next_command() {
 
       #endif //BLINKM
 
+      #if ENABLED(AUTO_REPORT_POSITION)
+        case 154: // M154: Report the position at an interval
+          gcode_M154();
+          break;
+      #endif
+
+      #if ENABLED(AUTO_REPORT_TEMPERATURES)
+        case 155: // M155: Report temperatures at an interval
+          gcode_M155();
+          break;
+      #endif
+
       #if ENABLED(EXPERIMENTAL_I2CBUS)
 
         case 155:
@@ -6879,6 +8027,12 @@ void process_next_command() {
         gcode_M303();
         break;
 
+      #if ENABLED(MPCTEMP)
+        case 306: // M306 MPC hotend model
+          gcode_M306();
+          break;
+      #endif // MPCTEMP
+
       #if ENABLED(SCARA)
         case 360:  // M360 SCARA Theta pos1
           if (gcode_M360()) return;
@@ -6929,6 +8083,10 @@ void process_next_command() {
       #endif // ENABLED(FILAMENT_WIDTH_SENSOR)
 
       case 410: // M410 quickstop - Abort all the planned moves.
+        #if ENABLED(EMERGENCY_PARSER)
+          // Done as soon as it arrived, if it came from serial
+          if (CMD_QUEUE_FLAGS(cmd_queue_index_r) & CMD_SEND_OK) break;
+        #endif
         gcode_M410();
         break;
 
@@ -6939,6 +8097,16 @@ void process_next_command() {
         case 421: // M421 Set a Mesh Bed Leveling Z coordinate
           gcode_M421();
           break;
+        #if ENABLED(UBL_MESH_TRANSFER)
+          case 422: // M422 Send or take the Mesh and the UBL State as one frame
+            gcode_M422();
+            break;
+        #endif
+        #if ENABLED(UBL_BACKGROUND_JOBS)
+          case 423: // M423 Pause, resume or stop the G26 / G29 job
+            gcode_M423();
+            break;
+        #endif
       #endif
 
       case 428: // M428 Apply current_position to home_offset
@@ -7024,6 +8192,12 @@ void process_next_command() {
 
       #endif // HAS_MICROSTEPS
 
+      #if ENABLED(BINARY_HOST_PROTOCOL)
+        case 888: // M888: Binary host protocol
+          gcode_M888();
+          break;
+      #endif
+
       case 999: // M999: Restart after being Stopped
         gcode_M999();
         break;
@@ -7057,10 +8231,11 @@ void FlushSerialRequestResend() {
 
 void ok_to_send() {
   refresh_cmd_timeout();
-  if (!send_ok[cmd_queue_index_r]) return;
+  // With no command queued (e.g., a resend request) there is always an "ok"
+  if (commands_in_queue && !(CMD_QUEUE_FLAGS(cmd_queue_index_r) & CMD_SEND_OK)) return;
   SERIAL_PROTOCOLPGM(MSG_OK);
   #if ENABLED(ADVANCED_OK)
-    char* p = command_queue[cmd_queue_index_r];
+    char* p = CMD_QUEUE_TEXT(cmd_queue_index_r);
     if (*p == 'N') {
       SERIAL_PROTOCOL(' ');
       SERIAL_ECHO(*p++);
@@ -7068,7 +8243,7 @@ void ok_to_send() {
         SERIAL_ECHO(*p++);
     }
     SERIAL_PROTOCOLPGM(" P"); SERIAL_PROTOCOL(int(BLOCK_BUFFER_SIZE - planner.movesplanned() - 1));
-    SERIAL_PROTOCOLPGM(" B"); SERIAL_PROTOCOL(BUFSIZE - commands_in_queue);
+    SERIAL_PROTOCOLPGM(" B"); SERIAL_PROTOCOL(command_queue_free());
   #endif
   SERIAL_EOL;
 }
@@ -7310,6 +8485,16 @@ void prepare_move_to_destination() {
   clamp_to_software_endstops(destination);
   refresh_cmd_timeout();
 
+  #if ENABLED(HEAT_IN_BACKGROUND)
+    // The first extruding move after a background heat-up waits for the heaters
+    if (background_heating && destination[E_AXIS] > current_position[E_AXIS]) {
+      LCD_MESSAGEPGM(MSG_HEATING);
+      wait_for_heaters(true, true, false);
+      background_heating = false;
+      LCD_MESSAGEPGM(MSG_HEATING_COMPLETE);
+    }
+  #endif
+
   #if ENABLED(PREVENT_DANGEROUS_EXTRUDE)
     prevent_dangerous_extrude(current_position[E_AXIS], destination[E_AXIS]);
   #endif
@@ -7655,6 +8840,39 @@ void disable_all_steppers() {
   disable_e3();
 }
 
+#if ENABLED(UBL_BACKGROUND_JOBS)
+
+  /**
+   * A G26 or G29 job keeps a copy of the arguments of the command that
+   * started it, so G29_finish() can act on the rest of them afterwards.
+   */
+  static char ubl_job_args[MAX_CMD_SIZE];
+  #if ENABLED(BINARY_GCODE)
+    static bool ubl_job_args_binary;
+  #endif
+
+  void save_command_args() {
+    #if ENABLED(BINARY_GCODE)
+      ubl_job_args_binary = (binary_args != NULL);
+      if (ubl_job_args_binary) {
+        memcpy(ubl_job_args, binary_args, min(binary_args[0] + 1, MAX_CMD_SIZE));
+        return;
+      }
+    #endif
+    strncpy(ubl_job_args, current_command_args, MAX_CMD_SIZE - 1);
+    ubl_job_args[MAX_CMD_SIZE - 1] = '\0';
+  }
+
+  void restore_command_args() {
+    #if ENABLED(BINARY_GCODE)
+      binary_args = ubl_job_args_binary ? (const uint8_t*)ubl_job_args : NULL;
+    #endif
+    current_command_args = ubl_job_args;
+    parse_command_args();
+  }
+
+#endif // UBL_BACKGROUND_JOBS
+
 /**
  * Standard idle routine keeps the machine alive
  */
@@ -7663,8 +8881,24 @@ void idle(
     bool no_stepper_sleep/*=false*/
   #endif
 ) {
+  #if ENABLED(EMERGENCY_PARSER)
+    if (emergency_kill) kill(PSTR(MSG_KILLED));
+    if (emergency_quickstop) {
+      emergency_quickstop = false;
+      gcode_M410();
+    }
+  #endif
+
   lcd_update();
   host_keepalive();
+
+  #if ENABLED(AUTO_REPORT_TEMPERATURES)
+    auto_report_temperatures();
+  #endif
+  #if ENABLED(AUTO_REPORT_POSITION)
+    auto_report_position();
+  #endif
+
   manage_inactivity(
     #if ENABLED(FILAMENT_CHANGE_FEATURE)
       no_stepper_sleep
@@ -7677,6 +8911,10 @@ void idle(
     print_job_timer.tick();
   #endif
 
+  #if ENABLED(SD_READ_AHEAD)
+    card.readAhead();
+  #endif
+
   #if HAS_BUZZER
     buzzer.tick();
   #endif
@@ -7696,12 +8934,19 @@ void idle(
  */
 void manage_inactivity(bool ignore_stepper_queue/*=false*/) {
 
+  #if ENABLED(UBL_MESH_BANK)
+    static bool job_was_running = false;
+    bool job_running = print_job_timer.isRunning() || print_job_timer.isPaused();
+    if (job_was_running && !job_running) blm.mesh_bank_hold = false; // The job G29 P1 probed for is over
+    job_was_running = job_running;
+  #endif
+
   #if ENABLED(FILAMENT_RUNOUT_SENSOR)
     if (IS_SD_PRINTING && !(READ(FIL_RUNOUT_PIN) ^ FIL_RUNOUT_INVERTING))
       handle_filament_runout();
   #endif
 
-  if (commands_in_queue < BUFSIZE) get_available_commands();
+  if (command_queue_has_room()) get_available_commands();
 
   millis_t ms = millis();
 
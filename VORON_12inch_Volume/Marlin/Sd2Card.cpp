@@ -159,6 +159,11 @@
 //------------------------------------------------------------------------------
 // send command and return error code.  Return zero for OK
 uint8_t Sd2Card::cardCommand(uint8_t cmd, uint32_t arg) {
+  #if ENABLED(SD_READ_AHEAD)
+    // any other command ends an open multiple block read
+    if (streaming_ && cmd != CMD12) readStop();
+  #endif
+
   // select card
   chipSelectLow();
 
@@ -424,6 +429,34 @@ bool Sd2Card::readData(uint8_t* dst) {
   return readData(dst, 512);
 }
 
+#if ENABLED(SD_READ_AHEAD)
+//------------------------------------------------------------------------------
+/** Read one data block in a multiple block read sequence if the card has it
+ * ready. Unlike readData() this doesn't wait for the start block token, so it
+ * can be retried from the idle loop until the data arrives.
+ *
+ * \param[in] dst Pointer to the location for the data to be read.
+ *
+ * \return 1 if the block was read, 0 if the card isn't ready yet or -1 if
+ * an error occurred.
+ */
+int8_t Sd2Card::readDataPoll(uint8_t* dst) {
+  chipSelectLow();
+  status_ = spiRec();
+  if (status_ == 0XFF) {
+    chipSelectHigh();
+    return 0;
+  }
+  if (status_ != DATA_START_BLOCK) {
+    error(SD_CARD_ERROR_READ);
+    chipSelectHigh();
+    spiSend(0XFF);
+    return -1;
+  }
+  return readTransfer(dst, 512) ? 1 : -1;
+}
+#endif
+
 #if ENABLED(SD_CHECK_AND_RETRY)
 static const uint16_t crctab[] PROGMEM = {
   0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
@@ -482,6 +515,17 @@ bool Sd2Card::readData(uint8_t* dst, uint16_t count) {
     error(SD_CARD_ERROR_READ);
     goto fail;
   }
+  return readTransfer(dst, count);
+fail:
+  chipSelectHigh();
+  // Send an additional dummy byte, required by Toshiba Flash Air SD Card
+  spiSend(0XFF);
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Transfer a data block and its CRC once the start block token is in. */
+bool Sd2Card::readTransfer(uint8_t* dst, uint16_t count) {
+  bool ok = true;
   // transfer data
   spiRead(dst, count);
 
@@ -492,7 +536,7 @@ bool Sd2Card::readData(uint8_t* dst, uint16_t count) {
     recvCrc |= spiRec();
     if (calcCrc != recvCrc) {
       error(SD_CARD_ERROR_CRC);
-      goto fail;
+      ok = false;
     }
   }
 #else
@@ -503,12 +547,7 @@ bool Sd2Card::readData(uint8_t* dst, uint16_t count) {
   chipSelectHigh();
   // Send an additional dummy byte, required by Toshiba Flash Air SD Card
   spiSend(0XFF);
-  return true;
-fail:
-  chipSelectHigh();
-  // Send an additional dummy byte, required by Toshiba Flash Air SD Card
-  spiSend(0XFF);
-  return false;
+  return ok;
 }
 //------------------------------------------------------------------------------
 /** read CID or CSR register */
@@ -541,6 +580,9 @@ bool Sd2Card::readStart(uint32_t blockNumber) {
     goto fail;
   }
   chipSelectHigh();
+  #if ENABLED(SD_READ_AHEAD)
+    streaming_ = true;
+  #endif
   return true;
 fail:
   chipSelectHigh();
@@ -553,6 +595,9 @@ fail:
  * the value zero, false, is returned for failure.
  */
 bool Sd2Card::readStop() {
+  #if ENABLED(SD_READ_AHEAD)
+    streaming_ = false;
+  #endif
   chipSelectLow();
   if (cardCommand(CMD12, 0)) {
     error(SD_CARD_ERROR_CMD12);
@@ -1106,6 +1106,80 @@ fail:
   return -1;
 }
 
+//------------------------------------------------------------------------------
+/** Locate the block holding the current position and the cluster it is in.
+ *
+ * The cluster chain is followed but curCluster_ is left untouched so the
+ * call can be repeated before the position moves.
+ *
+ * \param[out] block The raw device block number.
+ * \param[out] cluster The cluster that holds \a block.
+ *
+ * \return true for success or false for failure.
+ */
+bool SdBaseFile::curBlock(uint32_t* block, uint32_t* cluster) {
+  if (type_ == FAT_FILE_TYPE_ROOT_FIXED) {
+    *block = vol_->rootDirStart() + (curPosition_ >> 9);
+    return true;
+  }
+  uint8_t blockOfCluster = vol_->blockOfCluster(curPosition_);
+  *cluster = curCluster_;
+  if ((curPosition_ & 0X1FF) == 0 && blockOfCluster == 0) {
+    // start of new cluster
+    if (curPosition_ == 0)
+      *cluster = firstCluster_;
+    else if (!vol_->fatGet(curCluster_, cluster))
+      return false;
+  }
+  *block = vol_->clusterStartBlock(*cluster) + blockOfCluster;
+  return true;
+}
+//------------------------------------------------------------------------------
+/** Read the rest of the current block without copying it.
+ *
+ * The block is loaded into the volume cache and \a data is pointed at the
+ * current position within it. The position does not move; call
+ * readSpanDone() with the number of bytes consumed. The pointer is only
+ * valid until the next operation on the volume.
+ *
+ * \param[out] data Set to the first unread byte in the cache.
+ *
+ * \return The number of bytes up to the end of the block or the file,
+ * zero at end of file, or -1 if an error occurred.
+ */
+int16_t SdBaseFile::readSpan(uint8_t** data) {
+  uint32_t block, cluster;
+
+  // error if not open or write only
+  if (!isOpen() || !(flags_ & O_READ)) return -1;
+  if (curPosition_ >= fileSize_) return 0;
+
+  if (!curBlock(&block, &cluster)) return -1;
+  if (!vol_->cacheRawBlock(block, SdVolume::CACHE_FOR_READ)) return -1;
+
+  uint16_t offset = curPosition_ & 0X1FF;
+  uint16_t n = 512 - offset;
+  NOMORE(n, fileSize_ - curPosition_);
+  *data = vol_->cache()->data + offset;
+  return n;
+}
+//------------------------------------------------------------------------------
+/** Consume bytes returned by readSpan().
+ *
+ * \param[in] nbyte Bytes consumed, no more than readSpan() returned.
+ *
+ * \return true for success or false for failure.
+ */
+bool SdBaseFile::readSpanDone(uint16_t nbyte) {
+  if (!nbyte) return true;
+  if (type_ != FAT_FILE_TYPE_ROOT_FIXED) {
+    uint32_t block;
+    if (!curBlock(&block, &curCluster_)) return false;
+  }
+  curPosition_ += nbyte;
+  return true;
+}
+
 /**
  * Read the next entry in a directory.
  *
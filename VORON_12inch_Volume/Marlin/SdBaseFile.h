@@ -262,6 +262,14 @@ class SdBaseFile {
   uint32_t fileSize() const {return fileSize_;}
   /** \return The first cluster number for a file or directory. */
   uint32_t firstCluster() const {return firstCluster_;}
+  /** Follow the file's cluster chain.
+   * \param[in] cluster A cluster of the file.
+   * \param[out] next The cluster after it.
+   * \return true for success or false for failure.
+   */
+  bool nextCluster(uint32_t cluster, uint32_t* next) {
+    return vol_->fatGet(cluster, next);
+  }
   bool getFilename(char* name);
   /** \return True if this is a directory else false. */
   bool isDir() const {return type_ >= FAT_FILE_TYPE_MIN_DIR;}
@@ -293,6 +301,8 @@ class SdBaseFile {
   int16_t read();
   int16_t read(void* buf, uint16_t nbyte);
   int8_t readDir(dir_t* dir, char* longFilename);
+  int16_t readSpan(uint8_t** data);
+  bool readSpanDone(uint16_t nbyte);
   static bool remove(SdBaseFile* dirFile, const char* path);
   bool remove();
   /** Set the file's current position to zero. */
@@ -359,6 +369,7 @@ class SdBaseFile {
   bool openParent(SdBaseFile* dir);
   // private functions
   bool addCluster();
+  bool curBlock(uint32_t* block, uint32_t* cluster);
   bool addDirCluster();
   dir_t* cacheDirEntry(uint8_t action);
   int8_t lsPrintNext(uint8_t flags, uint8_t indent);
@@ -36,10 +36,9 @@
  *
  */
 
-#define EEPROM_VERSION "V30"
+#define EEPROM_VERSION "V31"
 
 // Change EEPROM version if these are changed:
-#define EEPROM_OFFSET 8
 #define MAX_EXTRUDERS 4
 
 
@@ -54,54 +53,23 @@
   #include "Bed_Leveling.h"
 #endif
 
-uint16_t eeprom_16_bit_CRC;
 const char version[4] = EEPROM_VERSION;
 
 
-// This is a CCITT approved 16-Bit CRC.  It will catch most errors
-// that a Checksum will miss.
-
-uint16_t crc16mp( void *data_p, uint16_t count) {
-    uint16_t  xx;
-    uint8_t   *ptr = (uint8_t *) data_p;
-
-    while (count-- > 0) {
-        eeprom_16_bit_CRC=(uint16_t)(eeprom_16_bit_CRC^(uint16_t)(((uint16_t)*ptr++)<<8));
-        for (xx=0; xx<8; xx++) {
-            if(eeprom_16_bit_CRC & 0x8000) { 
-		    eeprom_16_bit_CRC=(uint16_t)((uint16_t)(eeprom_16_bit_CRC<<1)^0x1021); 
-	    }
-            else  { 
-		    eeprom_16_bit_CRC=(uint16_t)(eeprom_16_bit_CRC<<1);                }
-            }
-        }
-    return(eeprom_16_bit_CRC);
-}
+static bool eeprom_dry_run,   // Set while working out how big the settings record is,
+            eeprom_differs;   // and whether it differs from what is already at pos
 
 void _EEPROM_writeData(int &pos, uint8_t* value, uint8_t size) {
-  uint8_t c;
-  while (size--) {
-    eeprom_write_byte((unsigned char*)pos, *value);
-    c = eeprom_read_byte((unsigned char*)pos);
-    if (c != *value) {
-      SERIAL_ECHO_START;
-      SERIAL_ECHOLNPGM(MSG_ERR_EEPROM_WRITE);
-    }
-//  eeprom_16_bit_CRC += c;
-    crc16mp( &c, 1);
-    pos++;
-    value++;
-  };
+  if (!eeprom_dry_run)
+    eeprom_update_data(pos, value, size);
+  else
+    for (uint8_t n = 0; n < size && !eeprom_differs; n++)
+      eeprom_differs = eeprom_read_byte((unsigned char*)(pos + n)) != value[n];
+  pos += size;
 }
 void _EEPROM_readData(int &pos, uint8_t* value, uint8_t size) {
-  do {
-    uint8_t c = eeprom_read_byte((unsigned char*)pos);
-    *value = c;
-//  eeprom_16_bit_CRC += c;
-    crc16mp( &c, 1);
-    pos++;
-    value++;
-  } while (--size);
+  eeprom_read_block((void*)value, (void*)pos, size);
+  pos += size;
 }
 
 /**
@@ -115,7 +83,7 @@ void Config_Postprocess() {
     recalc_delta_settings(delta_radius, delta_diagonal_rod);
   #endif
 
-  #if ENABLED(PIDTEMP)
+  #if HAS_PID_HEATING
     thermalManager.updatePID();
   #endif
 
@@ -129,22 +97,14 @@ void Config_Postprocess() {
   #define EEPROM_READ_VAR(pos, value) _EEPROM_readData(pos, (uint8_t*)&value, sizeof(value))
 
 /**
- * M500 - Store Configuration
+ * Write the settings, in order, from EEPROM address i. Returns the address
+ * after the last one. With eeprom_dry_run set nothing is written, which is
+ * how the size of the settings record is worked out.
  */
-void Config_StoreSettings()  {
+static int Config_WriteSettings(int i) {
   float dummy = 0.0f;
-  char ver[4] = "000";
-  int i = EEPROM_OFFSET;
 
-  EEPROM_WRITE_VAR(i, ver);     // invalidate data first
-  				// But as a "To Do" item, we really should include the version 
-				// number in the CRC that we store.   For now it is OK, if it is
-				// wrong (or corrupted) we should check it with the implicit comparison
-				// we do.
-				
-  i += sizeof(eeprom_16_bit_CRC); // Skip the checksum slot
-
-  eeprom_16_bit_CRC = 0xffff; // CCITT prefers a starting value of all 1 bits
+  EEPROM_WRITE_VAR(i, version);
 
   EEPROM_WRITE_VAR(i, planner.axis_steps_per_mm);
   EEPROM_WRITE_VAR(i, planner.max_feedrate);
@@ -238,6 +198,18 @@ void Config_StoreSettings()  {
     EEPROM_WRITE_VAR(i, thermalManager.bedKd);
   #endif
 
+  #if ENABLED(MPCTEMP)
+    for (uint8_t e = 0; e < HOTENDS; e++) {
+      Temperature::mpc_t &mpc = thermalManager.mpc_constants[e];
+      EEPROM_WRITE_VAR(i, mpc.heater_power);
+      EEPROM_WRITE_VAR(i, mpc.block_heat_capacity);
+      EEPROM_WRITE_VAR(i, mpc.sensor_responsiveness);
+      EEPROM_WRITE_VAR(i, mpc.ambient_xfer_coeff_fan0);
+      EEPROM_WRITE_VAR(i, mpc.fan255_adjustment);
+      EEPROM_WRITE_VAR(i, mpc.filament_heat_capacity_permm);
+    }
+  #endif // MPCTEMP
+
   #if !HAS_LCD_CONTRAST
     const int lcd_contrast = 32;
   #endif
@@ -279,16 +251,47 @@ void Config_StoreSettings()  {
     EEPROM_WRITE_VAR(i, dummy);
   }
 
-  uint16_t final_checksum = eeprom_16_bit_CRC;
+  return i;
+}
 
-  int j = EEPROM_OFFSET;
-  EEPROM_WRITE_VAR(j, version);
-  EEPROM_WRITE_VAR(j, final_checksum);
+/**
+ * Size of the settings record, without writing it. eeprom_differs is set
+ * if the settings differ from the ones stored at pos.
+ */
+static uint16_t Config_SettingsSize(int pos=0) {
+  eeprom_dry_run = true;
+  eeprom_differs = false;
+  uint16_t size = Config_WriteSettings(pos) - pos;
+  eeprom_dry_run = false;
+  return size;
+}
 
-  // Report storage size
-  SERIAL_ECHO_START;
-  SERIAL_ECHOPAIR("Settings Stored (", i);
-  SERIAL_ECHOLNPGM(" bytes)");
+/**
+ * M500 - Store Configuration
+ */
+void Config_StoreSettings()  {
+  uint8_t record_version;
+  uint16_t stored_size;
+  int i = eeprom_record_find(EEPROM_RECORD_SETTINGS, 0, record_version, stored_size);
+  uint16_t size = Config_SettingsSize(max(i, 0));
+  millis_t started = millis();
+  eeprom_bytes_written = 0;
+
+  if (i >= 0 && size == stored_size && !eeprom_differs) {
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("Settings unchanged");
+  }
+  else if ((i = eeprom_record_begin(EEPROM_RECORD_SETTINGS, 0, 0, size)) >= 0) {
+    Config_WriteSettings(i);
+    eeprom_record_end();
+
+    // Report storage size, how much of it changed, and how long that took
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPAIR("Settings Stored (", size);
+    SERIAL_ECHOPAIR(" bytes, ", eeprom_bytes_written);
+    SERIAL_ECHOPAIR(" changed, ", millis() - started);
+    SERIAL_ECHOLNPGM(" ms)");
+  }
 
 // It can be argued that the M500 should only save the state of the Unified Bed Leveling System and
 // not the active mesh.  Especially since the Unified Bed Leveling System has its own Load and Store
@@ -311,20 +314,22 @@ void Config_StoreSettings()  {
  * M501 - Retrieve Configuration
  */
 void Config_RetrieveSettings() {
-  int i = EEPROM_OFFSET;
-  char stored_ver[4];
-  uint16_t Stored_CRC;
-  EEPROM_READ_VAR(i, stored_ver);
-  EEPROM_READ_VAR(i, Stored_CRC);
+  char stored_ver[4] = "";
+  uint8_t record_version;
+  uint16_t size;
 
-  if (strncmp(version, stored_ver, 3) != 0) {
+  eeprom_store_init();  // One pass over the EEPROM finds every record and checks its CRC
+
+  int i = eeprom_record_find(EEPROM_RECORD_SETTINGS, 0, record_version, size);
+  if (i >= 0) EEPROM_READ_VAR(i, stored_ver);
+
+  // A different size means the settings changed without the version being bumped
+  if (strncmp(version, stored_ver, 3) != 0 || size != Config_SettingsSize()) {
     Config_ResetDefault();
   }
   else {
     float dummy = 0;
 
-    eeprom_16_bit_CRC = 0xffff; // CCITT prefers a starting value of all 1 bits
-
     // version number match
     EEPROM_READ_VAR(i, planner.axis_steps_per_mm);
     EEPROM_READ_VAR(i, planner.max_feedrate);
@@ -418,6 +423,18 @@ void Config_RetrieveSettings() {
       for (uint8_t q=3; q--;) EEPROM_READ_VAR(i, dummy); // bedKp, bedKi, bedKd
     #endif
 
+    #if ENABLED(MPCTEMP)
+      for (uint8_t e = 0; e < HOTENDS; e++) {
+        Temperature::mpc_t &mpc = thermalManager.mpc_constants[e];
+        EEPROM_READ_VAR(i, mpc.heater_power);
+        EEPROM_READ_VAR(i, mpc.block_heat_capacity);
+        EEPROM_READ_VAR(i, mpc.sensor_responsiveness);
+        EEPROM_READ_VAR(i, mpc.ambient_xfer_coeff_fan0);
+        EEPROM_READ_VAR(i, mpc.fan255_adjustment);
+        EEPROM_READ_VAR(i, mpc.filament_heat_capacity_permm);
+      }
+    #endif // MPCTEMP
+
     #if !HAS_LCD_CONTRAST
       int lcd_contrast;
     #endif
@@ -455,31 +472,16 @@ void Config_RetrieveSettings() {
       if (q < EXTRUDERS) filament_size[q] = dummy;
     }
 
-    if (eeprom_16_bit_CRC == Stored_CRC) {
-      SERIAL_ECHO_START;
-      SERIAL_ECHO(version);
-      SERIAL_ECHOPAIR(" stored settings retrieved (", i);
-      SERIAL_ECHOLNPGM(" bytes)");
-      Config_Postprocess(); 
-	}
-    else {
-      SERIAL_ERROR_START;
-/*
-SERIAL_ECHO(" eeprom_16_bit_CRC:");
-prt_hex_word(eeprom_16_bit_CRC);
-SERIAL_ECHO(" Stored_CRC:");
-prt_hex_word( Stored_CRC);
-SERIAL_ERRORLNPGM("\n");
-*/
-      SERIAL_ERRORLNPGM("EEPROM checksum mismatch");
-      Config_ResetDefault();
-    }
+    SERIAL_ECHO_START;
+    SERIAL_ECHO(version);
+    SERIAL_ECHOPAIR(" stored settings retrieved (", size);
+    SERIAL_ECHOLNPGM(" bytes)");
+    Config_Postprocess();
+  }
 
 #ifdef UNIFIED_BED_LEVELING_FEATURE
-    Unified_Bed_Leveling_EEPROM_start = (i + 32) & 0xfff8;  	// Pad the end of configuration data so it
-   								// can float up or down a little bit without
-								// disrupting the Unified Bed Leveling data 
-    blm.load_state();
+    blm.load_state();		// The UBL State and Meshes are records of their own.  They survive
+    				// a change to the settings above.
 
 if ( blm.state.active )
 SERIAL_ECHO(" UBL Active!\n");
@@ -491,10 +493,17 @@ SERIAL_ECHO(" UBL Not active!\n");
       bool tmp_active;		// If it is, we want to preserve the Mesh that is being used.
       tmp_mesh = blm.state.EEPROM_storage_slot;
       tmp_active = blm.state.active; 
+    #if ENABLED(UBL_MESH_BANK)
+      int16_t tmp_bank_temp[UBL_MESH_BANK_SLOTS];	// And which bed temperature each stored Mesh was probed at
+      memcpy( tmp_bank_temp, blm.state.mesh_bank_temp, sizeof(tmp_bank_temp) );
+    #endif
       SERIAL_ECHOLNPGM("\nInitializing Bed Leveling State to current firmware settings.\n");
       blm.state = blm.pre_initialized;
       blm.state.EEPROM_storage_slot = tmp_mesh;
       blm.state.active              = tmp_active;
+    #if ENABLED(UBL_MESH_BANK)
+      memcpy( blm.state.mesh_bank_temp, tmp_bank_temp, sizeof(tmp_bank_temp) );
+    #endif
     }
     else {
       SERIAL_PROTOCOLPGM("?Unable to enable Unified Bed Leveling.\n");
@@ -513,7 +522,6 @@ SERIAL_ECHO(" UBL Not active!\n");
 SERIAL_ECHO("UBL System reset() \n");
     }
 #endif
-  }
 
   #if ENABLED(EEPROM_CHITCHAT)
     Config_PrintSettings();
@@ -613,6 +621,18 @@ void Config_ResetDefault() {
     thermalManager.bedKd = scalePID_d(DEFAULT_bedKd);
   #endif
 
+  #if ENABLED(MPCTEMP)
+    for (uint8_t e = 0; e < HOTENDS; e++) {
+      Temperature::mpc_t &mpc = thermalManager.mpc_constants[e];
+      mpc.heater_power = MPC_HEATER_POWER;
+      mpc.block_heat_capacity = MPC_BLOCK_HEAT_CAPACITY;
+      mpc.sensor_responsiveness = MPC_SENSOR_RESPONSIVENESS;
+      mpc.ambient_xfer_coeff_fan0 = MPC_AMBIENT_XFER_COEFF;
+      mpc.fan255_adjustment = (MPC_AMBIENT_XFER_COEFF_FAN255) - (MPC_AMBIENT_XFER_COEFF);
+      mpc.filament_heat_capacity_permm = FILAMENT_HEAT_CAPACITY_PERMM;
+    }
+  #endif
+
   #if ENABLED(FWRETRACT)
     autoretract_enabled = false;
     retract_length = RETRACT_LENGTH;
@@ -760,9 +780,8 @@ void Config_PrintSettings(bool forReplay) {
     SERIAL_PROTOCOLPGM("\n");
 
 /*    
-    SERIAL_ECHOPAIR("EEPROM can hold ", (int) ((E2END-sizeof(blm.state )
-				    		-Unified_Bed_Leveling_EEPROM_start)/sizeof(blm.z_values)));
-    SERIAL_ECHOLNPGM(" meshes. \n");
+    SERIAL_ECHOPAIR("EEPROM can hold ", eeprom_store_room(sizeof(z_values)));
+    SERIAL_ECHOLNPGM(" more meshes. \n");
 */
 
     SERIAL_ECHOPAIR("\nMESH_NUM_X_POINTS  ", MESH_NUM_X_POINTS );
@@ -882,6 +901,17 @@ void Config_PrintSettings(bool forReplay) {
 
   #endif // PIDTEMP || PIDTEMPBED
 
+  #if ENABLED(MPCTEMP)
+    CONFIG_ECHO_START;
+    if (!forReplay) {
+      SERIAL_ECHOLNPGM("Model predictive control:");
+    }
+    for (uint8_t e = 0; e < HOTENDS; e++) {
+      CONFIG_ECHO_START;
+      thermalManager.MPC_report(e);
+    }
+  #endif
+
   #if HAS_LCD_CONTRAST
     CONFIG_ECHO_START;
     if (!forReplay) {
@@ -24,6 +24,7 @@
 #define CONFIGURATION_STORE_H
 
 #include "Configuration.h"
+#include "eeprom_store.h"
 
 void Config_ResetDefault();
 
@@ -0,0 +1,441 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * eeprom_store.cpp
+ *
+ * CRC, EEPROM writes and the record store that configuration_store.cpp and
+ * the Unified Bed Leveling System keep their data in
+ */
+
+#ifndef EEPROM_STORE_HOST_TEST // test/eeprom_store_test.cpp provides the few Marlin and AVR bits used here
+  #include "Marlin.h"
+  #include "language.h"
+#endif
+#include "eeprom_store.h"
+
+uint16_t eeprom_16_bit_CRC;
+
+// This is a CCITT approved 16-Bit CRC.  It will catch most errors
+// that a Checksum will miss.  The table holds the CRC of each byte
+// value, so each byte of data costs one lookup instead of 8 shifts.
+
+static const uint16_t crc16_table[256] PROGMEM = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+  0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+  0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+  0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+  0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+  0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+  0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+  0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+  0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+  0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+  0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+  0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+  0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+  0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+  0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+  0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+  0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+  0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+  0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+  0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+  0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+  0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+  0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+  0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+  0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+  0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+  0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+  0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+  0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+  0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+  0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+uint16_t crc16mp( void *data_p, uint16_t count) {
+    uint8_t   *ptr = (uint8_t *) data_p;
+
+    while (count-- > 0)
+        eeprom_16_bit_CRC = (eeprom_16_bit_CRC << 8) ^ pgm_read_word(&crc16_table[(uint8_t)(eeprom_16_bit_CRC >> 8) ^ *ptr++]);
+    return(eeprom_16_bit_CRC);
+}
+
+uint16_t eeprom_bytes_written;
+
+/**
+ * Write a block to EEPROM, skipping the bytes that already hold the right
+ * value. An EEPROM write takes 3.3ms and wears the cell, a read is almost
+ * free. Returns the number of bytes that had to be written, which are also
+ * added to eeprom_bytes_written.
+ */
+uint16_t eeprom_update_data(int pos, const void* data, uint16_t size) {
+  const uint8_t* value = (const uint8_t*)data;
+  uint16_t written = 0;
+  for (; size--; pos++, value++) {
+    if (eeprom_read_byte((unsigned char*)pos) == *value) continue;
+    eeprom_write_byte((unsigned char*)pos, *value);
+    if (eeprom_read_byte((unsigned char*)pos) != *value) {
+      SERIAL_ECHO_START;
+      SERIAL_ECHOLNPGM(MSG_ERR_EEPROM_WRITE);
+    }
+    written++;
+  }
+  eeprom_bytes_written += written;
+  return written;
+}
+
+/**
+ * EEPROM record store
+ *
+ * Everything kept in EEPROM is a record: a small header followed by the data.
+ * The header carries the record type, an id (the Mesh slot for meshes), a
+ * layout version, a sequence number, the data length and a CRC over both.
+ *
+ * Records are appended round-robin at the tail of a ring that fills the EEPROM
+ * past its first few bytes. Saving something writes a new copy and leaves the old one
+ * behind, so the same cells aren't rewritten on every M500 and a record can
+ * change size without moving anything else. When the ring runs short of room,
+ * records are reclaimed at the head: dead copies are dropped and live ones are
+ * copied to the tail first.
+ *
+ * A record that doesn't fit before the end of the EEPROM is preceded by a PAD
+ * record (or by nothing, if not even a header fits) and goes to the start.
+ *
+ * Nothing records where the head is, so no cell is written more than once a
+ * lap. Every lap begins at the start of the ring, and at boot the records from
+ * there are followed for as long as their CRC checks and their sequence numbers
+ * follow on. That finds the tail. What's left of the lap before lies past the
+ * tail, and the first record there whose records run on to the end and into
+ * the first one of this lap is taken as the head. It may be a dead copy, which
+ * only means a few more records to step over when reclaiming. The records from
+ * the head to the tail are then walked in order, so the newest copy of every
+ * record ends up in a small RAM index.
+ *
+ * Records are only written at the tail, with the header last, so a reset part
+ * way through leaves a record whose CRC fails and the ring ends before it.
+ */
+
+#define EEPROM_STORE_START 8    // The first bytes are left alone
+#define EEPROM_STORE_END (E2END + 1)
+#define EEPROM_STORE_SIZE (EEPROM_STORE_END - EEPROM_STORE_START)
+#define EEPROM_RECORD_KEYS (2 + EEPROM_MESH_SLOTS)
+
+typedef struct {
+  uint16_t seq;             // One more than the record before it
+  uint8_t type, id, version;
+  uint16_t length;          // Bytes of data following the header
+  uint16_t crc;             // Of the header up to here and the data
+} eeprom_record;
+
+static bool store_ready = false;
+static int store_head, store_tail;
+static uint16_t store_seq,
+                store_live,         // Bytes taken by the newest copy of every record
+                store_largest;      // Biggest record there is, header included
+static uint16_t store_index[EEPROM_RECORD_KEYS];  // Where the newest copy of each record is. 0 if none.
+static eeprom_record store_pending; // The record between eeprom_record_begin() and eeprom_record_end()
+static int store_pending_pos;
+
+static int record_key(uint8_t type, uint8_t id) {
+  switch (type) {
+    case EEPROM_RECORD_SETTINGS: return id == 0 ? 0 : -1;
+    case EEPROM_RECORD_UBL_STATE: return id == 0 ? 1 : -1;
+    case EEPROM_RECORD_MESH: return id < EEPROM_MESH_SLOTS ? 2 + id : -1;
+  }
+  return -1;
+}
+
+static uint16_t record_size(const eeprom_record &r) {
+  return sizeof(r) + (r.type == EEPROM_RECORD_PAD ? 0 : r.length);
+}
+
+static uint16_t record_crc(int pos, const eeprom_record &r) {
+  eeprom_16_bit_CRC = 0xffff;
+  crc16mp((void*)&r, offsetof(eeprom_record, crc));
+  int end = pos + record_size(r);
+  for (pos += sizeof(r); pos < end; pos++) {
+    uint8_t c = eeprom_read_byte((unsigned char*)pos);
+    crc16mp(&c, 1);
+  }
+  return eeprom_16_bit_CRC;
+}
+
+static bool read_record(int pos, eeprom_record &r) {
+  if (pos < EEPROM_STORE_START || EEPROM_STORE_END - pos < (int)sizeof(r)) return false;
+  eeprom_read_block((void*)&r, (void*)pos, sizeof(r));
+  if (r.type > EEPROM_RECORD_MESH || pos + record_size(r) > EEPROM_STORE_END) return false;
+  return r.crc == record_crc(pos, r);
+}
+
+// Where the record after r starts
+static int record_next(int pos, const eeprom_record &r) {
+  if (r.type == EEPROM_RECORD_PAD) return EEPROM_STORE_START;
+  pos += record_size(r);
+  return EEPROM_STORE_END - pos < (int)sizeof(r) ? EEPROM_STORE_START : pos;
+}
+
+static uint16_t store_used() { return (store_tail - store_head + EEPROM_STORE_SIZE) % EEPROM_STORE_SIZE; }
+
+// Bytes a record with length bytes of data takes at the tail, counting what's skipped at the end
+static uint16_t store_needed(uint16_t length) {
+  uint16_t size = sizeof(eeprom_record) + length;
+  int end = store_tail + size;
+  if (end > EEPROM_STORE_END) return size + EEPROM_STORE_END - store_tail;
+  return EEPROM_STORE_END - end < (int)sizeof(eeprom_record) ? size + EEPROM_STORE_END - end : size;
+}
+
+// The tail never quite catches up with the head, so head == tail means empty
+static bool store_fits(uint16_t length) { return store_needed(length) < EEPROM_STORE_SIZE - store_used(); }
+
+// True if the records from pos on check, follow on and run to the end, the last coming just before seq (any if < 0)
+static bool store_runs_to_end(int pos, int32_t seq) {
+  eeprom_record r;
+  if (!read_record(pos, r)) return false;
+  for (;;) {
+    uint16_t next_seq = r.seq + 1;
+    pos = record_next(pos, r);
+    if (pos == EEPROM_STORE_START) return seq < 0 || next_seq == seq;
+    if (!read_record(pos, r) || r.seq != next_seq) return false;
+  }
+}
+
+/**
+ * Find the tail and the head, and walk the ring from one to the other
+ * building the index. A blank EEPROM, or one written by older firmware,
+ * has no records and the store starts out empty. Nothing is written.
+ */
+void eeprom_store_init() {
+  eeprom_record r, first;
+  bool lap_closed = false;
+  int32_t first_seq = -1;
+  int pos;
+
+  memset(store_index, 0, sizeof(store_index));
+  store_live = store_largest = 0;
+  store_seq = 0;
+  store_ready = true;
+
+  // This lap runs from the start to the tail
+  store_tail = EEPROM_STORE_START;
+  if (read_record(store_tail, first)) {
+    first_seq = first.seq;
+    r = first;
+    for (;;) {
+      uint16_t next_seq = r.seq + 1;
+      store_tail = record_next(store_tail, r);
+      if (store_tail == EEPROM_STORE_START) { lap_closed = true; break; } // Reset just after the PAD record
+      if (!read_record(store_tail, r) || r.seq != next_seq) break;
+    }
+  }
+
+  if (lap_closed)
+    store_head = record_next(EEPROM_STORE_START, first);  // The next record goes over the first, so it's dead
+  else {
+    // The lap before ends past the tail. Whatever is at the tail is about to be written over.
+    for (store_head = store_tail + 1; store_head < EEPROM_STORE_END; store_head++)
+      if (store_runs_to_end(store_head, first_seq)) break;
+    if (store_head >= EEPROM_STORE_END) store_head = EEPROM_STORE_START;
+  }
+
+  for (pos = store_head; pos != store_tail && read_record(pos, r);) {
+    int k = record_key(r.type, r.id);
+    if (k >= 0) store_index[k] = pos;
+    store_seq = r.seq + 1;
+    pos = record_next(pos, r);
+  }
+
+  if (store_head == store_tail) {
+    SERIAL_ECHO_START;
+    SERIAL_ECHOLNPGM("EEPROM record store empty");
+    return;
+  }
+
+  for (uint8_t k = 0; k < EEPROM_RECORD_KEYS; k++) {
+    if (!store_index[k]) continue;
+    eeprom_read_block((void*)&r, (void*)store_index[k], sizeof(r));
+    store_live += record_size(r);
+    NOLESS(store_largest, record_size(r));
+  }
+}
+
+// Start a record at the tail, putting a PAD record in front of it if it has to go to the start
+static int store_append(uint8_t type, uint8_t id, uint8_t version, uint16_t length) {
+  if (store_tail + sizeof(eeprom_record) + length > EEPROM_STORE_END) {
+    if (EEPROM_STORE_END - store_tail >= (int)sizeof(eeprom_record)) {
+      memset(&store_pending, 0, sizeof(store_pending));
+      store_pending.type = EEPROM_RECORD_PAD;
+      store_pending.length = EEPROM_STORE_END - store_tail - sizeof(eeprom_record);
+      store_pending_pos = store_tail;
+      eeprom_record_end();
+    }
+    store_tail = EEPROM_STORE_START;
+  }
+  memset(&store_pending, 0, sizeof(store_pending));
+  store_pending.type = type;
+  store_pending.id = id;
+  store_pending.version = version;
+  store_pending.length = length;
+  store_pending_pos = store_tail;
+  return store_tail + sizeof(eeprom_record);
+}
+
+/**
+ * Move the head past one record, copying it to the tail first if it's the
+ * newest copy. Returns how far the head moved, 0 if it couldn't.
+ */
+static uint16_t store_reclaim() {
+  eeprom_record r;
+  int pos = store_head, k;
+  uint8_t buffer[16];
+
+  if (pos == store_tail || !read_record(pos, r)) return 0;
+  k = record_key(r.type, r.id);
+  if (r.type != EEPROM_RECORD_PAD && k >= 0 && store_index[k] == pos) {
+    if (!store_fits(r.length)) return 0;
+    int to = store_append(r.type, r.id, r.version, r.length);
+    for (uint16_t done = 0; done < r.length; done += sizeof(buffer)) {
+      uint16_t n = min(sizeof(buffer), r.length - done);
+      eeprom_read_block((void*)buffer, (void*)(pos + sizeof(r) + done), n);
+      eeprom_update_data(to + done, buffer, n);
+    }
+    eeprom_record_end();
+  }
+  store_head = record_next(pos, r);
+  return (store_head - pos + EEPROM_STORE_SIZE) % EEPROM_STORE_SIZE;
+}
+
+/**
+ * Make room for a record with length bytes of data and start it at the tail.
+ * Returns the EEPROM address to write the data to, or -1 if the store is full.
+ * The record only counts once eeprom_record_end() is called.
+ */
+int eeprom_record_begin(uint8_t type, uint8_t id, uint8_t version, uint16_t length) {
+  uint16_t size = sizeof(eeprom_record) + length, replaced = 0, largest;
+  int k = record_key(type, id);
+  eeprom_record r;
+
+  if (!store_ready || k < 0) return -1;
+
+  if (store_index[k]) {
+    eeprom_read_block((void*)&r, (void*)store_index[k], sizeof(r));
+    replaced = record_size(r);
+  }
+
+  // Reclaiming copies live records to the tail, which takes room for the biggest record, plus
+  // what gets skipped at the end of the EEPROM on the way round. Keep three times that free.
+  largest = max(store_largest, size);
+  if ((uint32_t)store_live - replaced + size + 3 * largest > EEPROM_STORE_SIZE) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("EEPROM full");
+    return -1;
+  }
+
+  for (uint16_t reclaimed = 0; reclaimed < EEPROM_STORE_SIZE && EEPROM_STORE_SIZE - store_used() < store_needed(length) + 3 * largest;) {
+    uint16_t moved = store_reclaim();
+    if (!moved) break;
+    reclaimed += moved;
+  }
+
+  if (EEPROM_STORE_SIZE - store_used() <= store_needed(length) + largest) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM("EEPROM full");
+    return -1;
+  }
+  return store_append(type, id, version, length);
+}
+
+/**
+ * Seal the record started by eeprom_record_begin() with its CRC and make it
+ * the newest copy.
+ */
+void eeprom_record_end() {
+  eeprom_record &r = store_pending;
+  int k = record_key(r.type, r.id);
+
+  r.seq = store_seq++;
+  r.crc = record_crc(store_pending_pos, r);
+  eeprom_update_data(store_pending_pos, &r, sizeof(r));   // The header goes last
+
+  if (k >= 0) {
+    if (store_index[k]) {
+      eeprom_record old;
+      eeprom_read_block((void*)&old, (void*)store_index[k], sizeof(old));
+      store_live -= record_size(old);
+    }
+    store_index[k] = store_pending_pos;
+    store_live += record_size(r);
+    NOLESS(store_largest, record_size(r));
+  }
+  store_tail = record_next(store_pending_pos, r);
+}
+
+/**
+ * Store a record in one go, unless the newest copy already holds the same
+ * data. Returns false if it didn't fit.
+ */
+bool eeprom_record_write(uint8_t type, uint8_t id, uint8_t version, const void* data, uint16_t length) {
+  uint8_t stored_version;
+  uint16_t stored_length;
+  int pos = eeprom_record_find(type, id, stored_version, stored_length);
+
+  if (pos >= 0 && stored_version == version && stored_length == length) {
+    const uint8_t* value = (const uint8_t*)data;
+    uint16_t n = 0;
+    while (n < length && eeprom_read_byte((unsigned char*)(pos + n)) == value[n]) n++;
+    if (n == length) return true;
+  }
+
+  pos = eeprom_record_begin(type, id, version, length);
+  if (pos < 0) return false;
+  eeprom_update_data(pos, data, length);
+  eeprom_record_end();
+  return true;
+}
+
+/**
+ * Find the newest copy of a record. Returns the EEPROM address of its data,
+ * or -1 if there is none, and sets its layout version and length.
+ */
+int eeprom_record_find(uint8_t type, uint8_t id, uint8_t &version, uint16_t &length) {
+  eeprom_record r;
+  int k = record_key(type, id);
+  if (!store_ready || k < 0 || !store_index[k]) return -1;
+  eeprom_read_block((void*)&r, (void*)store_index[k], sizeof(r));
+  version = r.version;
+  length = r.length;
+  return store_index[k] + sizeof(r);
+}
+
+bool eeprom_store_is_ready() { return store_ready; }
+
+/**
+ * How many more records with length bytes of data there is room for,
+ * after what's kept back for reclaiming.
+ */
+uint16_t eeprom_store_room(uint16_t length) {
+  uint16_t size = sizeof(eeprom_record) + length,
+           kept = store_live + 3 * max(store_largest, size);
+  return kept < EEPROM_STORE_SIZE ? (EEPROM_STORE_SIZE - kept) / size : 0;
+}
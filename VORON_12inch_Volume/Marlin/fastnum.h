@@ -0,0 +1,77 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef FASTNUM_H
+#define FASTNUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Number conversion for G-code arguments.
+ *
+ * G-code numbers are plain decimals: an optional sign, digits and an optional
+ * fraction. parse_float() reads those with 32-bit integer arithmetic and a
+ * single correctly rounded scaling step, giving the same float as strtod() for
+ * up to 9 significant digits without strtod's exponent, hex, inf/nan and locale
+ * code. Longer numbers may be a unit in the last place out, and fractions
+ * below 10^-9 read as 0.
+ * test/fastnum_test.cpp checks this against the C library.
+ */
+
+// mantissa / 10^decimals, correctly rounded. decimals must be 9 or less.
+float decimal_to_float(uint32_t mantissa, uint8_t decimals);
+
+// Parse a number after optional spaces. Sets *end past the last character used.
+float parse_float(const char* s, const char** end = NULL);
+
+/**
+ * Number formatting for serial reports and the LCD.
+ *
+ * format_ulong() and format_float() write into the caller's buffer in one
+ * pass with integer arithmetic and return the end of the string. A float
+ * needs at most 12 characters plus its decimals.
+ *
+ * The fixed-width ftostr / itostr helpers return the shared conv buffer.
+ */
+char* format_ulong(char* buf, unsigned long n);
+char* format_float(char* buf, float x, uint8_t decimals);
+
+extern char conv[8];
+
+char* itostr2(const uint8_t& x);
+char* itostr3sign(const int& x);
+char* itostr3(const int& x);
+char* itostr3left(const int& x);
+char* itostr4sign(const int& x);
+
+char* ftostr3(const float& x);
+char* ftostr4sign(const float& x);
+char* ftostr41sign(const float& x);
+char* ftostr32(const float& x);
+char* ftostr43sign(const float& x, char plus=' ');
+char* ftostr12ns(const float& x);
+char* ftostr5rj(const float& x);
+char* ftostr51sign(const float& x);
+char* ftostr52sign(const float& x);
+char* ftostr52sp(const float& x); // remove zero-padding from ftostr32
+
+#endif // FASTNUM_H
@@ -140,6 +140,9 @@
 #define MSG_BUSY_PAUSED_FOR_USER            "busy: paused for user"
 #define MSG_BUSY_PAUSED_FOR_INPUT           "busy: paused for input"
 #define MSG_RESEND                          "Resend: "
+#define MSG_BINARY_ACK                      "ack "
+#define MSG_BINARY_NAK                      "nak "
+#define MSG_ERR_BINARY_RECORD               "Bad binary G-code record, frame: "
 #define MSG_UNKNOWN_COMMAND                 "Unknown command: \""
 #define MSG_ACTIVE_EXTRUDER                 "Active Extruder: "
 #define MSG_X_MIN                           "x_min: "
@@ -153,6 +156,11 @@
 #define MSG_ERR_MATERIAL_INDEX              "M145 S<index> out of range (0-1)"
 #define MSG_ERR_M421_PARAMETERS             "M421 requires XYZ or IJZ parameters"
 #define MSG_ERR_MESH_XY                     "Mesh XY or IJ cannot be resolved"
+#define MSG_UBL_MESH_FRAME                  "ubl mesh "
+#define MSG_UBL_MESH_READY                  "ubl ready"
+#define MSG_UBL_MESH_LOADED                 "ubl mesh loaded"
+#define MSG_ERR_UBL_MESH_FRAME              "UBL Mesh frame not taken: "
+#define MSG_ERR_UBL_MESH_BINARY             "M422 S needs the text protocol"
 #define MSG_ERR_M428_TOO_FAR                "Too far from reference point"
 #define MSG_ERR_M303_DISABLED               "PIDTEMP disabled"
 #define MSG_M119_REPORT                     "Reporting endstop status"
@@ -179,6 +187,7 @@
 #define MSG_SD_NOT_PRINTING                 "Not SD printing"
 #define MSG_SD_ERR_WRITE_TO_FILE            "error writing to file"
 #define MSG_SD_ERR_READ                     "SD read error"
+#define MSG_SD_ERR_BINARY_RECORD            "Bad binary G-code record"
 #define MSG_SD_CANT_ENTER_SUBDIR            "Cannot enter subdir: "
 
 #define MSG_STEPPER_TOO_HIGH                "Steprate too high: "
@@ -221,6 +230,18 @@
 #define MSG_PID_DEBUG_ITERM                 " iTerm "
 #define MSG_PID_DEBUG_DTERM                 " dTerm "
 #define MSG_PID_DEBUG_CTERM                 " cTerm "
+#define MSG_MPC_AUTOTUNE                    "MPC Autotune"
+#define MSG_MPC_AUTOTUNE_START              MSG_MPC_AUTOTUNE " start"
+#define MSG_MPC_AUTOTUNE_FAILED             MSG_MPC_AUTOTUNE " failed!"
+#define MSG_MPC_TEMP_TOO_HIGH               MSG_MPC_AUTOTUNE_FAILED " Temperature too high"
+#define MSG_MPC_TIMEOUT                     MSG_MPC_AUTOTUNE_FAILED " timeout"
+#define MSG_MPC_COOLING_TO_AMBIENT          "Cooling to ambient"
+#define MSG_MPC_HEATING                     "Heating at full power"
+#define MSG_MPC_MEASURING_AMBIENT           "Measuring ambient heat loss"
+#define MSG_MPC_AUTOTUNE_FINISHED           MSG_MPC_AUTOTUNE " finished! Save with M500 or put these constants into Configuration.h"
+#define MSG_MPC_DEBUG_BLOCK                 " Block "
+#define MSG_MPC_DEBUG_AMBIENT               " Ambient "
+#define MSG_MPC_DEBUG_POWER                 " Power "
 #define MSG_INVALID_EXTRUDER_NUM            " - Invalid extruder number !"
 
 #define MSG_HEATER_BED                      "bed"
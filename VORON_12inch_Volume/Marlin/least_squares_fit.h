@@ -0,0 +1,51 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+//
+// Least Squares Best Fit of a plane to the probed points.
+//
+// The fit keeps only the running sums of the 3x3 normal equations for z = A*x + B*y + D.  Each probe result
+// is folded in as it arrives with incremental_LSF(), and finish_incremental_LSF() solves the equations in
+// closed form.  Any number of points costs the same few bytes of RAM, and the answer is ready as soon as the
+// last point is in.
+//
+
+#ifndef LEAST_SQUARES_FIT_H
+#define LEAST_SQUARES_FIT_H
+
+#include "Marlin.h"
+
+#if ENABLED(UNIFIED_BED_LEVELING_FEATURE)
+
+struct linear_fit_data {
+	int n;
+	float x0, y0;				// The sums are taken relative to the first point to keep
+	float sx, sy, sz, sxx, syy, sxy, sxz, syz;	// the precision of the floats where it matters
+	float A, B, D;				// The result:  z = A*x + B*y + D
+};
+
+void incremental_LSF_reset( struct linear_fit_data * );
+void incremental_LSF( struct linear_fit_data *, float, float, float );
+int finish_incremental_LSF( struct linear_fit_data * );
+
+#endif  // UNIFIED_BED_LEVELING_FEATURE
+#endif  // LEAST_SQUARES_FIT_H
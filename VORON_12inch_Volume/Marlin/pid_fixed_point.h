@@ -0,0 +1,110 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * pid_fixed_point.h - integer math of the PID_FIXED_POINT heater loop
+ *
+ * Kept free of the rest of Marlin so test/pid_fixed_point_test.cpp can
+ * run it on the host. K1 (the derivative smoothing) comes from the
+ * configuration.
+ */
+
+#ifndef PID_FIXED_POINT_H
+#define PID_FIXED_POINT_H
+
+#include <stdint.h>
+
+#define PID_FP_SHIFT 8
+#define PID_FP_ONE ((int32_t)1 << (PID_FP_SHIFT))
+#define PID_FP_K1 ((int32_t)((K1) * PID_FP_ONE + 0.5))
+#define PID_FP_K2 (PID_FP_ONE - PID_FP_K1)
+#define PID_FP_TERM_MAX ((int32_t)1 << 29) // Largest product allowed before the shift
+
+/**
+ * Fixed-point PID state, one per heater.
+ * Temperatures and outputs are in 1/256 units (Q8).
+ * Kp and Kd are Q8. Ki and the integral term are Q16 so that small
+ * (PID_dT-scaled) Ki values keep their precision.
+ * The input limits keep every product within 32 bits.
+ */
+typedef struct {
+  int32_t Kp, Ki, Kd;
+  int32_t p_limit, i_limit, d_limit;
+  int32_t last_temp, iTerm, dTerm;
+} pid_fp_t;
+
+inline int32_t pid_fp_clamp(const int32_t v, const int32_t lo, const int32_t hi) { return v < lo ? lo : v > hi ? hi : v; }
+
+/**
+ * Convert the float gains (Ki and Kd already scaled by PID_dT)
+ * to fixed-point, and work out how large an input each gain can
+ * take before its product would overflow. Inputs past the limit
+ * would saturate the output anyway, so they're simply clamped.
+ */
+inline void pid_fp_set_gains(pid_fp_t &pid, const float &kp, const float &ki, const float &kd) {
+  pid.Kp = kp * PID_FP_ONE + 0.5;
+  pid.Ki = ki * (PID_FP_ONE * PID_FP_ONE) + 0.5;
+  pid.Kd = kd * PID_FP_ONE + 0.5;
+  pid.p_limit = PID_FP_TERM_MAX / (pid.Kp > 1 ? pid.Kp : 1);
+  pid.i_limit = PID_FP_TERM_MAX / (pid.Ki > 1 ? pid.Ki : 1);
+  pid.d_limit = PID_FP_TERM_MAX / (pid.Kd > 1 ? pid.Kd : 1);
+}
+
+/**
+ * Update the low-pass filtered derivative term from a new temperature (Q8)
+ * dTerm = K2 * Kd * (T - T_last) + K1 * dTerm
+ */
+inline int32_t pid_fp_derivative(pid_fp_t &pid, const int32_t temp) {
+  int32_t delta = pid_fp_clamp(temp - pid.last_temp, -pid.d_limit, pid.d_limit);
+  pid.last_temp = temp;
+  int32_t d = (pid.Kd * delta) >> (PID_FP_SHIFT);
+  pid.dTerm = (PID_FP_K1 * pid.dTerm + PID_FP_K2 * d) >> (PID_FP_SHIFT);
+  return pid.dTerm;
+}
+
+/**
+ * Combine the P, I and (already updated) D terms plus an extra
+ * feed-forward term into an output in Q8, limited to 0...max_output.
+ * The integral only advances when that doesn't push a saturated
+ * output further into saturation (anti-windup).
+ */
+inline int32_t pid_fp_output(pid_fp_t &pid, const int32_t error, const int32_t extra, const int32_t max_output, const int32_t integral_max) {
+  int32_t p = (pid.Kp * pid_fp_clamp(error, -pid.p_limit, pid.p_limit)) >> (PID_FP_SHIFT),
+          i = pid.iTerm + ((pid.Ki * pid_fp_clamp(error, -pid.i_limit, pid.i_limit)) >> (PID_FP_SHIFT));
+  i = pid_fp_clamp(i, 0, integral_max);
+
+  int32_t output = p + (i >> (PID_FP_SHIFT)) - pid.dTerm + extra;
+  if (output > max_output) {
+    if (error < 0) pid.iTerm = i;
+    output = max_output;
+  }
+  else if (output < 0) {
+    if (error > 0) pid.iTerm = i;
+    output = 0;
+  }
+  else
+    pid.iTerm = i;
+
+  return output;
+}
+
+#endif // PID_FIXED_POINT_H
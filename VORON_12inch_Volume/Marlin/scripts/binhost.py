@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""
+binhost.py - Stream G-code to the printer with the binary host protocol
+
+  binhost.py [-b BAUD] PORT input.gcode
+
+PORT is a serial port or a pseudo-terminal. Needs BINARY_HOST_PROTOCOL.
+
+The sender switches the printer over with M888 and then sends one frame per
+command:
+
+  0xA5, seq, len, body, crc
+
+body is the command encoded the way gcode2bin.py writes it to a file, without
+the record's length byte. crc is CRC-16/CCITT (0x1021, starting from 0xFFFF)
+of seq, len and body, little-endian. seq counts frames modulo 256 from 0.
+
+The printer answers "ack <seq> <limit>" once it has queued frame <seq>. <limit>
+is how many bytes (modulo 65536) may have been sent since M888 before waiting
+for the next ack. "nak <seq> <limit>" asks for everything from frame <seq>
+again, and so does silence while frames are unacknowledged. An empty frame
+ends binary mode.
+
+All other lines from the printer are printed as they arrive.
+"""
+
+import argparse
+import os
+import select
+import sys
+import time
+
+from gcode2bin import encode_command, split_commands
+
+SYNC = 0xA5
+RESEND_TIMEOUT = 2.0   # Seconds without an ack before resending
+MAX_IN_FLIGHT = 127    # Keep seq numbers unambiguous
+
+
+def crc16(data, crc=0xFFFF):
+  for byte in data:
+    crc ^= byte << 8
+    for _ in range(8):
+      crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+      crc &= 0xFFFF
+  return crc
+
+
+def frame(seq, body):
+  head = bytes([seq & 0xFF, len(body)]) + body
+  crc = crc16(head)
+  return bytes([SYNC]) + head + bytes([crc & 0xFF, crc >> 8])
+
+
+class Port(object):
+  """A serial port through pyserial if it's there, or a raw tty (like a pty)."""
+
+  def __init__(self, path, baud):
+    try:
+      import serial
+      self.serial = serial.Serial(path, baud, timeout=0)
+      self.fd = self.serial.fileno()
+    except ImportError:
+      import tty
+      self.serial = None
+      self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+      tty.setraw(self.fd)
+    self.pending = b""
+
+  def write(self, data):
+    while data:
+      data = data[os.write(self.fd, data):]
+
+  def lines(self, timeout):
+    """Return the complete lines received within timeout seconds."""
+    if select.select([self.fd], [], [], timeout)[0]:
+      self.pending += os.read(self.fd, 4096)
+    *lines, self.pending = self.pending.split(b"\n")
+    return [line.decode('ascii', 'replace').strip() for line in lines]
+
+
+class Sender(object):
+
+  def __init__(self, port, bodies):
+    self.port = port
+    self.bodies = bodies
+    self.base = 0        # First frame not acknowledged
+    self.next = 0        # Next frame to send
+    self.sent = 0        # Bytes sent since binary mode started
+    self.limit = 0       # Don't send past this many bytes
+    self.last_reply = time.time()
+
+  def index(self, seq):
+    """The frame number, at or after base - 1, that seq refers to."""
+    return self.base - 1 + ((seq - (self.base - 1)) & 0xFF)
+
+  def set_limit(self, limit):
+    """Unwrap a 16-bit byte count to the nearest value around sent."""
+    self.limit = self.sent + ((limit - self.sent + 0x8000) & 0xFFFF) - 0x8000
+
+  def reply(self, line):
+    words = line.split()
+    if len(words) != 3 or words[0] not in ('ack', 'nak'):
+      return False
+    i = self.index(int(words[1]))
+    if words[0] == 'ack' and i < self.next:
+      self.base = max(self.base, i + 1)
+    elif words[0] == 'nak' and self.base <= i <= self.next:
+      self.next = i
+    else:
+      return False
+    self.set_limit(int(words[2]))
+    self.last_reply = time.time()
+    return True
+
+  def poll(self, timeout):
+    for line in self.port.lines(timeout):
+      if line and not self.reply(line):
+        print(line)
+
+  def send_next(self):
+    data = frame(self.next, self.bodies[self.next])
+    if self.next - self.base >= MAX_IN_FLIGHT or self.sent + len(data) > self.limit:
+      return False
+    self.port.write(data)
+    self.sent += len(data)
+    self.next += 1
+    return True
+
+  def run(self):
+    while self.base < len(self.bodies):
+      while self.next < len(self.bodies) and self.send_next():
+        pass
+      self.poll(0.05)
+      if self.base < self.next and time.time() - self.last_reply > RESEND_TIMEOUT:
+        self.next = self.base
+        self.last_reply = time.time()
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+  parser.add_argument('-b', '--baud', type=int, default=250000)
+  parser.add_argument('port')
+  parser.add_argument('gcode')
+  args = parser.parse_args()
+
+  bodies = []
+  with open(args.gcode, 'r', errors='replace') as fin:
+    for line in fin:
+      bodies.extend(encode_command(c)[1:] for c in split_commands(line))
+  bodies.append(b"")  # Back to text
+
+  port = Port(args.port, args.baud)
+  port.write(b"M888\n")
+  sender = Sender(port, bodies)
+  ready = False
+  while not ready:
+    for line in port.lines(1.0):
+      if line == 'ok':
+        ready = True
+      elif not sender.reply(line):
+        print(line)
+
+  start = time.time()
+  sender.run()
+  sys.stderr.write("Sent %d commands in %.1fs\n" % (len(bodies) - 1, time.time() - start))
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+gcode2bin.py - Convert G-code to the binary format read by BINARY_GCODE
+
+  gcode2bin.py input.gcode OUTPUT.GCB     convert a file
+  gcode2bin.py -d OUTPUT.GCB              print a binary file back as text
+
+The file starts with the header b"MGCB\\x01" followed by one record per command.
+A record is a length byte (size of the rest of the record) followed by either:
+
+  0x00, text                 a command that has to stay text, like M117 or M23
+  kind, code, parameters     kind is 'G', 'M' or 'T', code a little-endian uint16
+
+Each parameter is a byte holding the letter (0-25 for A-Z) in its low 5 bits
+and the size of its value in bytes (0-4) in its top 3. A parameter with a value
+is followed by the number of decimals and a little-endian signed mantissa of
+that size, so X-12.5 is stored as 'X'|(1 << 5), 1, -125.
+
+Comments, line numbers and checksums are dropped. Lines are split at ':' and
+'#' the same way the firmware splits SD files.
+"""
+
+import re
+import struct
+import sys
+
+HEADER = b"MGCB\x01"
+MAX_CMD_SIZE = 96              # Must match MAX_CMD_SIZE in Marlin.h
+MAX_PARAMS_SIZE = MAX_CMD_SIZE - 8
+MAX_DECIMALS = 7
+
+# Commands whose arguments are strings, read by the firmware as text.
+# G29 takes Mesh names (G29 S"PEI"), and a binary G29 S or L without a
+# number is refused in case it lost one.
+TEXT_COMMANDS = {('M', n) for n in (0, 1, 23, 28, 29, 30, 32, 33, 117, 928)} | {('G', 29)}
+
+COMMAND_RE = re.compile(r"([GMT])\s*(\d+)(.*)$")
+PARAM_RE = re.compile(r"\s*([A-Z])\s*([-+]?(?:\d+\.?\d*|\.\d+))?")
+
+
+def split_commands(line):
+  """Strip a line down to its commands the way get_sdcard_commands() does."""
+  line = line.split(';', 1)[0]
+  for command in re.split(r"[:#]", line):
+    command = command.strip()
+    m = re.match(r"N[-0-9]\d*\s*", command)
+    if m:
+      command = command[m.end():]
+    command = command.split('*', 1)[0].rstrip()
+    if command:
+      yield command
+
+
+def encode_value(text):
+  """Return (decimals, mantissa) for a decimal string, or None if it won't fit."""
+  sign = -1 if text.startswith('-') else 1
+  text = text.lstrip('+-')
+  whole, _, frac = text.partition('.')
+  frac = frac.rstrip('0')
+  decimals = len(frac)
+  mantissa = int((whole or '0') + frac)
+  if decimals > MAX_DECIMALS:
+    mantissa = int(round(mantissa / 10 ** (decimals - MAX_DECIMALS)))
+    decimals = MAX_DECIMALS
+  while decimals and abs(mantissa) >= 2 ** 31:
+    mantissa = int(round(mantissa / 10.0))
+    decimals -= 1
+  if abs(mantissa) >= 2 ** 31:
+    return None
+  return decimals, sign * mantissa
+
+
+def encode_param(letter, value):
+  index = ord(letter) - ord('A')
+  if value is None:
+    return bytes([index])
+  encoded = encode_value(value)
+  if encoded is None:
+    return None
+  decimals, mantissa = encoded
+  for size in (1, 2, 3, 4):
+    if -(1 << (8 * size - 1)) <= mantissa < (1 << (8 * size - 1)):
+      break
+  return bytes([index | (size << 5), decimals]) + mantissa.to_bytes(size, 'little', signed=True)
+
+
+def encode_command(command):
+  """Return the record for one command."""
+  m = COMMAND_RE.match(command)
+  if m and (m.group(1), int(m.group(2))) not in TEXT_COMMANDS and int(m.group(2)) <= 0xFFFF and '"' not in command:
+    kind, code, rest = m.group(1), int(m.group(2)), m.group(3)
+    params, pos = b"", 0
+    while pos < len(rest):
+      p = PARAM_RE.match(rest, pos)
+      if not p or p.end() == pos:
+        break
+      param = encode_param(p.group(1), p.group(2))
+      if param is None:
+        break
+      params += param
+      pos = p.end()
+      if pos == len(rest.rstrip()):
+        pos = len(rest)
+    else:
+      if len(params) <= MAX_PARAMS_SIZE:
+        body = kind.encode() + struct.pack('<H', code) + params
+        return bytes([len(body)]) + body
+
+  text = command.encode('ascii', 'replace')
+  if len(text) > MAX_CMD_SIZE - 1:
+    sys.stderr.write("Truncating long command: %s\n" % command)
+    text = text[:MAX_CMD_SIZE - 1]
+  return bytes([len(text) + 1, 0]) + text
+
+
+def convert(src, dst):
+  with open(src, 'r', errors='replace') as fin, open(dst, 'wb') as fout:
+    fout.write(HEADER)
+    for line in fin:
+      for command in split_commands(line):
+        fout.write(encode_command(command))
+
+
+def decode_params(params):
+  out, pos = [], 0
+  while pos < len(params):
+    head = params[pos]
+    letter, size = chr(ord('A') + (head & 0x1F)), head >> 5
+    if not size:
+      out.append(letter)
+      pos += 1
+      continue
+    decimals = params[pos + 1]
+    mantissa = int.from_bytes(params[pos + 2:pos + 2 + size], 'little', signed=True)
+    text = str(abs(mantissa)).rjust(decimals + 1, '0')
+    if decimals:
+      text = text[:-decimals] + '.' + text[-decimals:]
+    out.append(letter + ('-' if mantissa < 0 else '') + text)
+    pos += size + 2
+  return out
+
+
+def decode(src):
+  with open(src, 'rb') as fin:
+    data = fin.read()
+  if not data.startswith(HEADER):
+    sys.exit("%s is not binary G-code" % src)
+  pos = len(HEADER)
+  while pos < len(data):
+    length = data[pos]
+    body = data[pos + 1:pos + 1 + length]
+    pos += 1 + length
+    if body[0] == 0:
+      print(body[1:].decode('ascii', 'replace'))
+    else:
+      code = struct.unpack('<H', body[1:3])[0]
+      print(' '.join(['%c%d' % (body[0], code)] + decode_params(body[3:])))
+
+
+if __name__ == '__main__':
+  if len(sys.argv) == 3 and sys.argv[1] == '-d':
+    decode(sys.argv[2])
+  elif len(sys.argv) == 3:
+    convert(sys.argv[1], sys.argv[2])
+  else:
+    sys.exit(__doc__)
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""
+ublmesh.py - Fetch the UBL Mesh from the printer or send one to it
+
+  ublmesh.py [-b BAUD] PORT get mesh.json
+  ublmesh.py [-b BAUD] PORT put mesh.json
+
+PORT is a serial port or a pseudo-terminal. Needs UBL_MESH_TRANSFER.
+
+"get" sends M422 and writes the Mesh and the UBL State it gets back to a JSON
+file. "put" sends M422 S, waits for "ubl ready" and then sends the JSON file's
+Mesh and State as one frame. The Mesh isn't saved on the printer: follow with
+G29 S<slot> or M500 for that.
+
+The frame is base64 of:
+
+  version, n_x, n_y, state size (one byte each)
+  the UBL State (see bed_leveling::ubl_state, packed, little-endian)
+  n_x * n_y floats, x by x
+  CRC-16/CCITT (0x1021, starting from 0xFFFF) of all the above, little-endian
+
+The State's Mesh size and extent must match the printer's.
+"""
+
+import argparse
+import base64
+import collections
+import json
+import struct
+import sys
+import time
+
+from binhost import Port, crc16
+
+FRAME_VERSION = 1
+
+# bed_leveling::ubl_state up to the fields UBL_MESH_BANK adds (an AVR int is 16 bits)
+STATE = struct.Struct('<?fhhhffffffff')
+STATE_FIELDS = ('active', 'z_offset', 'EEPROM_storage_slot', 'n_x', 'n_y',
+                'mesh_x_min', 'mesh_y_min', 'mesh_x_max', 'mesh_y_max',
+                'mesh_x_dist', 'mesh_y_dist',
+                'G29_Correction_Fade_Height', 'G29_Fade_Height_Multiplier')
+
+
+def decode_frame(text):
+  data = base64.b64decode(text)
+  if len(data) < 6 or crc16(data[:-2]) != struct.unpack('<H', data[-2:])[0]:
+    raise ValueError("bad CRC")
+  version, n_x, n_y, size = data[:4]
+  if version != FRAME_VERSION or len(data) != 4 + size + 4 * n_x * n_y + 2:
+    raise ValueError("unknown frame layout")
+  raw = data[4:4 + size]
+  state = dict(zip(STATE_FIELDS, STATE.unpack_from(raw)))
+  extra = raw[STATE.size:]
+  if extra:  # UBL_MESH_BANK
+    temps = struct.unpack('<%dh' % (len(extra) // 2), extra)
+    state['mesh_bed_temp'], state['mesh_bank_temp'] = temps[0], list(temps[1:])
+  z = struct.unpack_from('<%df' % (n_x * n_y), data, 4 + size)
+  return {'state': state, 'z': [list(z[x * n_y:(x + 1) * n_y]) for x in range(n_x)]}
+
+
+def encode_frame(mesh):
+  state, z = mesh['state'], mesh['z']
+  raw = STATE.pack(*(state[f] for f in STATE_FIELDS))
+  if 'mesh_bed_temp' in state:
+    temps = [state['mesh_bed_temp']] + state['mesh_bank_temp']
+    raw += struct.pack('<%dh' % len(temps), *temps)
+  n_x, n_y = len(z), len(z[0])
+  data = bytes([FRAME_VERSION, n_x, n_y, len(raw)]) + raw
+  data += struct.pack('<%df' % (n_x * n_y), *(v for row in z for v in row))
+  data += struct.pack('<H', crc16(data))
+  return base64.b64encode(data)
+
+
+class LinePort(Port):
+  """A Port read a line at a time. Lines that came in with an earlier one wait their turn."""
+
+  def __init__(self, path, baud):
+    Port.__init__(self, path, baud)
+    self.unread = collections.deque()
+
+  def line(self, timeout):
+    """Return the next line, or None if none came within timeout seconds."""
+    end = time.time() + timeout
+    while not self.unread:
+      left = end - time.time()
+      if left <= 0:
+        return None
+      self.unread.extend(self.lines(min(left, 0.1)))
+    return self.unread.popleft()
+
+
+def wait_for(port, want, timeout=10.0):
+  """Print the printer's lines until one starts with want, and return it."""
+  end = time.time() + timeout
+  while True:
+    line = port.line(end - time.time())
+    if line is None:
+      sys.exit("No \"%s\" from the printer" % want)
+    if line.startswith(want):
+      return line
+    if line.startswith('Error:'):
+      sys.exit(line)
+    if line and line != 'ok':
+      print(line)
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+  parser.add_argument('-b', '--baud', type=int, default=250000)
+  parser.add_argument('port')
+  parser.add_argument('action', choices=('get', 'put'))
+  parser.add_argument('json')
+  args = parser.parse_args()
+
+  port = LinePort(args.port, args.baud)
+  if args.action == 'get':
+    port.write(b"M422\n")
+    mesh = decode_frame(wait_for(port, 'ubl mesh ')[len('ubl mesh '):])
+    with open(args.json, 'w') as fout:
+      json.dump(mesh, fout, indent=1)
+  else:
+    with open(args.json) as fin:
+      frame = encode_frame(json.load(fin))
+    port.write(b"M422 S\n")
+    wait_for(port, 'ubl ready')
+    port.write(frame + b"\n")
+    wait_for(port, 'ubl mesh loaded')
+  wait_for(port, 'ok')
+
+
+if __name__ == '__main__':
+  main()
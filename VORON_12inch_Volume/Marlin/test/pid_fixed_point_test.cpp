@@ -0,0 +1,89 @@
+/**
+ * Host test of the PID_FIXED_POINT loop (pid_fixed_point.h)
+ *
+ * A simulated hotend is heated from 25C to a 200C step target twice: once
+ * by the float PID loop of Temperature::get_pid_output() (pid_float.h) and
+ * once by the fixed-point one, each with the default gains of Configuration.h. Halfway
+ * through the part fan comes on. The two temperature curves must stay
+ * close and both must settle on the target.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#define K1 0.95
+#include "../pid_float.h"
+#include "../pid_fixed_point.h"
+
+#define PID_MAX 225
+#define BANG_MAX 225
+#define PID_INTEGRAL_DRIVE_MAX PID_MAX
+#define PID_FUNCTIONAL_RANGE 10
+#define PID_dT ((16 * 12.0) / (16000000.0 / 64.0 / 256.0)) // OVERSAMPLENR 16, 16MHz
+
+static const float Kp = 23.00, Ki = 1.50 * PID_dT, Kd = 80.00 / PID_dT;
+
+// A heater block and a sensor lagging behind it. 40W at full power.
+struct hotend {
+  float block, sensor;
+  hotend() : block(25), sensor(25) {}
+  void step(float output, bool fan) {
+    float power = output / 255.0 * 40.0, loss = (block - 25) * (fan ? 0.12 : 0.06);
+    block += (power - loss) * PID_dT / 12.0;
+    sensor += (block - sensor) * 0.5 * PID_dT;
+  }
+};
+
+struct float_pid {
+  float iState, dState, dTerm, pTerm, iTerm;
+  bool reset;
+  float_pid() : iState(0), dState(25), dTerm(0), reset(true) {}
+  float output(float target, float temp) {
+    float error = target - temp;
+    pid_float_derivative(dTerm, dState, Kd, temp);
+    if (error > PID_FUNCTIONAL_RANGE) { reset = true; return BANG_MAX; }
+    if (error < -(PID_FUNCTIONAL_RANGE)) { reset = true; return 0; }
+    if (reset) { iState = 0; reset = false; }
+    return pid_float_output(iState, pTerm, iTerm, error, dTerm, 0, Kp, Ki, 0, PID_INTEGRAL_DRIVE_MAX / Ki, PID_MAX);
+  }
+};
+
+struct fixed_pid {
+  pid_fp_t pid;
+  bool reset;
+  fixed_pid() : reset(true) {
+    pid_fp_set_gains(pid, Kp, Ki, Kd);
+    pid.last_temp = 25 * PID_FP_ONE;
+    pid.iTerm = pid.dTerm = 0;
+  }
+  float output(float target, float temp) {
+    int32_t temp_fp = temp * PID_FP_ONE, error_fp = ((int32_t)target << PID_FP_SHIFT) - temp_fp;
+    pid_fp_derivative(pid, temp_fp);
+    if (error_fp > PID_FUNCTIONAL_RANGE * PID_FP_ONE) { reset = true; return BANG_MAX; }
+    if (error_fp < -PID_FUNCTIONAL_RANGE * PID_FP_ONE) { reset = true; return 0; }
+    if (reset) { pid.iTerm = 0; reset = false; }
+    return pid_fp_output(pid, error_fp, 0, (int32_t)PID_MAX << PID_FP_SHIFT, (int32_t)PID_INTEGRAL_DRIVE_MAX << (PID_FP_SHIFT * 2)) >> PID_FP_SHIFT;
+  }
+};
+
+int main() {
+  const float target = 200;
+  const int samples = 1200 / PID_dT, fan_on = samples / 2;
+  hotend a, b;
+  float_pid fp;
+  fixed_pid xp;
+  float worst = 0;
+
+  for (int n = 0; n < samples; n++) {
+    a.step(fp.output(target, a.sensor), n >= fan_on);
+    b.step(xp.output(target, b.sensor), n >= fan_on);
+    worst = fmax(worst, fabs(a.sensor - b.sensor));
+  }
+
+  printf("pid_fixed_point: largest difference %.3fC, settled at %.3fC (float) %.3fC (fixed)\n", worst, a.sensor, b.sensor);
+  if (worst > 0.5 || fabs(a.sensor - target) > 0.5 || fabs(b.sensor - target) > 0.5) {
+    printf("FAIL\n");
+    return 1;
+  }
+  return 0;
+}
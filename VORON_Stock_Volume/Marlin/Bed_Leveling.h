@@ -42,9 +42,34 @@ enum MBLStatus { MBL_STATUS_NONE = 0, MBL_STATUS_HAS_MESH_BIT = 0, MBL_STATUS_AC
 extern float last_specified_z;
 extern float fade_scaling_factor_for_current_height;
 extern float z_values[MESH_NUM_X_POINTS][MESH_NUM_Y_POINTS];
+#if ENABLED(SMART_PROBING)
+extern uint8_t z_samples[MESH_NUM_X_POINTS][MESH_NUM_Y_POINTS];	// How many samples each probed point took, 0 if not probed
+extern uint8_t z_spread[MESH_NUM_X_POINTS][MESH_NUM_Y_POINTS];	// and how far apart they were, in microns (255 = 0.255mm or more)
+#endif
 extern float mesh_index_to_X_location[MESH_NUM_X_POINTS+1];	// +1 just because of paranoia that we might end up on the
 extern float mesh_index_to_Y_location[MESH_NUM_Y_POINTS+1];	// the last Mesh Line and that is the start of a whole new cell
 
+#define UBL_STATE_VERSION 1	// Layout versions of the UBL State and Mesh records in the EEPROM
+#define UBL_MESH_VERSION  1
+#define UBL_MESH_FRAME_VERSION 1	// Layout of the M422 frame (the UBL State and the Mesh)
+
+#if ENABLED(UBL_SD_MESHES)
+  #define UBL_SD_MESH_MAGIC   0x4C55	// "UL" starts a Mesh file on the SD card
+  #define UBL_SD_MESH_VERSION 1
+
+struct ubl_sd_mesh_header {		// A Mesh file is this header followed by z_values[][]
+	uint16_t magic;
+	uint8_t  version;
+	uint8_t  n_x, n_y;		// Mesh size
+	int16_t  bed_temp;		// Bed temperature the Mesh was probed at.  0 if unknown.
+	uint32_t date;			// From the host (G29 S"name" U<date>).  0 if none was given.
+	uint8_t  probed_points;		// Mesh Points probed since the Mesh was last invalidated or loaded,
+	uint16_t samples;		// the probe samples they took
+	uint8_t  widest_spread;		// and the widest spread of one point's samples, in microns
+	uint16_t crc;			// Of the header up to here and z_values[][]
+};
+#endif
+
 class bed_leveling {
   public:
 	struct ubl_state {
@@ -65,13 +90,15 @@ class bed_leveling {
 								// is for the user.  The second one is the one that is actually used
 								// again and again and again during the correction calculations.
 
-		unsigned char padding[24];  	// This is just to allow room to add state variables without
-						// changing the location of data structures in the EEPROM.   
-						// This is for compatability with future versions to keep 
-						// people from having to regenerate thier mesh data.
-						//
-						// If you change the contents of this struct, please adjust
-						// the padding[] to keep the size the same!
+	#if ENABLED(UBL_MESH_BANK)
+		int16_t mesh_bed_temp = 0;			// Bed temperature the Mesh in memory was probed at.  0 if unknown.
+		int16_t mesh_bank_temp[UBL_MESH_BANK_SLOTS];	// Bed temperature each of the first EEPROM slots was probed at.
+	#endif
+						// The state is stored as a record of its own in the EEPROM.  New
+						// state variables go at the end of the struct.  A shorter record
+						// stored by older firmware leaves them at their default values.
+						// If the meaning of an existing variable changes, bump
+						// UBL_STATE_VERSION instead.
 	} state, pre_initialized;
 
 
@@ -85,8 +112,20 @@ class bed_leveling {
 
     void store_state();
     void load_state();
-    void store_mesh(int);
+    bool store_mesh(int);
     void load_mesh(int);
+    int mesh_address(int);
+  #if ENABLED(UBL_MESH_BANK)
+    bool load_mesh_for_temperature(int);
+    bool mesh_bank_hold = false;		// Set by G29 P1.  Keeps M140/M190 from swapping out the freshly probed
+						// Mesh until the bed target changes, G29 L/S, M501 or the print job
+						// timer next stops.
+  #endif
+  #if ENABLED(UBL_SD_MESHES)
+    bool store_mesh_sd(const char*, uint32_t);
+    bool load_mesh_sd(const char*);
+    void list_meshes_sd();
+  #endif
 
     int sanity_check();
 
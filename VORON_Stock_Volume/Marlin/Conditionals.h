@@ -533,6 +533,7 @@
    */
   #define HAS_PID_HEATING (ENABLED(PIDTEMP) || ENABLED(PIDTEMPBED))
   #define HAS_PID_FOR_BOTH (ENABLED(PIDTEMP) && ENABLED(PIDTEMPBED))
+  #define HAS_HEATER_WAIT (ENABLED(HEAT_IN_BACKGROUND) || ENABLED(BED_STABILITY_DETECTION))
 
   /**
    * SINGLENOZZLE needs to differentiate EXTRUDERS and HOTENDS
@@ -2,12 +2,13 @@
 
 #if ENABLED(UNIFIED_BED_LEVELING_FEATURE)
 //#include "vector_3.h"
-//#include "qr_solve.h"
 
 #include "Bed_Leveling.h"
 #include "configuration_store.h"
 #include "G29_Unified_Bed_Leveling.h"
+#include "least_squares_fit.h"
 #include "planner.h"
+#include "temperature.h"
 
 
 #include <avr/io.h>
@@ -94,6 +95,8 @@ extern long babysteps_done;
 		      the bed and use this feature to select the center of the area (or cell) you want to 
 		      invalidate.
 
+      J #   Just      Limit G29 P1 to the print area.  The number is the margin added around it.  See P1 below.
+
       K #   Kompare   Kompare current Mesh with stored Mesh # replacing current Mesh with the result.  This
                       command litterly performs a difference between two Mesh. 
 
@@ -102,6 +105,9 @@ extern long babysteps_done;
       L #   Load      Load Mesh from the specified location in the EEPROM.  Set this location as activated
                       for subsequent Load and Store operations.
 
+      L "name" Load   Load the Mesh saved under that name on the SD card (UBL_SD_MESHES).  The Mesh is not
+      		      tied to an EEPROM slot afterwards.  G29 W lists the Meshes on the SD card.
+
       M     Map       Display the Mesh Map Topology.  A lower case 'm' can be used to get around a problem with
                       Repetier Host thinking 'M' is the start of a new command.   Also an 'O' can be used to 
 		      flag that the Mesh Map should be displayed.  From a G29 perspective they are all the same.
@@ -137,6 +143,14 @@ each additional Phase that processes it.
 		      only done between probe points.  You will need to press and hold the switch until the
 		      Phase 1 command can detect it.)
 
+		      With the J (Just the print area) parameter Phase 1 only probes the Mesh Points under the
+		      print instead:  G29 P1 J [margin].  The print area comes from the comments at the top of
+		      the G-Code file selected on the SD Card (UBL_PRINT_AREA_FROM_GCODE), or it is the X and Y
+		      location when they are given.  The margin (UBL_REGION_MARGIN if not specified) is added
+		      on every side and the whole Mesh cells the area touches are probed.  The rest of the Mesh
+		      keeps its shape and is moved by the average change of the points that were probed.  This
+		      is a quick way to get an old Mesh ready for the next print.
+
       P2    Phase 2   Probe areas of the Mesh that can not be automatically handled.  Phase 2 respects an H
       		      parameter to control the height between Mesh points.  The default height for movement
 		      between Mesh points is 5mm.  A smaller number can be used to make this part of the 
@@ -171,12 +185,18 @@ each additional Phase that processes it.
 		      Phase 2 allows the M (Map) parameter to be specified.  This helps the user see the progression
 		      of the Mesh being built.
 
-      P3    Phase 3   Fill the unpopulated regions of the Mesh with a fixed value.  The C parameter is used to
-      		      specify the Constant value to fill all invalid areas of the Mesh.  If no C parameter is 
-		      specified, a value of 0.0 is assumed.  The R parameter can be given to specify the number 
-		      of points to set.  If the R parameter is specified the current nozzle position is used to 
-		      find the closest points to alter unless the X and Y parameter are used to specify the fill 
-		      location.
+      P3    Phase 3   Fill the unpopulated regions of the Mesh.  With no C or R parameter, each invalid point
+		      is extrapolated from the valid points around it:  A straight line is fitted through the
+		      nearest valid points of its row and of its column on each side, and the estimates are
+		      averaged.  Points that have nothing valid in their row or column (the corners of an
+		      area the probe can't reach) are then filled from the points just filled.  The whole
+		      Mesh is done in one go.
+
+		      The C parameter is used to specify a Constant value to fill all invalid areas of the
+		      Mesh with instead.  If C is given without a value, 0.0 is assumed.  The R parameter can
+		      be given to specify the number of points to set to the constant.  If the R parameter is
+		      specified the current nozzle position is used to find the closest points to alter unless
+		      the X and Y parameter are used to specify the fill location.
 
       P4    Phase 4   Fine tune the Mesh.  The Delta Mesh Compensation System assume the existance of
                       an LCD Panel.  It is possible to fine tune the mesh without the use of an LCD Panel.  
@@ -222,9 +242,23 @@ each additional Phase that processes it.
       S     Store     Store the current Mesh in the Activated area of the EEPROM.
 
       S #   Store     Store the current Mesh at the specified location in EEPROM.  Activate this location
-                      for subsequent Load and Store operations.
+                      for subsequent Load and Store operations.   With UBL_MESH_BANK the bed temperature
+                      the Mesh was probed at is saved with it for the first UBL_MESH_BANK_SLOTS slots.
+                      M140 and M190 then load (or blend) the Meshes nearest to the new bed temperature, as
+		      long as no moves are queued and G29 P1 hasn't probed since the print job timer last stopped.
+
+      S "name" Store  Save the current Mesh under that name on the SD card (UBL_SD_MESHES).  Names are up
+      		      to 8 letters, digits, - or _ and there can be as many as the card holds, one for each
+		      bed plate or sheet.  The bed temperature the Mesh was probed at and the probe statistics
+		      are kept with it.  A U parameter adds a date from the host:  G29 S"PEI" U20261018
+		      A binary G-code record can't carry a name, so gcode2bin.py leaves G29 as text.
 
-      T     3-Point   Perform a 3 Point Bed Leveling on the current Mesh
+      T #   Tilt      Probe the bed and tilt the current Mesh to match it.  T by itself probes the 3 UBL_PROBE_PT's.
+		      T n probes an n x n grid across the area they span and fits a plane to all of the points
+		      (Least Squares).  The more points, the less a single bad probe can throw the tilt off.
+		      With P1, P2 or P4 the tilt is done after that job has finished.
+
+      U #   Date      The date (any number the host likes, e.g. YYYYMMDD) kept with a Mesh saved by S "name".
 
       W     What?     Display valuable data the Unified Bed Leveling System knows.
 
@@ -264,16 +298,17 @@ each additional Phase that processes it.
 			The Unified Bed Leveling uses a lot of EEPROM storage to hold its data.  And it takes some effort
 			to get this Mesh data correct for a user's printer.  We do not want this data destroyed as
 			new versions of Marlin add or subtract to the items stored in EEPROM.   So, for the benefit of
-			the users, we store the Mesh data at the end of the EEPROM and do not keep it contiguous with the
-			other data stored in the EEPROM.  (For sure the developers are going to complain about this, but
-			this is going to be helpful to the users!)
+			the users, each Mesh and the UBL State are kept in the EEPROM as records of their own, separate
+			from the other settings.  A change to the settings (or to the size of the other records) does not
+			disturb them.  Storing a Mesh appends a new copy of it and the space used by old copies is
+			reclaimed as needed, so the wear is spread over the whole EEPROM.  How many Mesh slots are
+			available depends on how big the Mesh is.  G29 W reports how many more will fit.
 
 			The foundation of this Bed Leveling System is built on Epatel's Mesh Bed Leveling code.  A big 
 			'Thanks!' to him and the creators of 3-Point and Grid Based leveling.   Combining thier contributions
 			we now have the functionality and features of all three systems combined.
 */
 
-int Unified_Bed_Leveling_EEPROM_start = -1;
 int UBL_has_control_of_LCD_Panel = 0;
 volatile int G29_encoderDiff = 0;	// This is volatile because it is getting changed at interrupt time.
 
@@ -290,17 +325,157 @@ static int Statistics_Flag = 0, Storage_Slot = 0, Business_Card_Mode = 0, Test_P
 void lcd_setstatus(const char* message, bool persist);
 #endif
 
+// G26 and the long G29 phases (P1, P2 and P4) are UBL jobs.  The command starts the job and each call to
+// ubl_job_step() does one small piece of it: probe one point, check the Encoder Wheel once, queue one
+// G26 circle.  With UBL_BACKGROUND_JOBS the main loop calls ubl_job_step() and keeps taking reports and
+// job control commands from the queue in between.  Without it the command calls ubl_job_step() until
+// the job is done, just like it always did.
+
+struct ubl_job_status ubl_job = { NO_UBL_JOB };
+
+void ubl_job_start( UBL_Job_Type type, int points_total ) {
+	ubl_job.type = type;
+	ubl_job.state = 0;
+	ubl_job.paused = false;
+	ubl_job.abort = false;
+	ubl_job.points_done = 0;
+	ubl_job.points_total = points_total;
+	ubl_job.started = millis();
+}
+
+// Print one line of progress:   echo:UBL G29 P1 12/49 ETA:95
+// The ETA (in seconds) assumes the rest of the points take as long as the ones done so far.
+
+void ubl_job_report() {
+unsigned long elapsed;
+
+	SERIAL_ECHO_START;
+	SERIAL_ECHOPGM("UBL ");
+	switch ( ubl_job.type ) {
+	  case G26_JOB:			SERIAL_ECHOPGM("G26");		break;
+	  case G29_PROBE_JOB:		SERIAL_ECHOPGM("G29 P1");	break;
+	  case G29_MANUAL_PROBE_JOB:	SERIAL_ECHOPGM("G29 P2");	break;
+	  case G29_FINE_TUNE_JOB:	SERIAL_ECHOPGM("G29 P4");	break;
+	  default:			SERIAL_ECHOLNPGM("idle");	return;
+	}
+	SERIAL_ECHOPAIR(" ", ubl_job.points_done);
+	SERIAL_ECHOPAIR("/", ubl_job.points_total);
+	if ( ubl_job.abort ) 
+		SERIAL_ECHOPGM(" stopped");
+	else if ( ubl_job.paused ) 
+		SERIAL_ECHOPGM(" paused");
+	else if ( ubl_job.points_done > 0 && ubl_job.points_done < ubl_job.points_total ) {
+		elapsed = millis() - ubl_job.started;
+		SERIAL_ECHOPAIR(" ETA:", elapsed / ubl_job.points_done * (ubl_job.points_total - ubl_job.points_done) / 1000UL);
+	}
+	SERIAL_EOL;
+}
+
+void ubl_job_point_done() {
+	ubl_job.points_done++;
+	ubl_job_report();
+}
+
+// M423 P pauses the job between steps and M423 R lets it continue.   The time spent paused doesn't count
+// towards the ETA.
+
+void ubl_job_pause( bool pause ) {
+	if ( ubl_job.type == NO_UBL_JOB )
+		return;
+	if ( pause != ubl_job.paused ) {
+		ubl_job.paused = pause;
+		if ( pause ) 
+			ubl_job.paused_at = millis();
+		else
+			ubl_job.started += millis() - ubl_job.paused_at;
+	}
+	ubl_job_report();
+}
+
+// Do the next piece of the current job.  Returns false once there is no job running.
+
+bool ubl_job_step() {
+bool running = false;
+UBL_Job_Type type = ubl_job.type;
+
+	if ( type == NO_UBL_JOB ) 
+		return false;
+	if ( ubl_job.paused && !ubl_job.abort ) 
+		return true;
+
+	switch ( type ) {
+	  case G26_JOB:			running = G26_job_step();			break;
+	  case G29_PROBE_JOB:		running = probe_entire_mesh_step();		break;
+	  case G29_MANUAL_PROBE_JOB:	running = manually_probe_remaining_mesh_step();	break;
+	  case G29_FINE_TUNE_JOB:	running = fine_tune_mesh_step();		break;
+	  default:								break;
+	}
+	if ( running ) 
+		return true;
+
+	ubl_job_report();
+	ubl_job.type = NO_UBL_JOB;
+#if ENABLED(UBL_BACKGROUND_JOBS)
+	if ( type != G26_JOB ) {		// Now do the rest of the G29 command that started the job
+		restore_command_args();
+		G29_finish();
+	}
+#endif
+	return false;
+}
+
+// How many Mesh Points are still INVALID.   Only the ones the probe can reach are counted if
+// probe_as_reference is set.
+
+int count_invalid_mesh_points( bool probe_as_reference ) {
+int i, j, n = 0;
+float mx, my;
+
+	for(i=0; i<MESH_NUM_X_POINTS; i++) {
+		for(j=0; j<MESH_NUM_Y_POINTS; j++) {
+			if ( !isnan(z_values[i][j]) ) 
+				continue;
+			mx = blm.map_x_index_to_bed_location(i);
+			my = blm.map_y_index_to_bed_location(j);
+			if ( probe_as_reference && (mx<MIN_PROBE_X || mx>MAX_PROBE_X || my<MIN_PROBE_Y || my>MAX_PROBE_Y) ) 
+				continue;
+			n++;
+		}
+	}
+	return n;
+}
+
+// Where the current job fills in the Mesh from, and where it parks the nozzle at the end
+static float job_x, job_y, job_last_x, job_last_y, job_z_clearance, job_card_thickness, job_new_z;
+static bool job_mesh_map;
+static struct mesh_index_pair job_location;
+static unsigned long job_click_ms;
+
+// G29 P1 J only probes the Mesh Points in job_region.  The ones it has probed are moved over to job_region_done,
+// and job_region_shift collects how far they moved so the rest of the Mesh can follow.
+static bool job_region_active;
+#if ENABLED(SMART_PROBING)
+static int job_outliers;			// Probe samples dropped during this G29 P1
+#endif
+static unsigned int job_region[16], job_region_done[16];
+static float job_region_shift;
+static int job_region_shift_cnt, job_region_points;
+
+#if ENABLED(UBL_PRINT_AREA_FROM_GCODE)
+  struct print_area print_footprint = { false, 0.0, 0.0, 0.0, 0.0 };
+#endif
+
 void gcode_G29() {
   struct mesh_index_pair location;
-  int i, j, k;
-  float Z1, Z2, Z3;
+  int i, j;
+  float Z1, Z2;
  
   G29_Verbose_Level = 0;	// These may change, but let's get some reasonable values into them.
   Repeat_Flag       = 0;
   Repetition_Cnt    = 1;
   C_Flag            = 0;
 
-  if ( Unified_Bed_Leveling_EEPROM_start < 0 ) {
+  if ( !eeprom_store_is_ready() ) {
     SERIAL_PROTOCOLLNPGM("?You need to enable your EEPROM and initialize it ");
     SERIAL_PROTOCOLLNPGM("with M502, M500, M501 in that order.\n");
     return;
@@ -387,7 +562,12 @@ void gcode_G29() {
 //
 // Invalidate Entire Mesh and Automatically Probe Mesh in areas that can be reached by the probe
 //
-      case 1:	if ( !code_seen('C') )  {
+      case 1:	job_region_active = false;
+		if ( code_seen('J') ) {				// Just the Mesh Points under the print
+			if ( !select_probe_region( code_has_value() ? code_value_float() : UBL_REGION_MARGIN ) )
+				return;
+		}
+		else if ( !code_seen('C') )  {
 			blm.invalidate();
 			SERIAL_PROTOCOLLNPGM("Mesh invalidated.  Probing mesh.\n");
 		}
@@ -397,6 +577,10 @@ void gcode_G29() {
         		SERIAL_PROTOCOLLNPGM(")\n");
 		}
 		probe_entire_mesh( X_Pos+X_PROBE_OFFSET_FROM_EXTRUDER, Y_Pos+Y_PROBE_OFFSET_FROM_EXTRUDER, code_seen('M') );
+#if ENABLED(UBL_MESH_BANK)
+		blm.state.mesh_bed_temp = thermalManager.degTargetBed() ? thermalManager.degTargetBed() : thermalManager.degBed() + 0.5;
+		blm.mesh_bank_hold = true;
+#endif
         	break;
 //
 // Manually Probe Mesh in areas that can not be reached by the probe
@@ -439,7 +623,11 @@ void gcode_G29() {
 //
 // Populate invalid Mesh areas with a constant
 //
-      case 3:   Height_Value = 0.0;	// Assume 0.0 until proven otherwise
+      case 3:   if ( !C_Flag && !Repeat_Flag ) {	// Without a C or R, extrapolate from the
+			Smart_Fill_Mesh();		// valid points instead of using a constant
+			break;
+		}
+		Height_Value = 0.0;	// Assume 0.0 until proven otherwise
 		if (code_seen('C')) {
 			Height_Value = Constant;
 		}
@@ -480,21 +668,39 @@ void gcode_G29() {
     }
   }
 
-  if ( code_seen('T') ) {
-     float xxx,yyy,zzz;
-	Z1 = probe_pt( UBL_PROBE_PT_1_X, UBL_PROBE_PT_1_Y, false /*Stow Flag*/, G29_Verbose_Level)+zprobe_zoffset;
-	Z2 = probe_pt( UBL_PROBE_PT_2_X, UBL_PROBE_PT_2_Y, false /*Stow Flag*/, G29_Verbose_Level)+zprobe_zoffset;
-	Z3 = probe_pt( UBL_PROBE_PT_3_X, UBL_PROBE_PT_3_Y, true  /*Stow Flag*/, G29_Verbose_Level)+zprobe_zoffset;
+//
+// P1, P2 and P4 keep going as a UBL job after we get here.   The rest of the command has to wait
+// until the job is done, because it will usually want to save or look at the new Mesh.
+//
+  if ( ubl_job.type != NO_UBL_JOB ) {
+#if ENABLED(UBL_BACKGROUND_JOBS)
+	save_command_args();		// ubl_job_step() calls G29_finish() with these
+	return;
+#else
+	while ( ubl_job_step() )
+		idle();
+#endif
+  }
 
-//  We need to adjust Z1, Z2, Z3 by the Mesh Height at these points.  Just because they are non-zero doesn't mean
-//  the Mesh is tilted!  (We need to compensate each probe point by what the Mesh says that location's height is)
+  G29_finish();
+}
 
-	Z1 -= blm.get_z_correction( UBL_PROBE_PT_1_X, UBL_PROBE_PT_1_Y);
-	Z2 -= blm.get_z_correction( UBL_PROBE_PT_2_X, UBL_PROBE_PT_2_Y);
-	Z3 -= blm.get_z_correction( UBL_PROBE_PT_3_X, UBL_PROBE_PT_3_Y);
+// The part of G29 that runs after the Mesh has been probed or edited
 
-	do_blocking_move_to_xy( (X_MAX_POS-X_MIN_POS)/2.0, (Y_MAX_POS-Y_MIN_POS)/2.0);
-	tilt_mesh_based_on_3pts( Z1, Z2, Z3 );
+void G29_finish() {
+  int i, j, k;
+#if ENABLED(UBL_SD_MESHES)
+  char *name;
+#endif
+
+//
+// T tilts the Mesh the P1, P2 or P4 job just made, so it waits for the job like the rest of these
+//
+  if ( code_seen('T') ) {
+#if HAS_HEATER_WAIT
+	wait_for_bed_before_probing();
+#endif
+	tilt_mesh_based_on_probed_grid( code_has_value() ? code_value_int() : 0 );
   }
 
 //
@@ -527,19 +733,36 @@ void gcode_G29() {
 //
 
   if ( code_seen('L') ) {			// Load Current Mesh Data
+#if ENABLED(UBL_SD_MESHES)
+    if ( code_is_binary() && !code_has_value() ) {	// A binary record can't carry a name, so it might
+    							// have lost one.  Don't guess at a slot.
+      SERIAL_PROTOCOLLNPGM("?Binary G29 L needs a slot number.  Send G29 as text for a Mesh name.\n");
+      goto LEAVE;
+    }
+    if ( (name = code_string()) != NULL ) {	// A named Mesh from the SD card
+      if ( blm.load_mesh_sd( name ) ) {
+#if ENABLED(UBL_MESH_BANK)
+        blm.mesh_bank_hold = false;		// This Mesh replaces the one G29 P1 probed
+#endif
+        SERIAL_PROTOCOLLNPGM("Done.\n");
+      }
+      goto LEAVE;
+    }
+#endif
     Storage_Slot = blm.state.EEPROM_storage_slot;
     if ( code_has_value() )
       Storage_Slot = code_value_int();
 
-    k = E2END - sizeof( blm.state );
-    j = (k - Unified_Bed_Leveling_EEPROM_start) / sizeof( z_values );
-
-    if ( Storage_Slot < 0 || Storage_Slot >= j || Unified_Bed_Leveling_EEPROM_start <= 0) {
-      SERIAL_PROTOCOLLNPGM("?EEPROM storage not available for use.\n");
+    if ( blm.mesh_address( Storage_Slot ) < 0 ) {
+      SERIAL_PROTOCOLLNPGM("?No Mesh stored in that slot.\n");
       return;
     }
     blm.load_mesh( Storage_Slot );
     blm.state.EEPROM_storage_slot = Storage_Slot;
+#if ENABLED(UBL_MESH_BANK)
+    blm.state.mesh_bed_temp = Storage_Slot < UBL_MESH_BANK_SLOTS ? blm.state.mesh_bank_temp[Storage_Slot] : 0;
+    blm.mesh_bank_hold = false;		// This Mesh replaces the one G29 P1 probed
+#endif
     if ( Storage_Slot != blm.state.EEPROM_storage_slot)
     	blm.store_state();
     SERIAL_PROTOCOLLNPGM("Done.\n");
@@ -550,22 +773,37 @@ void gcode_G29() {
 //
 
   if ( code_seen('S') ) {			// Store (or Save) Current Mesh Data
+#if ENABLED(UBL_SD_MESHES)
+    if ( code_is_binary() && !code_has_value() ) {	// A binary record can't carry a name, so it might
+    							// have lost one.  Don't guess at a slot.
+      SERIAL_PROTOCOLLNPGM("?Binary G29 S needs a slot number.  Send G29 as text for a Mesh name.\n");
+      goto LEAVE;
+    }
+    if ( (name = code_string()) != NULL ) {	// Save it on the SD card under that name
+      if ( blm.store_mesh_sd( name, code_seen('U') ? code_value_ulong() : 0 ) )
+        SERIAL_PROTOCOLLNPGM("Done.\n");
+      goto LEAVE;
+    }
+#endif
     Storage_Slot = blm.state.EEPROM_storage_slot;
     if ( code_has_value() )
       Storage_Slot = code_value_int();
 
-    k = E2END - sizeof( blm.state );
-    j = (k - Unified_Bed_Leveling_EEPROM_start) / sizeof( z_values );
-
-    if ( Storage_Slot < 0 || Storage_Slot >= j || Unified_Bed_Leveling_EEPROM_start <= 0) {
+    if ( Storage_Slot < 0 || Storage_Slot >= EEPROM_MESH_SLOTS ) {
       SERIAL_PROTOCOLLNPGM("?EEPROM storage not available for use.\n");
       SERIAL_PROTOCOLPGM("?Use 0 to ");
-      SERIAL_PROTOCOL(j-1);
+      SERIAL_PROTOCOL(EEPROM_MESH_SLOTS-1);
       SERIAL_PROTOCOLPGM("\n");
       goto LEAVE;
     }
-    blm.store_mesh( Storage_Slot );
+    if ( !blm.store_mesh( Storage_Slot ) )		// The EEPROM is full
+      goto LEAVE;
     blm.state.EEPROM_storage_slot = Storage_Slot;
+#if ENABLED(UBL_MESH_BANK)
+    if ( Storage_Slot < UBL_MESH_BANK_SLOTS )		// Remember the bed temperature the Mesh was probed at so
+    	blm.state.mesh_bank_temp[Storage_Slot] = blm.state.mesh_bed_temp;	// M140 and M190 can pick it
+    blm.mesh_bank_hold = false;			// It's in the bank now
+#endif
 //
 //  if ( Storage_Slot != blm.state.EEPROM_storage_slot)
     blm.store_state();		// Always save an updated copy of the UBL State info
@@ -703,117 +941,367 @@ int i, j;
 	}
 }
 
+// smart_fill_estimate() extrapolates a height for Mesh Point (i,j).  In each of the four directions out of the
+// point, a straight line is fitted (least squares) through the nearest SMART_FILL_POINTS valid points of that row
+// or column and evaluated back at the point.  The estimates are averaged, each weighted by how close its nearest
+// sample is.  Points set in 'filled' were only estimated themselves and are skipped unless use_filled is set.
+
+#define SMART_FILL_POINTS 3
+
+static bool smart_fill_estimate( int i, int j, unsigned int filled[16], bool use_filled, float &z )  {
+static const int8_t dir[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+int d, k, n, x, y;
+float t, st, sz, stt, stz, slope, weight, sum, sum_of_weights;
+
+	sum = 0.0;
+	sum_of_weights = 0.0;
+	for (d = 0; d < 4; d++) {
+		n = 0;
+		st = sz = stt = stz = 0.0;
+		weight = 0.0;
+		x = i;
+		y = j;
+		for (k = 1; n < SMART_FILL_POINTS; k++) {
+			x += dir[d][0];
+			y += dir[d][1];
+			if ( x < 0 || y < 0 || x >= MESH_NUM_X_POINTS || y >= MESH_NUM_Y_POINTS )
+				break;
+			if ( isnan( z_values[x][y] ) || ( !use_filled && is_bit_set( filled, x, y ) ) )
+				continue;
+			if ( n == 0 )
+				weight = 1.0 / k;		// The closer the data, the more it counts
+			t = k;
+			st  += t;
+			sz  += z_values[x][y];
+			stt += t * t;
+			stz += t * z_values[x][y];
+			n++;
+		}
+		if ( n == 0 )
+			continue;
+		slope = ( n == 1 ) ? 0.0 : ( n * stz - st * sz ) / ( n * stt - st * st );	// A lone point is carried over as is
+		sum += weight * ( sz - slope * st ) / n;	// The fitted line's height at the point itself
+		sum_of_weights += weight;
+	}
+	if ( sum_of_weights == 0.0 )
+		return false;
+	z = sum / sum_of_weights;
+	return true;
+}
+
+// Smart_Fill_Mesh() fills all invalid Mesh Points in one sweep over the Mesh.  Only measured points are used for
+// the estimates, so the order of the sweep doesn't matter.  A second sweep picks up the points that have no
+// measured point in their row or column, using the ones filled by the first.
+
+void Smart_Fill_Mesh()  {
+unsigned int filled[16];
+int i, j, pass, n_filled = 0, n_left = 0;
+float z;
+
+	for (i = 0; i < 16; i++)
+		filled[i] = 0;
+
+	for (pass = 0; pass < 2; pass++) {
+		for (i = 0; i < MESH_NUM_X_POINTS; i++) {
+			for (j = 0;  j < MESH_NUM_Y_POINTS; j++) {
+				if ( isnan( z_values[i][j] ) && smart_fill_estimate( i, j, filled, pass, z ) ) {
+					z_values[i][j] = z;
+					bit_set( filled, i, j );
+					n_filled++;
+				}
+			}
+		}
+	}
+
+	for (i = 0; i < MESH_NUM_X_POINTS; i++)
+		for (j = 0;  j < MESH_NUM_Y_POINTS; j++)
+			if ( isnan( z_values[i][j] ) )
+				n_left++;
+
+	SERIAL_ECHOPAIR("Mesh Points filled: ", n_filled );
+	SERIAL_EOL;
+	if ( n_left ) {
+		SERIAL_ECHOPAIR("Mesh Points left invalid: ", n_left );
+		SERIAL_EOL;
+	}
+}
+
 
 // probe_entire_mesh( X_Pos, Y_Pos )  probes all invalidated locations of the mesh that can be reached
-// by the probe.  It attempts to fill in locations closest to the nozzle's start location first.
+// by the probe.  It attempts to fill in locations closest to the nozzle's start location first.  It only
+// starts the job.  probe_entire_mesh_step() probes one point each time it is called.
 
 void probe_entire_mesh( float X_Pos, float Y_Pos, bool do_mesh_map )  {
-struct mesh_index_pair location;
-float xProbe, yProbe, measured_z;
+	job_x = X_Pos;
+	job_y = Y_Pos;
+	job_mesh_map = do_mesh_map;
+	ubl_job_start( G29_PROBE_JOB, job_region_active ? job_region_points : count_invalid_mesh_points( true ) );
+#if ENABLED(SMART_PROBING)
+	job_outliers = 0;
+#endif
+}
 
-    UBL_has_control_of_LCD_Panel++;
-    save_UBL_active_state_and_disable();	 // we don't do bed level correction because we want the raw data when we probe
-    DEPLOY_PROBE();
+#if ENABLED(SMART_PROBING)
 
-    do {
-	if ( G29_lcd_clicked() ) {
-    		SERIAL_PROTOCOLLNPGM("\nMesh only partially populated.");
-		lcd_quick_feedback();
-		while ( G29_lcd_clicked() )
-		       idle();	
-    		UBL_has_control_of_LCD_Panel = 0;
-		STOW_PROBE();
-		restore_UBL_active_state_and_leave();
+// report_probe_statistics() sums up how hard the probe had to work for the Mesh Points probed since the Mesh
+// was last invalidated or loaded.  A point with a large spread is one to look at with G26 and fix with P4.
+
+void report_probe_statistics()  {
+int i, j, n = 0, samples = 0, worst_i = -1, worst_j = -1;
+
+	for (i = 0; i < MESH_NUM_X_POINTS; i++) {
+		for (j = 0;  j < MESH_NUM_Y_POINTS; j++) {
+			if ( z_samples[i][j] == 0 )
+				continue;
+			n++;
+			samples += z_samples[i][j];
+			if ( worst_i < 0 || z_spread[i][j] > z_spread[worst_i][worst_j] ) {
+				worst_i = i;
+				worst_j = j;
+			}
+		}
+	}
+	if ( n == 0 )
 		return;
+
+	SERIAL_ECHOPAIR("Probe samples per Mesh Point: ", (float) samples / n );
+	SERIAL_ECHOPAIR("   Outliers dropped: ", job_outliers );
+	SERIAL_EOL;
+	SERIAL_ECHOPAIR("Widest spread: ", z_spread[worst_i][worst_j] / 1000.0 );
+	SERIAL_ECHOPAIR(" at [", worst_i );
+	SERIAL_ECHOPAIR(",", worst_j );
+	SERIAL_ECHOPAIR("] with ", z_samples[worst_i][worst_j] );
+	SERIAL_ECHO(" samples\n");
+}
+
+#endif
+
+// select_probe_region( margin ) picks the Mesh Points G29 P1 J probes:  Those of every Mesh cell that
+// overlaps the print area grown by margin on each side.  The print area is the X,Y location if one was given,
+// or what the G-Code file said about itself.  Only those points are probed again.  The rest of the Mesh keeps
+// its shape and just moves up or down with them (see finish_region_probing()).
+
+bool select_probe_region( float margin )  {
+float x_min, y_min, x_max, y_max, mx, my;
+int i, j, i_min, i_max, j_min, j_max;
+
+	if ( X_Flag ) {
+		x_min = x_max = X_Pos;
+		y_min = y_max = Y_Pos;
 	}
-	location = find_closest_mesh_point_of_type( INVALID, X_Pos,  Y_Pos, 1, NULL);  // the '1' says we want the location to be relative to the probe
-    	if (location.x_index>=0 && location.y_index>=0 ) {
-		xProbe = blm.map_x_index_to_bed_location(location.x_index); 
-		yProbe = blm.map_y_index_to_bed_location(location.y_index);
-		if ( xProbe<MIN_PROBE_X || xProbe>MAX_PROBE_X || yProbe<MIN_PROBE_Y || yProbe>MAX_PROBE_Y)  {
-    			SERIAL_PROTOCOLLNPGM("?Error: Attempt to probe off the bed.");
-    			UBL_has_control_of_LCD_Panel = 0;
-			goto LEAVE;
+#if ENABLED(UBL_PRINT_AREA_FROM_GCODE)
+	else if ( print_footprint.valid ) {
+		x_min = print_footprint.min_x;
+		y_min = print_footprint.min_y;
+		x_max = print_footprint.max_x;
+		y_max = print_footprint.max_y;
+	}
+#endif
+	else {
+		SERIAL_PROTOCOLLNPGM("?No print area known.  Specify it with G29 P1 X Y J.\n");
+		return false;
+	}
+
+	i_min = blm.get_cell_index_x( x_min - margin );
+	j_min = blm.get_cell_index_y( y_min - margin );
+	i_max = min( blm.get_cell_index_x( x_max + margin ) + 1, MESH_NUM_X_POINTS - 1 );
+	j_max = min( blm.get_cell_index_y( y_max + margin ) + 1, MESH_NUM_Y_POINTS - 1 );
+
+	job_region_points = 0;
+	for (j = 0; j < 16; j++) {
+		job_region[j] = 0;
+		job_region_done[j] = 0;
+	}
+	for (i = i_min; i <= i_max; i++) {
+		for (j = j_min; j <= j_max; j++) {
+			bit_set( job_region, i, j );
+			mx = blm.map_x_index_to_bed_location(i);
+			my = blm.map_y_index_to_bed_location(j);
+			if ( mx >= MIN_PROBE_X && mx <= MAX_PROBE_X && my >= MIN_PROBE_Y && my <= MAX_PROBE_Y )
+				job_region_points++;
 		}
-		measured_z = probe_pt(xProbe, yProbe, ProbeStay, G29_Verbose_Level);
-		z_values[location.x_index][location.y_index] = measured_z + Z_PROBE_OFFSET_FROM_EXTRUDER;
 	}
+	job_region_shift = 0.0;
+	job_region_shift_cnt = 0;
+	job_region_active = true;
+
+	SERIAL_ECHOPAIR("Probing ", job_region_points );
+	SERIAL_ECHOPAIR(" Mesh Points from [", i_min );
+	SERIAL_ECHOPAIR(",", j_min );
+	SERIAL_ECHOPAIR("] to [", i_max );
+	SERIAL_ECHOPAIR(",", j_max );
+	SERIAL_PROTOCOLLNPGM("]\n");
+	return true;
+}
 
-	if ( do_mesh_map )
-    		blm.display_map(1);
+// Once a G29 P1 J is done, every Mesh Point it did not probe is moved by the average change of the ones it
+// did.  That way the bed can have moved (heated up, been removed and put back) since the Mesh was made.
+
+static void finish_region_probing()  {
+float shift;
+int i, j;
+
+	if ( !job_region_active )
+		return;
+	job_region_active = false;
+	if ( job_region_shift_cnt == 0 )
+		return;
+
+	shift = job_region_shift / job_region_shift_cnt;
+	for (i = 0; i < MESH_NUM_X_POINTS; i++)
+		for (j = 0;  j < MESH_NUM_Y_POINTS; j++)
+			if ( !isnan( z_values[i][j] ) && !is_bit_set( job_region_done, i, j ) )
+				z_values[i][j] += shift;
+
+	SERIAL_ECHO("Rest of Mesh moved by ");
+	SERIAL_ECHO_F( shift, 6 );
+	SERIAL_ECHO("\n");
+}
+
+bool probe_entire_mesh_step()  {
+float xProbe, yProbe, measured_z;
+
+    if ( ubl_job.state == 0 ) {
+#if HAS_HEATER_WAIT
+	if ( bed_needs_wait_before_probing() )	// G28 may have run while the bed heated.  Don't probe a bed that is still moving.
+		return !ubl_job.abort;
+#endif
+	if ( ubl_job.abort ) 
+		return false;
+	UBL_has_control_of_LCD_Panel++;
+	save_UBL_active_state_and_disable();	 // we don't do bed level correction because we want the raw data when we probe
+	DEPLOY_PROBE();
+	ubl_job.state = 1;
+	return true;
+    }
+
+    if ( G29_lcd_clicked() || ubl_job.abort ) {
+    	SERIAL_PROTOCOLLNPGM("\nMesh only partially populated.");
+	lcd_quick_feedback();
+	while ( G29_lcd_clicked() )
+	       idle();	
+    	UBL_has_control_of_LCD_Panel = 0;
+	STOW_PROBE();
+	restore_UBL_active_state_and_leave();
+	finish_region_probing();
+	return false;
+    }
 
-    } while (location.x_index>=0 && location.y_index>=0 );
+    if ( job_region_active )
+    	job_location = find_closest_mesh_point_of_type( SET_IN_BITMAP, job_x,  job_y, 1, job_region );
+    else
+    	job_location = find_closest_mesh_point_of_type( INVALID, job_x,  job_y, 1, NULL);  // the '1' says we want the location to be relative to the probe
+    if (job_location.x_index<0 || job_location.y_index<0 ) 
+	goto LEAVE;
+
+    xProbe = blm.map_x_index_to_bed_location(job_location.x_index); 
+    yProbe = blm.map_y_index_to_bed_location(job_location.y_index);
+    if ( xProbe<MIN_PROBE_X || xProbe>MAX_PROBE_X || yProbe<MIN_PROBE_Y || yProbe>MAX_PROBE_Y)  {
+    	SERIAL_PROTOCOLLNPGM("?Error: Attempt to probe off the bed.");
+    	UBL_has_control_of_LCD_Panel = 0;
+	goto LEAVE;
+    }
+    measured_z = probe_pt(xProbe, yProbe, ProbeStay, G29_Verbose_Level) + Z_PROBE_OFFSET_FROM_EXTRUDER;
+#if ENABLED(SMART_PROBING)
+    z_samples[job_location.x_index][job_location.y_index] = probe_samples;
+    z_spread[job_location.x_index][job_location.y_index] = min( probe_spread * 1000.0 + 0.5, 255 );
+    job_outliers += probe_rejected;
+#endif
+    if ( job_region_active ) {
+	bit_clear( job_region, job_location.x_index, job_location.y_index );
+	bit_set( job_region_done, job_location.x_index, job_location.y_index );
+	if ( !isnan( z_values[job_location.x_index][job_location.y_index] ) ) {
+		job_region_shift += measured_z - z_values[job_location.x_index][job_location.y_index];
+		job_region_shift_cnt++;
+	}
+    }
+    z_values[job_location.x_index][job_location.y_index] = measured_z;
+    ubl_job_point_done();
+
+    if ( job_mesh_map )
+    	blm.display_map(1);
+    return true;
 
 LEAVE:
+    finish_region_probing();
+#if ENABLED(SMART_PROBING)
+    report_probe_statistics();
+#endif
+    if ( job_mesh_map )
+    	blm.display_map(1);
     STOW_PROBE();
     restore_UBL_active_state_and_leave();
-    do_blocking_move_to_xy(X_Pos, Y_Pos);
+    do_blocking_move_to_xy(job_x, job_y);
+    return false;
 }
 
  
 
-struct vector tilt_mesh_based_on_3pts(float pt1, float pt2, float pt3) {
-	struct vector v1, v2, normal;
-	float c, d;
-	int i, j;
-
-	v1.dx = (UBL_PROBE_PT_1_X - UBL_PROBE_PT_2_X);
-	v1.dy = (UBL_PROBE_PT_1_Y - UBL_PROBE_PT_2_Y);
-	v1.dz = (pt1 - pt2);
-
-	v2.dx = (UBL_PROBE_PT_3_X - UBL_PROBE_PT_2_X);
-	v2.dy = (UBL_PROBE_PT_3_Y - UBL_PROBE_PT_2_Y);
-	v2.dz = (pt3 - pt2);
+// tilt_mesh_based_on_probed_grid() probes the bed and tilts the Mesh to match.  With a grid_size of 2 or more,
+// a grid_size x grid_size grid of points is probed across the area spanned by the three UBL_PROBE_PT's.
+// Otherwise just the three points are probed.  Each result is compared against what the Mesh already says
+// for that location and folded into a Least Squares Fit of the plane.  The plane is then added to the Mesh.
+
+void tilt_mesh_based_on_probed_grid( int grid_size ) {
+static const float pt_x[3] = { UBL_PROBE_PT_1_X, UBL_PROBE_PT_2_X, UBL_PROBE_PT_3_X };
+static const float pt_y[3] = { UBL_PROBE_PT_1_Y, UBL_PROBE_PT_2_Y, UBL_PROBE_PT_3_Y };
+struct linear_fit_data lsf;
+float x, y, measured_z, x_min, x_max, y_min, y_max;
+int i, j, k, n;
+
+	x_min = min( min( pt_x[0], pt_x[1] ), pt_x[2] );
+	x_max = max( max( pt_x[0], pt_x[1] ), pt_x[2] );
+	y_min = min( min( pt_y[0], pt_y[1] ), pt_y[2] );
+	y_max = max( max( pt_y[0], pt_y[1] ), pt_y[2] );
+
+	n = ( grid_size < 2 ) ? 3 : grid_size * grid_size;
+	incremental_LSF_reset( &lsf );
+
+	for (k = 0; k < n; k++) {
+		if ( grid_size < 2 ) {
+			x = pt_x[k];
+			y = pt_y[k];
+		}
+		else {
+			i = k % grid_size;
+			j = k / grid_size;
+			if ( j & 1 )				// Go back and forth across the bed so we
+				i = grid_size - 1 - i;		// don't waste time on long moves
+			x = x_min + i * ( x_max - x_min ) / ( grid_size - 1 );
+			y = y_min + j * ( y_max - y_min ) / ( grid_size - 1 );
+		}
+		measured_z = probe_pt( x, y, k == n - 1 /*Stow Flag*/, G29_Verbose_Level ) + zprobe_zoffset;
 
-	// do cross product
+//  We need to adjust each point by the Mesh Height at its location.  Just because it is non-zero doesn't mean
+//  the Mesh is tilted!
 
-	normal.dx = v1.dy * v2.dz - v1.dz * v2.dy;
-	normal.dy = v1.dz * v2.dx - v1.dx * v2.dz;
-	normal.dz = v1.dx * v2.dy - v1.dy * v2.dx;
+		measured_z -= blm.get_z_correction( x, y );
+		incremental_LSF( &lsf, x, y, measured_z );
+	}
 
-	// printf("[%f,%f,%f]    ", normal.dx, normal.dy, normal.dz);
+	do_blocking_move_to_xy( (X_MAX_POS-X_MIN_POS)/2.0, (Y_MAX_POS-Y_MIN_POS)/2.0);
 
-	normal.dx /= normal.dz;	// This code does two things.  This vector is normal to the tilted plane.
-	normal.dy /= normal.dz;	// However, we don't know its direction.  We need it to point up.  So if	
-	normal.dz /= normal.dz;	// Z is negative, we need to invert the sign of all components of the vector
-				// We also need Z to be unity because we are going to be treating this triangle
-				// as the sin() and cos() of the bed's tilt
-	
-	//
-	// All of 3 of these points should give us the same d constant
-	//
-
-	d = normal.dx*UBL_PROBE_PT_1_X + normal.dy*UBL_PROBE_PT_1_Y + normal.dz*pt1;	
-	c = -((normal.dx*UBL_PROBE_PT_1_X + normal.dy*UBL_PROBE_PT_1_Y) - d);
-SERIAL_ECHO("d from first  point: ");
-SERIAL_ECHO_F(d,6);
-SERIAL_ECHO("  c: ");
-SERIAL_ECHO_F(c,6);
-SERIAL_ECHO("\n");
-	d = normal.dx*UBL_PROBE_PT_2_X + normal.dy*UBL_PROBE_PT_2_Y + normal.dz*pt2;	
-	c = -((normal.dx*UBL_PROBE_PT_2_X + normal.dy*UBL_PROBE_PT_2_Y) - d);
-SERIAL_ECHO("d from second point: ");
-SERIAL_ECHO_F(d,6);
-SERIAL_ECHO("  c: ");
-SERIAL_ECHO_F(c,6);
-SERIAL_ECHO("\n");
-	d = normal.dx*UBL_PROBE_PT_3_X + normal.dy*UBL_PROBE_PT_3_Y + normal.dz*pt3;	
-	c = -((normal.dx*UBL_PROBE_PT_3_X + normal.dy*UBL_PROBE_PT_3_Y) - d);
-SERIAL_ECHO("d from third  point: ");
-SERIAL_ECHO_F(d,6);
-SERIAL_ECHO("  c: ");
-SERIAL_ECHO_F(c,6);
-SERIAL_ECHO("\n");
+	if ( finish_incremental_LSF( &lsf ) ) {
+		SERIAL_ERROR_START;
+		SERIAL_ERRORLNPGM("Could not fit a plane to the probed points.  Mesh not tilted.");
+		return;
+	}
 
+	SERIAL_ECHO("Plane from ");
+	SERIAL_ECHO( n );
+	SERIAL_ECHO(" points:  z = ");
+	SERIAL_ECHO_F( lsf.A, 6 );
+	SERIAL_ECHO(" * x + ");
+	SERIAL_ECHO_F( lsf.B, 6 );
+	SERIAL_ECHO(" * y + ");
+	SERIAL_ECHO_F( lsf.D, 6 );
+	SERIAL_ECHO("\n");
 
 	for (i = 0; i < MESH_NUM_X_POINTS; i++) {
 		for (j = 0;  j < MESH_NUM_Y_POINTS; j++) {
-			c = -((normal.dx*(MESH_MIN_X+i*MESH_X_DIST) + normal.dy*(MESH_MIN_Y+j*MESH_Y_DIST)) - d);
-			z_values[i][j] += c;
+			z_values[i][j] += lsf.A * (MESH_MIN_X+i*MESH_X_DIST) + lsf.B * (MESH_MIN_Y+j*MESH_Y_DIST) + lsf.D;
 		}
 	}
-
-	return normal;
 }
 
 float use_encoder_wheel_to_measure_point() {
@@ -866,51 +1354,78 @@ float Z1, Z2;
 }
 
 
+// manually_probe_remaining_mesh() starts the job that walks the nozzle to each INVALID Mesh Point.  The user
+// lowers the nozzle with the Encoder Wheel and clicks to record the height.   Holding the click for 1.5
+// seconds stops the job.   Each call to manually_probe_remaining_mesh_step() does one of:  move to the
+// next point, check the Encoder Wheel, or check the click.
+
+#define MANUAL_MOVE_TO_POINT	0
+#define MANUAL_ADJUST_Z		1
+#define MANUAL_CLICKED		2
+
 void manually_probe_remaining_mesh( float X_Pos, float Y_Pos, float z_clearance, float card_thickness, bool do_mesh_map ) {
-struct mesh_index_pair location;
-float last_x, last_y, dx, dy;
-float xProbe, yProbe, measured_z;
-unsigned long cnt;
+    job_x = X_Pos;
+    job_y = Y_Pos;
+    job_z_clearance = z_clearance;
+    job_card_thickness = card_thickness;
+    job_mesh_map = do_mesh_map;
+
+    job_last_x = -9999.99;
+    job_last_y = -9999.99;
 
     UBL_has_control_of_LCD_Panel++;
-    last_x = -9999.99;
-    last_y = -9999.99;
     save_UBL_active_state_and_disable();	 // we don't do bed level correction because we want the raw data when we probe
     do_blocking_move_to_z( z_clearance );     
     do_blocking_move_to_xy( X_Pos, Y_Pos );
 
-    do {
-	if ( do_mesh_map )
+    ubl_job_start( G29_MANUAL_PROBE_JOB, count_invalid_mesh_points( false ) );
+}
+
+bool manually_probe_remaining_mesh_step() {
+float dx, dy;
+float xProbe, yProbe;
+
+    if ( ubl_job.abort ) 
+	goto STOPPED;
+
+    switch ( ubl_job.state ) {
+      case MANUAL_MOVE_TO_POINT:
+	if ( job_mesh_map )
     		blm.display_map(1);
 
-	location = find_closest_mesh_point_of_type( INVALID, X_Pos,  Y_Pos, 0, NULL);	// The '0' says we want to use the nozzle's position
+	job_location = find_closest_mesh_point_of_type( INVALID, job_x,  job_y, 0, NULL);	// The '0' says we want to use the nozzle's position
 											// It doesn't matter if the probe can not reach the 
 											// NAN location.  This is a manual probe.
-    	if (location.x_index<0 && location.y_index<0 ) 
-		continue;
+	if (job_location.x_index<0 && job_location.y_index<0 ) {
+		if ( job_mesh_map )
+   			blm.display_map(1);
+		goto LEAVE;
+	}
 
-	xProbe = blm.map_x_index_to_bed_location(location.x_index); 
-	yProbe = blm.map_y_index_to_bed_location(location.y_index);
+	xProbe = blm.map_x_index_to_bed_location(job_location.x_index); 
+	yProbe = blm.map_y_index_to_bed_location(job_location.y_index);
 	if ( xProbe<X_MIN_POS || xProbe>X_MAX_POS || yProbe<Y_MIN_POS || yProbe>Y_MAX_POS)  {
 		SERIAL_PROTOCOLLNPGM("?Error: Attempt to probe off the bed.");
 		UBL_has_control_of_LCD_Panel = 0;
 		goto LEAVE;
 	}
 
-	dx = xProbe - last_x;
-	dy = yProbe - last_y;
+	dx = xProbe - job_last_x;
+	dy = yProbe - job_last_y;
 
         if ( sqrt(dx*dx+dy*dy) < BIG_RAISE_NOT_NEEDED ) 
 		do_blocking_move_to_z( current_position[Z_AXIS] + SIZE_OF_LITTLE_RAISE );
 	else 
-		do_blocking_move_to_z(z_clearance);
+		do_blocking_move_to_z(job_z_clearance);
 
-	last_x = xProbe;
-	last_y = yProbe;
+	job_last_x = xProbe;
+	job_last_y = yProbe;
 	do_blocking_move_to_xy( xProbe, yProbe );
+	ubl_job.state = MANUAL_ADJUST_Z;
+	return true;
 
-	while (!G29_lcd_clicked() ) { 		// we need the loop to move the nozzle based on the encoder wheel here!
-		idle();
+      case MANUAL_ADJUST_Z:
+	if ( !G29_lcd_clicked() ) { 		// we need to move the nozzle based on the encoder wheel here!
 		if ( G29_encoderDiff != 0) {
 			float new_z;					
 			// We define a new variable so we can know ahead of time where we are trying to go.
@@ -920,37 +1435,45 @@ unsigned long cnt;
 			G29_encoderDiff = 0;			
 			do_blocking_move_to_z( new_z );
 		}	
+		return true;
 	}
-
-	cnt = millis();
-	while ( G29_lcd_clicked() ) { 		// debounce and watch for abort
-		idle();
-		if (millis()-cnt > 1500L ) {
-			SERIAL_PROTOCOLLNPGM("\nMesh only partially populated.");
-			do_blocking_move_to_z(Z_RAISE_PROBE_DEPLOY_STOW);     
-			lcd_quick_feedback();
-			while ( G29_lcd_clicked() )  	
-				idle();
-			UBL_has_control_of_LCD_Panel = 0;
-   			restore_UBL_active_state_and_leave();
-			return;
-		}
+	job_click_ms = millis();
+	ubl_job.state = MANUAL_CLICKED;
+	return true;
+
+      case MANUAL_CLICKED:
+	if ( G29_lcd_clicked() ) { 		// debounce and watch for abort
+		if (millis()-job_click_ms > 1500L ) 
+			goto STOPPED;
+		return true;
 	}
 
-	z_values[location.x_index][location.y_index] = current_position[Z_AXIS] - card_thickness;
+	z_values[job_location.x_index][job_location.y_index] = current_position[Z_AXIS] - job_card_thickness;
 	if (G29_Verbose_Level > 2) {
 		SERIAL_PROTOCOL("Mesh Point Measured at: ");
-		SERIAL_PROTOCOL_F( z_values[location.x_index][location.y_index], 6 );
+		SERIAL_PROTOCOL_F( z_values[job_location.x_index][job_location.y_index], 6 );
 		SERIAL_PROTOCOL("\n");
 	}
-    } while (location.x_index>=0 && location.y_index>=0 );
+	ubl_job_point_done();
+	ubl_job.state = MANUAL_MOVE_TO_POINT;
+	return true;
+    }
+
+STOPPED:
+    SERIAL_PROTOCOLLNPGM("\nMesh only partially populated.");
+    do_blocking_move_to_z(Z_RAISE_PROBE_DEPLOY_STOW);     
+    lcd_quick_feedback();
+    while ( G29_lcd_clicked() )  	
+	idle();
+    UBL_has_control_of_LCD_Panel = 0;
+    restore_UBL_active_state_and_leave();
+    return false;
 
-    if ( do_mesh_map )
-   	blm.display_map(1);
 LEAVE:
     restore_UBL_active_state_and_leave();
     do_blocking_move_to_z(Z_RAISE_PROBE_DEPLOY_STOW);     
-    do_blocking_move_to_xy(X_Pos, Y_Pos);     
+    do_blocking_move_to_xy(job_x, job_y);     
+    return false;
 }
 
 
@@ -1230,8 +1753,6 @@ void restore_UBL_active_state_and_leave()
 // good to have the extra information.   Soon... we prune this to just a few items
 //
 void G29_What_Command() {
-    int k;
-    k = E2END - Unified_Bed_Leveling_EEPROM_start;
     Statistics_Flag++;
     SERIAL_PROTOCOLPGM("Unified Bed Leveling System ");
     if ( blm.state.active )
@@ -1259,6 +1780,9 @@ void G29_What_Command() {
     SERIAL_ECHOPAIR("\nG29_Correction_Fade_Height : ", blm.state.G29_Correction_Fade_Height );
     SERIAL_PROTOCOLPGM("  ----------------------------------       <----<<< \n"); 	// These arrows are just to help me 
     											// find this info buried in the clutter
+#if ENABLED(SMART_PROBING)
+    report_probe_statistics();
+#endif
     idle();
 
 
@@ -1272,8 +1796,12 @@ void G29_What_Command() {
     SERIAL_PROTOCOLPGM("\n");
 
     SERIAL_PROTOCOLPGM("\n");
-    SERIAL_PROTOCOLPGM("Free EEPROM space starts at: 0x");
-    prt_hex_word( Unified_Bed_Leveling_EEPROM_start );
+    SERIAL_PROTOCOLPGM("Meshes stored in slots:");
+    for (int i = 0; i < EEPROM_MESH_SLOTS; i++)
+    	if ( blm.mesh_address(i) >= 0 ) {
+		SERIAL_PROTOCOLPGM(" ");
+		SERIAL_PROTOCOL( i );
+	}
     SERIAL_PROTOCOLPGM("\n");
     idle();
 
@@ -1289,14 +1817,25 @@ void G29_What_Command() {
     SERIAL_PROTOCOL( sizeof(z_values ) );
     SERIAL_PROTOCOLLNPGM("\n");
 
-    SERIAL_PROTOCOLPGM("EEPROM free for UBL: 0x");
-    prt_hex_word( k );
-    SERIAL_PROTOCOLPGM("\n");
+    SERIAL_PROTOCOLPGM("EEPROM can hold ");
+    SERIAL_PROTOCOL( eeprom_store_room( sizeof(z_values) ) );
+    SERIAL_PROTOCOLPGM(" more meshes. \n");
+#if ENABLED(UBL_SD_MESHES)
+    blm.list_meshes_sd();
     idle();
+#endif
 
-    SERIAL_PROTOCOLPGM("EEPROM can hold 0x");
-    prt_hex_word( k / sizeof(z_values) );
-    SERIAL_PROTOCOLPGM(" meshes. \n");
+#if ENABLED(UBL_MESH_BANK)
+    SERIAL_ECHOPAIR("Mesh bed temperature: ", blm.state.mesh_bed_temp );
+    SERIAL_PROTOCOLPGM("\n");
+    for (int i = 0; i < UBL_MESH_BANK_SLOTS; i++) 
+    	if ( blm.state.mesh_bank_temp[i] > 0 ) {
+		SERIAL_ECHOPAIR("  Slot ", i );
+		SERIAL_ECHOPAIR(" probed at ", blm.state.mesh_bank_temp[i] );
+		SERIAL_PROTOCOLPGM("C\n");
+	}
+    idle();
+#endif
 
     SERIAL_PROTOCOLPGM("sizeof(stat)     :");
     prt_hex_word( sizeof(blm.state) );
@@ -1375,7 +1914,7 @@ int i, j, kkkk;
 //
 void G29_Kompare_Current_Mesh_to_Stored_Mesh()  {
     float tmp_z_values[MESH_NUM_X_POINTS][MESH_NUM_Y_POINTS];
-    int i, j, k;
+    int i, j;
 
     if ( !code_has_value() )  {
       SERIAL_PROTOCOLLNPGM("?Mesh # required.\n");
@@ -1383,15 +1922,12 @@ void G29_Kompare_Current_Mesh_to_Stored_Mesh()  {
     }
     Storage_Slot = code_value_int();
 
-    k = E2END - sizeof( blm.state );
-    j = (k - Unified_Bed_Leveling_EEPROM_start) / sizeof( tmp_z_values );
-
-    if ( Storage_Slot < 0 || Storage_Slot > j || Unified_Bed_Leveling_EEPROM_start <= 0) {
-        SERIAL_PROTOCOLLNPGM("?EEPROM storage not available for use.\n");
+    j = blm.mesh_address( Storage_Slot );
+    if ( j < 0 ) {
+        SERIAL_PROTOCOLLNPGM("?No Mesh stored in that slot.\n");
 	return;
     }
 
-    j = k-(Storage_Slot+1)*sizeof(tmp_z_values);	
     eeprom_read_block( (void *) &tmp_z_values , (void *) j, sizeof(tmp_z_values) );
 
     SERIAL_ECHOPAIR("Subtracting Mesh ", Storage_Slot);
@@ -1463,36 +1999,58 @@ struct mesh_index_pair find_closest_mesh_point_of_type(Mesh_Point_Type type, flo
 }
 
 
+// fine_tune_mesh() starts the job that walks the nozzle to the Mesh Points closest to (X_Pos, Y_Pos) and lets
+// the user edit each one with the Encoder Wheel.   A click stores the new value, holding the click for 1.5
+// seconds stops the job.   It does Repetition_Cnt points.
+
+#define FINE_TUNE_MOVE_TO_POINT	0
+#define FINE_TUNE_EDIT		1
+#define FINE_TUNE_CLICKED	2
+
+static unsigned int job_not_done[16];
+
 void fine_tune_mesh( float X_Pos, float Y_Pos, float Height_Value, bool do_mesh_map ) {
-struct mesh_index_pair location;
-float xProbe, yProbe, measured_z, new_z;					
-unsigned int i, not_done[16];
-long round_off;
-unsigned long cnt;
+unsigned int i;
+
+    job_x = X_Pos;
+    job_y = Y_Pos;
+    job_mesh_map = do_mesh_map;
 
     save_UBL_active_state_and_disable();
-    for(i=0; i<16; i++) not_done[i]=0xffff;
+    for(i=0; i<16; i++) job_not_done[i]=0xffff;
 #if ENABLED(ULTRA_LCD)
     lcd_setstatus( "Fine Tuning Mesh.", true);
 #endif
 
     do_blocking_move_to_z( Z_RAISE_PROBE_DEPLOY_STOW );     
     do_blocking_move_to_xy( X_Pos, Y_Pos );
-    do {
-	if ( do_mesh_map )
+
+    ubl_job_start( G29_FINE_TUNE_JOB, min(Repetition_Cnt, MESH_NUM_X_POINTS*MESH_NUM_Y_POINTS) );
+}
+
+bool fine_tune_mesh_step() {
+float xProbe, yProbe;
+long round_off;
+
+    if ( ubl_job.abort ) 
+	goto FINE_TUNE_EXIT;
+
+    switch ( ubl_job.state ) {
+      case FINE_TUNE_MOVE_TO_POINT:
+	if ( job_mesh_map )
     		blm.display_map(1);
 
-	location = find_closest_mesh_point_of_type( SET_IN_BITMAP, X_Pos,  Y_Pos, 0, not_done);	// The '0' says we want to use the nozzle's position
-												// It doesn't matter if the probe can not reach this 
-												// location.  This is a manual edit of the Mesh Point.
-    	if (location.x_index<0 && location.y_index<0 ) 
-		continue;						// abort if we can't find any more points.
+	job_location = find_closest_mesh_point_of_type( SET_IN_BITMAP, job_x,  job_y, 0, job_not_done);	// The '0' says we want to use the nozzle's position
+													// It doesn't matter if the probe can not reach this 
+													// location.  This is a manual edit of the Mesh Point.
+	if (job_location.x_index<0 && job_location.y_index<0 ) 
+		goto FINE_TUNE_EXIT;					// abort if we can't find any more points.
 
-	bit_clear( not_done, location.x_index, location.y_index );	// Mark this location as 'adjusted' so we will find a
-									// different location the next time through the loop
+	bit_clear( job_not_done, job_location.x_index, job_location.y_index );	// Mark this location as 'adjusted' so we will find a
+										// different location the next time through
 
-	xProbe = blm.map_x_index_to_bed_location(location.x_index); 
-	yProbe = blm.map_y_index_to_bed_location(location.y_index);
+	xProbe = blm.map_x_index_to_bed_location(job_location.x_index); 
+	yProbe = blm.map_y_index_to_bed_location(job_location.y_index);
 	if ( xProbe<X_MIN_POS || xProbe>X_MAX_POS || yProbe<Y_MIN_POS || yProbe>Y_MAX_POS)  {	// In theory, we don't need this check.
 		SERIAL_PROTOCOLLNPGM("?Error: Attempt to edit off the bed.");			// This really can't happen, but for now,
 		UBL_has_control_of_LCD_Panel = 0;						// Let's do the check.
@@ -1501,32 +2059,38 @@ unsigned long cnt;
 
 	do_blocking_move_to_z( Z_RAISE_PROBE_DEPLOY_STOW );	// Move the nozzle to where we are going to edit
 	do_blocking_move_to_xy( xProbe, yProbe );
-	new_z = z_values[location.x_index][location.y_index] + .001 ;
+	job_new_z = z_values[job_location.x_index][job_location.y_index] + .001 ;
 
-	round_off = (long int) ((new_z+.0025)*1000.0);		// we chop off the last digits just to be clean.  We are rounding to the
+	round_off = (long int) ((job_new_z+.0025)*1000.0);	// we chop off the last digits just to be clean.  We are rounding to the
 	round_off = round_off - (round_off % 5l);		// closest 0 or 5 at the 3rd decimal place.
-	new_z = ((float) (round_off))/1000.0;			
+	job_new_z = ((float) (round_off))/1000.0;			
 
 SERIAL_ECHO("Mesh Point Currently At:  ");
-SERIAL_ECHO_F( new_z, 6 );
+SERIAL_ECHO_F( job_new_z, 6 );
 SERIAL_ECHO("\n");
 
 	lcd_implementation_clear();
-	lcd_mesh_edit_setup( new_z );
-	do {
-		new_z = lcd_mesh_edit();
-		idle();
-	} while ( !G29_lcd_clicked() );
+	lcd_mesh_edit_setup( job_new_z );
+	ubl_job.state = FINE_TUNE_EDIT;
+	return true;
+
+      case FINE_TUNE_EDIT:
+	job_new_z = lcd_mesh_edit();
+	if ( !G29_lcd_clicked() ) 
+		return true;
 
 	UBL_has_control_of_LCD_Panel = 1;	// There is a race condition for the Encoder Wheel getting clicked.
 						// It could get detected in lcd_mesh_edit (actually _lcd_mesh_fine_tune( )
 						// or here.  So, until we are done looking for a long Encoder Wheel Press,
 						// we need to take control of the panel
-	cnt = millis();
+	job_click_ms = millis();
 	lcd_return_to_status();
-	while ( G29_lcd_clicked() ) { 		// debounce and watch for abort
-		idle();
-		if ( millis() - cnt > 1500L ) {
+	ubl_job.state = FINE_TUNE_CLICKED;
+	return true;
+
+      case FINE_TUNE_CLICKED:
+	if ( G29_lcd_clicked() ) { 		// debounce and watch for abort
+		if ( millis() - job_click_ms > 1500L ) {
 			SERIAL_PROTOCOLLNPGM("\nFine Tuning of Mesh Stopped.");
 			do_blocking_move_to_z(Z_RAISE_PROBE_DEPLOY_STOW);     
 			lcd_setstatus( "Mesh Editing Stopped.   ", true);
@@ -1537,22 +2101,28 @@ SERIAL_ECHO("\n");
 			UBL_has_control_of_LCD_Panel = 0; 
 			goto FINE_TUNE_EXIT;
 		}
+		return true;
 	}
 	UBL_has_control_of_LCD_Panel = 0; 
 	delay(20);	// We don't want any switch noise. 
 
-	z_values[location.x_index][location.y_index] = new_z;
+	z_values[job_location.x_index][job_location.y_index] = job_new_z;
 
 	lcd_implementation_clear();
+	ubl_job_point_done();
 
-    } while (location.x_index>=0 && location.y_index>=0 && --Repetition_Cnt );
+	if ( --Repetition_Cnt <= 0 ) 
+		goto FINE_TUNE_EXIT;
+	ubl_job.state = FINE_TUNE_MOVE_TO_POINT;
+	return true;
+    }
 
 FINE_TUNE_EXIT:
-    if ( do_mesh_map )
+    if ( job_mesh_map )
    	blm.display_map(1);
     restore_UBL_active_state_and_leave();
     do_blocking_move_to_z(Z_RAISE_PROBE_DEPLOY_STOW);     
-    do_blocking_move_to_xy(X_Pos, Y_Pos);     
+    do_blocking_move_to_xy(job_x, job_y);     
 
     UBL_has_control_of_LCD_Panel = 0;
 
@@ -1560,7 +2130,7 @@ FINE_TUNE_EXIT:
        lcd_setstatus( "Done Editing Mesh.   ", true);
     #endif
     SERIAL_ECHO("Done Editing Mesh. \n");
-    return;
+    return false;
 }
 
 
@@ -36,7 +36,6 @@
 
 #if ENABLED(UNIFIED_BED_LEVELING_FEATURE)
 //#include "vector_3.h"
-//#include "qr_solve.h"
 
 #include "Bed_Leveling.h"
 //#include "configuration_store.h"
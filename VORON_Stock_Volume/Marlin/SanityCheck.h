@@ -95,6 +95,31 @@
   #endif
 #endif
 
+/**
+ * Emergency command parser
+ */
+#if ENABLED(EMERGENCY_PARSER) && defined(USBCON)
+  #error "EMERGENCY_PARSER does not work on boards with AT90USB processors (USBCON)."
+#endif
+
+/**
+ * Binary host protocol
+ */
+#if ENABLED(BINARY_HOST_PROTOCOL) && DISABLED(BINARY_GCODE)
+  #error "BINARY_HOST_PROTOCOL requires BINARY_GCODE."
+#endif
+
+/**
+ * Auto-report temperatures
+ */
+#if ENABLED(AUTO_REPORT_TEMPERATURES)
+  #if ENABLED(EXPERIMENTAL_I2CBUS)
+    #error "AUTO_REPORT_TEMPERATURES and EXPERIMENTAL_I2CBUS both use M155. Disable one of them."
+  #elif !HAS_TEMP_HOTEND && !HAS_TEMP_BED
+    #error "AUTO_REPORT_TEMPERATURES requires a hotend or bed thermistor."
+  #endif
+#endif
+
 /**
  * Babystepping
  */
@@ -203,6 +228,12 @@
   #if ENABLED(DELTA)
     #error "UNIFIED_BED_LEVELING does not yet support DELTA printers."
   #endif
+  #if ENABLED(UBL_MESH_BANK) && (UBL_MESH_BANK_SLOTS < 2 || UBL_MESH_BANK_SLOTS > 16)
+    #error "UBL_MESH_BANK_SLOTS must be from 2 to 16, the Mesh slots the EEPROM record store keeps track of."
+  #endif
+  #if ENABLED(UBL_SD_MESHES) && DISABLED(SDSUPPORT)
+    #error "UBL_SD_MESHES requires SDSUPPORT."
+  #endif
   #if MESH_NUM_X_POINTS > 15 || MESH_NUM_Y_POINTS > 15 
     #error "MESH_NUM_X_POINTS and MESH_NUM_Y_POINTS need to be less than 16."
   #endif
@@ -303,6 +334,17 @@
 
 #endif
 
+/**
+ * Smart probing
+ */
+#if ENABLED(SMART_PROBING)
+  #if ENABLED(DELTA)
+    #error "SMART_PROBING is not supported for DELTA."
+  #elif SMART_PROBE_MIN_SAMPLES < 2 || SMART_PROBE_MAX_SAMPLES < SMART_PROBE_MIN_SAMPLES || SMART_PROBE_MAX_SAMPLES > 10
+    #error "SMART_PROBE_MIN_SAMPLES must be at least 2, and SMART_PROBE_MAX_SAMPLES from that up to 10."
+  #endif
+#endif
+
 
 #if ENABLED( UNIFIED_BED_LEVELING_FEATURE )
   #if DISABLED(ULTRA_LCD)
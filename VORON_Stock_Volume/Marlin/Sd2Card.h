@@ -165,7 +165,11 @@ uint8_t const SD_CARD_TYPE_SDHC = 3;
 class Sd2Card {
  public:
   /** Construct an instance of Sd2Card. */
-  Sd2Card() : errorCode_(SD_CARD_ERROR_INIT_NOT_CALLED), type_(0) {}
+  Sd2Card() : errorCode_(SD_CARD_ERROR_INIT_NOT_CALLED), type_(0)
+    #if ENABLED(SD_READ_AHEAD)
+      , streaming_(false)
+    #endif
+  {}
   uint32_t cardSize();
   bool erase(uint32_t firstBlock, uint32_t lastBlock);
   bool eraseSingleBlockEnable();
@@ -215,6 +219,11 @@ class Sd2Card {
   bool readData(uint8_t* dst);
   bool readStart(uint32_t blockNumber);
   bool readStop();
+  #if ENABLED(SD_READ_AHEAD)
+    int8_t readDataPoll(uint8_t* dst);
+    /** \return true while a multiple block read sequence is open. */
+    bool streaming() const {return streaming_;}
+  #endif
   bool setSckRate(uint8_t sckRateID);
   /** Return the card type: SD V1, SD V2 or SDHC
    * \return 0 - SD V1, 1 - SD V2, or 3 - SDHC.
@@ -231,6 +240,9 @@ class Sd2Card {
   uint8_t spiRate_;
   uint8_t status_;
   uint8_t type_;
+  #if ENABLED(SD_READ_AHEAD)
+    bool streaming_;
+  #endif
   // private functions
   uint8_t cardAcmd(uint8_t cmd, uint32_t arg) {
     cardCommand(CMD55, 0);
@@ -239,6 +251,7 @@ class Sd2Card {
   uint8_t cardCommand(uint8_t cmd, uint32_t arg);
 
   bool readData(uint8_t* dst, uint16_t count);
+  bool readTransfer(uint8_t* dst, uint16_t count);
   bool readRegister(uint8_t cmd, void* buf);
   void chipSelectHigh();
   void chipSelectLow();
@@ -26,6 +26,7 @@
 #include "stepper.h"
 #include "temperature.h"
 #include "language.h"
+#include "fastnum.h"
 
 #if ENABLED(SDSUPPORT)
 
@@ -38,6 +39,12 @@ CardReader::CardReader() {
   logging = false;
   workDirDepth = 0;
   file_subcall_ctr = 0;
+  #if ENABLED(BINARY_GCODE)
+    binary = false;
+  #endif
+  #if ENABLED(SD_READ_AHEAD)
+    raReset();
+  #endif
   memset(workDirParents, 0, sizeof(workDirParents));
 
   autostart_stilltocheck = true; //the SD start is delayed, because otherwise the serial cannot answer fast enough to make contact with the host software.
@@ -396,6 +403,21 @@ void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
       SERIAL_PROTOCOLPAIR(MSG_SD_SIZE, filesize);
       SERIAL_EOL;
       sdpos = 0;
+      #if ENABLED(SD_READ_AHEAD)
+        raReset();
+      #endif
+      #if ENABLED(BINARY_GCODE)
+        // Binary G-code starts with a header, anything else is printed as text
+        uint8_t header[BINARY_GCODE_HEADER_SIZE];
+        binary = getBytes(header, sizeof(header)) && !memcmp_P(header, PSTR(BINARY_GCODE_HEADER), sizeof(header));
+        if (!binary) setIndex(0);
+      #endif
+      #if ENABLED(UBL_PRINT_AREA_FROM_GCODE)
+        #if ENABLED(BINARY_GCODE)
+          if (!binary)
+        #endif
+            readPrintArea();
+      #endif
 
       SERIAL_PROTOCOLLNPGM(MSG_SD_FILE_SELECTED);
       getfilename(0, fname);
@@ -421,6 +443,78 @@ void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
   }
 }
 
+#if ENABLED(UBL_PRINT_AREA_FROM_GCODE)
+
+  /**
+   * Look for the print's extent in the comments at the top of the file
+   * just opened, then go back to the start. Cura writes it as:
+   *
+   *   ;MINX:12.3
+   *   ;MINY:45.6
+   *   ;MAXX:78.9
+   *   ;MAXY:98.7
+   */
+  void CardReader::readPrintArea() {
+    static const char names[4][6] PROGMEM = { ";MINX", ";MINY", ";MAXX", ";MAXY" };
+    float value[4];
+    uint8_t found = 0, len = 0;
+    char line[24];
+    int16_t c;
+
+    print_footprint.valid = false;
+    for (uint16_t n = 0; n < PRINT_AREA_SCAN_BYTES && (c = get()) >= 0; n++) {
+      if (c != '\n' && c != '\r') {
+        if (len < sizeof(line) - 1) line[len++] = c;
+        continue;
+      }
+      line[len] = '\0';
+      for (uint8_t i = 0; i < 4; i++)
+        if (!strncmp_P(line, names[i], 5) && line[5] == ':') {
+          value[i] = parse_float(line + 6);
+          SBI(found, i);
+        }
+      if (found == 0x0F) break;
+      len = 0;
+    }
+    setIndex(0);
+
+    if (found == 0x0F && value[0] <= value[2] && value[1] <= value[3]) {
+      print_footprint.min_x = value[0];
+      print_footprint.min_y = value[1];
+      print_footprint.max_x = value[2];
+      print_footprint.max_y = value[3];
+      print_footprint.valid = true;
+    }
+  }
+
+#endif // UBL_PRINT_AREA_FROM_GCODE
+
+#if ENABLED(UBL_SD_MESHES)
+
+  /**
+   * UBL keeps its named Meshes in UBL_SD_MESH_DIR. They are opened with a
+   * file of their own so the file selected for printing stays open.
+   */
+  bool CardReader::openMeshDir(SdFile& dir, bool create/*=false*/) {
+    if (!cardOK) return false;
+    if (dir.open(&root, UBL_SD_MESH_DIR, O_READ)) return true;
+    return create && dir.mkdir(&root, UBL_SD_MESH_DIR);
+  }
+
+  bool CardReader::openMeshFile(SdFile& mesh, const char* name, bool write) {
+    char fname[13];
+    SdFile dir;
+
+    if (strlen(name) > 8 || !openMeshDir(dir, write)) return false;
+    strcpy(fname, name);
+    strcat_P(fname, PSTR(".MSH"));
+    bool ok = mesh.open(&dir, fname, write ? O_CREAT | O_WRITE | O_TRUNC : O_READ);
+    dir.close();
+    return ok;
+  }
+
+#endif // UBL_SD_MESHES
+
 void CardReader::removeFile(char* name) {
   if (!cardOK) return;
 
@@ -599,6 +693,144 @@ void CardReader::updir() {
     workDir = workDirParents[--workDirDepth];
 }
 
+#if ENABLED(BINARY_GCODE)
+
+  /**
+   * Read n bytes of the file being printed, across blocks if need be
+   */
+  bool CardReader::getBytes(uint8_t* dst, uint16_t n) {
+    while (n) {
+      uint8_t* data;
+      int16_t len = getSpan(&data);
+      if (len <= 0) return false;
+      NOMORE(len, n);
+      memcpy(dst, data, len);
+      if (!advance(len)) return false;
+      dst += len;
+      n -= len;
+    }
+    return true;
+  }
+
+#endif // BINARY_GCODE
+
+#if ENABLED(SD_READ_AHEAD)
+
+  #define RA_NONE 0xFFFFFFFF
+
+  void CardReader::raReset() {
+    if (card.streaming()) card.readStop();
+    ra_fblock[0] = ra_fblock[1] = RA_NONE;
+    ra_front = 0;
+    ra_stream = RA_NONE;
+    ra_chain_index = 0;
+    ra_chain_len = 0;
+  }
+
+  /**
+   * Map a block of the open file to its block on the card. The cluster chain
+   * is walked SD_READ_AHEAD_CLUSTERS at a time so the FAT is only read when
+   * the file runs off the end of the clusters looked up so far.
+   */
+  bool CardReader::raDeviceBlock(uint32_t fblock, uint32_t* dblock) {
+    uint8_t shift = volume.clusterSizeShift();
+    uint32_t index = fblock >> shift;
+    if (index < ra_chain_index || index >= ra_chain_index + ra_chain_len) {
+      // Carry on from the last cluster known, or go back to the start of the file
+      uint32_t at = 0, cluster = file.firstCluster();
+      if (ra_chain_len && index > ra_chain_index) {
+        at = ra_chain_index + ra_chain_len - 1;
+        cluster = ra_chain[ra_chain_len - 1];
+      }
+      uint32_t last = (filesize - 1) >> (9 + shift);
+      ra_chain_index = index;
+      ra_chain_len = 0;
+      for (;;) {
+        if (at >= index) ra_chain[ra_chain_len++] = cluster;
+        if (ra_chain_len == SD_READ_AHEAD_CLUSTERS || at >= last) break;
+        if (!file.nextCluster(cluster, &cluster)) return false;
+        at++;
+      }
+      if (!ra_chain_len) return false;
+    }
+    *dblock = volume.dataStartBlock()
+            + ((ra_chain[index - ra_chain_index] - 2) << shift)
+            + (fblock & (volume.blocksPerCluster() - 1));
+    return true;
+  }
+
+  /**
+   * Stream file block fblock into buffer b, starting a new multiple block
+   * read unless the open one is about to send that block. With wait set the
+   * block is read before returning. Otherwise the card is only polled.
+   * Returns 1 when the block is in, 0 if it's still on its way, -1 on error.
+   */
+  int8_t CardReader::raFill(uint8_t b, uint32_t fblock, bool wait) {
+    uint32_t dblock;
+    if (!raDeviceBlock(fblock, &dblock)) return -1;
+    if (!card.streaming() || ra_stream != dblock) {
+      if (card.streaming()) card.readStop();
+      if (!card.readStart(dblock)) return -1;
+      ra_stream = dblock;
+      ra_wait_ms = millis();
+    }
+    ra_fblock[b] = RA_NONE;
+    int8_t result;
+    if (wait)
+      result = card.readData(ra_buffer[b]) ? 1 : -1;
+    else {
+      result = card.readDataPoll(ra_buffer[b]);
+      if (!result && ELAPSED(millis(), ra_wait_ms + SD_READ_TIMEOUT)) result = -1;
+    }
+    if (result > 0) {
+      ra_fblock[b] = fblock;
+      ra_stream++;
+      ra_wait_ms = millis();
+    }
+    else if (result < 0)
+      card.readStop();
+    return result;
+  }
+
+  /**
+   * Called from idle() to keep the block after the one being parsed coming in.
+   * Only the start block token is polled for, so a slow card costs nothing here.
+   */
+  void CardReader::readAhead() {
+    if (!sdprinting || !isFileOpen()) {
+      if (card.streaming()) card.readStop();
+      return;
+    }
+    uint32_t fblock = sdpos >> 9;
+    uint8_t b = ra_front;
+    if (ra_fblock[b] == fblock || ra_fblock[b ^ 1] == fblock) {
+      if (ra_fblock[b] != fblock) ra_front = b ^= 1;
+      b ^= 1;
+      fblock++;
+    }
+    if (ra_fblock[b] == fblock || (fblock << 9) >= filesize) return;
+    raFill(b, fblock, false);
+  }
+
+  /**
+   * Unread part of the block being parsed, straight from the read-ahead
+   * buffers. Only waits for the card if idle() couldn't keep up.
+   */
+  int16_t CardReader::getSpan(uint8_t** data) {
+    if (sdpos >= filesize) return 0;
+    uint32_t fblock = sdpos >> 9;
+    if (ra_fblock[ra_front] != fblock) {
+      ra_front ^= 1;
+      if (ra_fblock[ra_front] != fblock && raFill(ra_front, fblock, true) < 0) return -1;
+    }
+    uint16_t offset = sdpos & 0x1FF, n = 512 - offset;
+    NOMORE(n, filesize - sdpos);
+    *data = ra_buffer[ra_front] + offset;
+    return n;
+  }
+
+#endif // SD_READ_AHEAD
+
 void CardReader::printingHasFinished() {
   stepper.synchronize();
   if (file_subcall_ctr > 0) { // Heading up to a parent file that called current as a procedure.
@@ -27,6 +27,19 @@
 
 #define MAX_DIR_DEPTH 10          // Maximum folder depth
 
+#if ENABLED(BINARY_GCODE)
+  #define BINARY_GCODE_HEADER      "MGCB\001" // Magic and format version, see scripts/gcode2bin.py
+  #define BINARY_GCODE_HEADER_SIZE 5
+#endif
+
+#if ENABLED(UBL_PRINT_AREA_FROM_GCODE)
+  #define PRINT_AREA_SCAN_BYTES    2048 // Slicers put their header comments at the very top
+#endif
+
+#if ENABLED(UBL_SD_MESHES)
+  #define UBL_SD_MESH_DIR          "MESHES" // G29 S"name" saves the Mesh as NAME.MSH in here
+#endif
+
 #include "SdFile.h"
 enum LsAction { LS_SerialPrint, LS_Count, LS_GetFilename };
 
@@ -61,6 +74,15 @@ public:
 
   void getAbsFilename(char *t);
 
+  #if ENABLED(UBL_PRINT_AREA_FROM_GCODE)
+    void readPrintArea();
+  #endif
+
+  #if ENABLED(UBL_SD_MESHES)
+    bool openMeshDir(SdFile& dir, bool create=false);
+    bool openMeshFile(SdFile& mesh, const char* name, bool write);
+  #endif
+
   void ls();
   void chdir(const char *relpath);
   void updir();
@@ -69,7 +91,26 @@ public:
   FORCE_INLINE bool isFileOpen() { return file.isOpen(); }
   FORCE_INLINE bool eof() { return sdpos >= filesize; }
   FORCE_INLINE int16_t get() { sdpos = file.curPosition(); return (int16_t)file.read(); }
-  FORCE_INLINE void setIndex(long index) { sdpos = index; file.seekSet(index); }
+  // Unread part of the current block, consumed with advance()
+  #if ENABLED(SD_READ_AHEAD)
+    int16_t getSpan(uint8_t** data);
+    FORCE_INLINE bool advance(uint16_t n) { sdpos += n; return true; }
+    void readAhead();
+  #else
+    FORCE_INLINE int16_t getSpan(uint8_t** data) { return file.readSpan(data); }
+    FORCE_INLINE bool advance(uint16_t n) { if (!file.readSpanDone(n)) return false; sdpos = file.curPosition(); return true; }
+  #endif
+  #if ENABLED(BINARY_GCODE)
+    FORCE_INLINE bool isBinary() { return binary; }
+    bool getBytes(uint8_t* dst, uint16_t n);
+  #endif
+  FORCE_INLINE void setIndex(long index) {
+    sdpos = index;
+    file.seekSet(index);
+    #if ENABLED(SD_READ_AHEAD)
+      raReset();
+    #endif
+  }
   FORCE_INLINE uint8_t percentDone() { return (isFileOpen() && filesize) ? sdpos / ((filesize + 99) / 100) : 0; }
   FORCE_INLINE char* getWorkDirName() { workDir.getFilename(filename); return filename; }
 
@@ -91,6 +132,24 @@ private:
   char proc_filenames[SD_PROCEDURE_DEPTH][MAXPATHNAMELENGTH];
   uint32_t filesize;
   uint32_t sdpos;
+  #if ENABLED(BINARY_GCODE)
+    bool binary; // the open file is pre-parsed binary G-code
+  #endif
+
+  #if ENABLED(SD_READ_AHEAD)
+    uint8_t ra_buffer[2][512];                  // block being parsed and the one after it
+    uint32_t ra_fblock[2];                      // file block held by each buffer
+    uint8_t ra_front;                           // buffer the parser reads from
+    uint32_t ra_stream;                         // device block the open CMD18 read sends next
+    millis_t ra_wait_ms;                        // when the card was last asked for a block
+    uint32_t ra_chain[SD_READ_AHEAD_CLUSTERS];  // clusters of the file from ra_chain_index on
+    uint32_t ra_chain_index;
+    uint8_t ra_chain_len;
+
+    void raReset();
+    bool raDeviceBlock(uint32_t fblock, uint32_t* dblock);
+    int8_t raFill(uint8_t b, uint32_t fblock, bool wait);
+  #endif
 
   millis_t next_autostart_ms;
   bool autostart_stilltocheck; //the sd start is delayed, because otherwise the serial cannot answer fast enought to make contact with the hostsoftware.
@@ -0,0 +1,55 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef EEPROM_STORE_H
+#define EEPROM_STORE_H
+
+#include <stdint.h>
+
+extern uint16_t eeprom_bytes_written;  // Bytes eeprom_update_data() has really written. Clear it to measure.
+uint16_t eeprom_update_data(int pos, const void* data, uint16_t size);
+
+extern uint16_t eeprom_16_bit_CRC;     // CRC-16 (CCITT) crc16mp() adds to. Start it at 0xFFFF.
+uint16_t crc16mp(void* data_p, uint16_t count);
+
+/**
+ * The EEPROM record store. Settings, the UBL State and each Mesh slot are
+ * records, found by type and id (the slot for a Mesh).
+ * test/eeprom_store_test.cpp checks its wear and that a reset loses nothing.
+ */
+enum EEPROMRecordType {
+  EEPROM_RECORD_PAD,        // Fills the end of the EEPROM when a record goes back to the start
+  EEPROM_RECORD_SETTINGS,
+  EEPROM_RECORD_UBL_STATE,
+  EEPROM_RECORD_MESH
+};
+
+#define EEPROM_MESH_SLOTS 16  // Mesh records the store keeps track of. How many fit depends on their size.
+
+void eeprom_store_init();
+bool eeprom_store_is_ready();
+uint16_t eeprom_store_room(uint16_t length);
+int eeprom_record_find(uint8_t type, uint8_t id, uint8_t &version, uint16_t &length);
+int eeprom_record_begin(uint8_t type, uint8_t id, uint8_t version, uint16_t length);
+void eeprom_record_end();
+bool eeprom_record_write(uint8_t type, uint8_t id, uint8_t version, const void* data, uint16_t length);
+
+#endif //EEPROM_STORE_H
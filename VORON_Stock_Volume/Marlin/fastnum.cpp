@@ -0,0 +1,429 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FASTNUM_HOST_TEST // test/fastnum_test.cpp provides the few Marlin and AVR bits used here
+  #include "Marlin.h"
+#endif
+#include "fastnum.h"
+
+#define DIGIT(n) ('0' + (n))
+#define DIGIMOD(n) DIGIT((n) % 10)
+
+static const uint32_t pow10_table[] PROGMEM = {
+  1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+static const uint32_t pow5_table[] PROGMEM = {
+  1UL, 5UL, 25UL, 125UL, 625UL, 3125UL, 15625UL, 78125UL, 390625UL, 1953125UL
+};
+
+/**
+ * mantissa / 10^decimals, correctly rounded. sticky says there were more
+ * non-zero digits after the mantissa's last one. A zero mantissa gives 0,
+ * so fractions below 10^-9 read as 0.
+ *
+ * Up to 24 bits the mantissa and the power of ten are exact floats, so one
+ * division rounds correctly. Past that the mantissa itself would be rounded,
+ * so it's divided by 5^decimals (at most 21 bits) in integers instead, with
+ * the remainder brought in 8 bits at a time, until there are 25 bits of
+ * quotient (24 plus a rounding bit). The 2^decimals only moves the exponent.
+ * Everything stays within 32 bits.
+ */
+static float scale_decimal(uint32_t mantissa, uint8_t decimals, bool sticky=false) {
+  // Digits past the mantissa only round it, they can't make a zero into a tiny number
+  if (!mantissa) return 0;
+  if (!sticky && (mantissa < 0x1000000UL || !decimals)) {
+    float m = mantissa;
+    return decimals ? m / (float)pgm_read_dword(&pow10_table[decimals]) : m;
+  }
+
+  uint32_t d = pgm_read_dword(&pow5_table[decimals]),
+           q = mantissa / d,
+           r = mantissa % d;
+  int8_t exponent = -decimals;
+  while (q < 0x1000000UL) {
+    // Too few bits, bring in more of the fraction
+    r <<= 8;
+    q = (q << 8) | (r / d);
+    r %= d;
+    exponent -= 8;
+  }
+  sticky |= r != 0;
+  while (q >= 0x2000000UL) {
+    sticky |= q & 1;
+    q >>= 1;
+    exponent++;
+  }
+
+  // Round half to even on the last bit
+  uint32_t significand = q >> 1;
+  if ((q & 1) && (sticky || (significand & 1))) significand++;
+  return ldexp((float)significand, exponent + 1);
+}
+
+float decimal_to_float(uint32_t mantissa, uint8_t decimals) {
+  return scale_decimal(mantissa, decimals);
+}
+
+float parse_float(const char* s, const char** end/*=NULL*/) {
+  while (*s == ' ') s++;
+
+  bool negative = false;
+  if (*s == '-' || *s == '+') negative = (*s++ == '-');
+
+  // The first 9 significant digits make the mantissa, which always fits in
+  // 32 bits. Later digits of the fraction only count towards the rounding.
+  // Later digits of the integer part scale the result.
+  uint32_t mantissa = 0;
+  uint8_t digits = 0, decimals = 0, excess = 0;
+  bool fraction = false, sticky = false;
+  for (;; s++) {
+    if (*s == '.' && !fraction) {
+      fraction = true;
+      continue;
+    }
+    if (!NUMERIC(*s)) break;
+    uint8_t digit = *s - '0';
+    if (digits < 9 && decimals < 9) {
+      mantissa = mantissa * 10 + digit;
+      if (mantissa) digits++;
+      if (fraction) decimals++;
+    }
+    else {
+      if (!fraction) excess++;
+      if (digit) sticky = true;
+    }
+  }
+  if (end) *end = s;
+
+  float value = scale_decimal(mantissa, decimals, sticky);
+  while (excess--) value *= 10;
+  return negative ? -value : value;
+}
+
+/**
+ * Write n in decimal. Only the digits above 16 bits need 32-bit divisions.
+ */
+char* format_ulong(char* buf, unsigned long n) {
+  char digits[10];
+  uint8_t i = 0;
+  for (; n > 0xFFFFUL; i++) {
+    unsigned long q = n / 10;
+    digits[i] = DIGIT(n - q * 10);
+    n = q;
+  }
+  uint16_t m = n;
+  do {
+    uint16_t q = m / 10;
+    digits[i++] = DIGIT(m - q * 10);
+    m = q;
+  } while (m);
+  while (i) *buf++ = digits[--i];
+  *buf = '\0';
+  return buf;
+}
+
+/**
+ * Write x rounded to a number of decimals (at most 9). The integer part is
+ * taken off exactly first, so only the fraction is scaled and rounded and a
+ * carry from rounding goes back into the integer part.
+ */
+char* format_float(char* buf, float x, uint8_t decimals) {
+  if (isnan(x)) { strcpy_P(buf, PSTR("nan")); return buf + 3; }
+  if (x < 0) {
+    *buf++ = '-';
+    x = -x;
+  }
+  if (x >= 4294967040.0) { strcpy_P(buf, PSTR("ovf")); return buf + 3; }
+
+  NOMORE(decimals, 9);
+  unsigned long int_part = (unsigned long)x,
+                scale = pgm_read_dword(&pow10_table[decimals]),
+                frac_part = (unsigned long)((x - int_part) * scale + 0.5);
+  if (frac_part >= scale) {
+    frac_part -= scale;
+    int_part++;
+  }
+
+  buf = format_ulong(buf, int_part);
+  if (decimals) {
+    *buf++ = '.';
+    char* p = buf += decimals;
+    for (; frac_part > 0xFFFFUL; ) {
+      unsigned long q = frac_part / 10;
+      *--p = DIGIT(frac_part - q * 10);
+      frac_part = q;
+    }
+    for (uint16_t f = frac_part; p > buf - decimals;) {
+      uint16_t q = f / 10;
+      *--p = DIGIT(f - q * 10);
+      f = q;
+    }
+  }
+  *buf = '\0';
+  return buf;
+}
+
+/*********************************/
+/** Number to string conversion **/
+/*********************************/
+
+char conv[8];
+
+// Convert float to rj string with 123 or -12 format
+char *ftostr3(const float& x) { return itostr3((int)x); }
+
+// Convert float to rj string with _123, -123, _-12, or __-1 format
+char *ftostr4sign(const float& x) { return itostr4sign((int)x); }
+
+// Convert unsigned int to string with 12 format
+char* itostr2(const uint8_t& x) {
+  int xx = x;
+  conv[0] = DIGIMOD(xx / 10);
+  conv[1] = DIGIMOD(xx);
+  conv[2] = '\0';
+  return conv;
+}
+
+// Convert float to string with +123.4 / -123.4 format
+char* ftostr41sign(const float& x) {
+  int xx = int(abs(x * 10)) % 10000;
+  conv[0] = x >= 0 ? '+' : '-';
+  conv[1] = DIGIMOD(xx / 1000);
+  conv[2] = DIGIMOD(xx / 100);
+  conv[3] = DIGIMOD(xx / 10);
+  conv[4] = '.';
+  conv[5] = DIGIMOD(xx);
+  conv[6] = '\0';
+  return conv;
+}
+
+// Convert signed float to string with 023.45 / -23.45 format
+char *ftostr32(const float& x) {
+  long xx = abs(x * 100);
+  conv[0] = x >= 0 ? DIGIMOD(xx / 10000) : '-';
+  conv[1] = DIGIMOD(xx / 1000);
+  conv[2] = DIGIMOD(xx / 100);
+  conv[3] = '.';
+  conv[4] = DIGIMOD(xx / 10);
+  conv[5] = DIGIMOD(xx);
+  conv[6] = '\0';
+  return conv;
+}
+
+// Convert signed float to string (6 digit) with -1.234 / _0.000 / +1.234 format
+char* ftostr43sign(const float& x, char plus/*=' '*/) {
+  long xx = x * 1000;
+  if (xx == 0)
+    conv[0] = ' ';
+  else if (xx > 0)
+    conv[0] = plus;
+  else {
+    xx = -xx;
+    conv[0] = '-';
+  }
+  conv[1] = DIGIMOD(xx / 1000);
+  conv[2] = '.';
+  conv[3] = DIGIMOD(xx / 100);
+  conv[4] = DIGIMOD(xx / 10);
+  conv[5] = DIGIMOD(xx);
+  conv[6] = '\0';
+  return conv;
+}
+
+// Convert unsigned float to string with 1.23 format
+char* ftostr12ns(const float& x) {
+  long xx = x * 100;
+  xx = abs(xx);
+  conv[0] = DIGIMOD(xx / 100);
+  conv[1] = '.';
+  conv[2] = DIGIMOD(xx / 10);
+  conv[3] = DIGIMOD(xx);
+  conv[4] = '\0';
+  return conv;
+}
+
+// Convert signed int to lj string with +012 / -012 format
+char* itostr3sign(const int& x) {
+  int xx;
+  if (x >= 0) {
+    conv[0] = '+';
+    xx = x;
+  }
+  else {
+    conv[0] = '-';
+    xx = -x;
+  }
+  conv[1] = DIGIMOD(xx / 100);
+  conv[2] = DIGIMOD(xx / 10);
+  conv[3] = DIGIMOD(xx);
+  conv[4] = '.';
+  conv[5] = '0';
+  conv[6] = '\0';
+  return conv;
+}
+
+// Convert signed int to rj string with 123 or -12 format
+char* itostr3(const int& x) {
+  int xx = x;
+  if (xx < 0) {
+    conv[0] = '-';
+    xx = -xx;
+  }
+  else
+    conv[0] = xx >= 100 ? DIGIMOD(xx / 100) : ' ';
+
+  conv[1] = xx >= 10 ? DIGIMOD(xx / 10) : ' ';
+  conv[2] = DIGIMOD(xx);
+  conv[3] = '\0';
+  return conv;
+}
+
+// Convert unsigned int to lj string with 123 format
+char* itostr3left(const int& xx) {
+  if (xx >= 100) {
+    conv[0] = DIGIMOD(xx / 100);
+    conv[1] = DIGIMOD(xx / 10);
+    conv[2] = DIGIMOD(xx);
+    conv[3] = '\0';
+  }
+  else if (xx >= 10) {
+    conv[0] = DIGIMOD(xx / 10);
+    conv[1] = DIGIMOD(xx);
+    conv[2] = '\0';
+  }
+  else {
+    conv[0] = DIGIMOD(xx);
+    conv[1] = '\0';
+  }
+  return conv;
+}
+
+// Convert signed int to rj string with _123, -123, _-12, or __-1 format
+char *itostr4sign(const int& x) {
+  int xx = abs(x);
+  int sign = 0;
+  if (xx >= 100) {
+    conv[1] = DIGIMOD(xx / 100);
+    conv[2] = DIGIMOD(xx / 10);
+  }
+  else if (xx >= 10) {
+    conv[0] = ' ';
+    sign = 1;
+    conv[2] = DIGIMOD(xx / 10);
+  }
+  else {
+    conv[0] = ' ';
+    conv[1] = ' ';
+    sign = 2;
+  }
+  conv[sign] = x < 0 ? '-' : ' ';
+  conv[3] = DIGIMOD(xx);
+  conv[4] = '\0';
+  return conv;
+}
+
+// Convert unsigned float to rj string with 12345 format
+char* ftostr5rj(const float& x) {
+  long xx = abs(x);
+  conv[0] = xx >= 10000 ? DIGIMOD(xx / 10000) : ' ';
+  conv[1] = xx >= 1000 ? DIGIMOD(xx / 1000) : ' ';
+  conv[2] = xx >= 100 ? DIGIMOD(xx / 100) : ' ';
+  conv[3] = xx >= 10 ? DIGIMOD(xx / 10) : ' ';
+  conv[4] = DIGIMOD(xx);
+  conv[5] = '\0';
+  return conv;
+}
+
+// Convert signed float to string with +1234.5 format
+char* ftostr51sign(const float& x) {
+  long xx = abs(x * 10);
+  conv[0] = (x >= 0) ? '+' : '-';
+  conv[1] = DIGIMOD(xx / 10000);
+  conv[2] = DIGIMOD(xx / 1000);
+  conv[3] = DIGIMOD(xx / 100);
+  conv[4] = DIGIMOD(xx / 10);
+  conv[5] = '.';
+  conv[6] = DIGIMOD(xx);
+  conv[7] = '\0';
+  return conv;
+}
+
+// Convert signed float to string with +123.45 format
+char* ftostr52sign(const float& x) {
+  long xx = abs(x * 100);
+  conv[0] = (x >= 0) ? '+' : '-';
+  conv[1] = DIGIMOD(xx / 10000);
+  conv[2] = DIGIMOD(xx / 1000);
+  conv[3] = DIGIMOD(xx / 100);
+  conv[4] = '.';
+  conv[5] = DIGIMOD(xx / 10);
+  conv[6] = DIGIMOD(xx);
+  conv[7] = '\0';
+  return conv;
+}
+
+// Convert signed float to space-padded string with -_23.4_ format
+char* ftostr52sp(const float& x) {
+  long xx = x * 100;
+  uint8_t dig;
+  if (xx < 0) { // negative val = -_0
+    xx = -xx;
+    conv[0] = '-';
+    dig = (xx / 1000) % 10;
+    conv[1] = dig ? DIGIT(dig) : ' ';
+  }
+  else { // positive val = __0
+    dig = (xx / 10000) % 10;
+    if (dig) {
+      conv[0] = DIGIT(dig);
+      conv[1] = DIGIMOD(xx / 1000);
+    }
+    else {
+      conv[0] = ' ';
+      dig = (xx / 1000) % 10;
+      conv[1] = dig ? DIGIT(dig) : ' ';
+    }
+  }
+
+  conv[2] = DIGIMOD(xx / 100); // lsd always
+
+  dig = xx % 10;
+  if (dig) { // 2 decimal places
+    conv[5] = DIGIT(dig);
+    conv[4] = DIGIMOD(xx / 10);
+    conv[3] = '.';
+  }
+  else { // 1 or 0 decimal place
+    dig = (xx / 10) % 10;
+    if (dig) {
+      conv[4] = DIGIT(dig);
+      conv[3] = '.';
+    }
+    else {
+      conv[3] = conv[4] = ' ';
+    }
+    conv[5] = ' ';
+  }
+  conv[6] = '\0';
+  return conv;
+}
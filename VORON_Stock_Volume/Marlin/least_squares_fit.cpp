@@ -0,0 +1,81 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "Marlin.h"
+
+#if ENABLED(UNIFIED_BED_LEVELING_FEATURE)
+
+#include "least_squares_fit.h"
+
+void incremental_LSF_reset( struct linear_fit_data *lsf ) {
+	memset( lsf, 0, sizeof(struct linear_fit_data) );
+}
+
+void incremental_LSF( struct linear_fit_data *lsf, float x, float y, float z ) {
+	if ( lsf->n == 0 ) {
+		lsf->x0 = x;
+		lsf->y0 = y;
+	}
+	x -= lsf->x0;
+	y -= lsf->y0;
+
+	lsf->sx  += x;
+	lsf->sy  += y;
+	lsf->sz  += z;
+	lsf->sxx += x * x;
+	lsf->syy += y * y;
+	lsf->sxy += x * y;
+	lsf->sxz += x * z;
+	lsf->syz += y * z;
+	lsf->n++;
+}
+
+//
+// With the sums taken about the means, the normal equations for A and B come apart from D and leave a
+// 2x2 system.  D then puts the plane through the mean of the points.  Returns 0 if all went well, and 1
+// if there are too few points or they all lie on one line (so the tilt can't be known).
+//
+
+int finish_incremental_LSF( struct linear_fit_data *lsf ) {
+float n, sxx, syy, sxy, sxz, syz, det;
+
+	if ( lsf->n < 3 )
+		return 1;
+
+	n = lsf->n;
+	sxx = lsf->sxx - lsf->sx * lsf->sx / n;
+	syy = lsf->syy - lsf->sy * lsf->sy / n;
+	sxy = lsf->sxy - lsf->sx * lsf->sy / n;
+	sxz = lsf->sxz - lsf->sx * lsf->sz / n;
+	syz = lsf->syz - lsf->sy * lsf->sz / n;
+
+	det = sxx * syy - sxy * sxy;
+	if ( det <= 1e-4 * sxx * syy )		// The points are (nearly) in a line
+		return 1;
+
+	lsf->A = ( sxz * syy - syz * sxy ) / det;
+	lsf->B = ( syz * sxx - sxz * sxy ) / det;
+	lsf->D = ( lsf->sz - lsf->A * lsf->sx - lsf->B * lsf->sy ) / n - lsf->A * lsf->x0 - lsf->B * lsf->y0;
+	return 0;
+}
+
+#endif  // UNIFIED_BED_LEVELING_FEATURE
@@ -0,0 +1,69 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * pid_float.h - float math of the PID heater loop
+ *
+ * Kept free of the rest of Marlin so test/pid_fixed_point_test.cpp can
+ * check PID_FIXED_POINT against the very loop it replaces. K1 (the
+ * derivative smoothing) comes from the configuration.
+ */
+
+#ifndef PID_FLOAT_H
+#define PID_FLOAT_H
+
+/**
+ * Update the low-pass filtered derivative term from a new temperature
+ * dTerm = K2 * Kd * (T - T_last) + K1 * dTerm
+ */
+inline void pid_float_derivative(float &dTerm, float &last_temp, const float &kd, const float &temp) {
+  dTerm = (1.0 - (K1)) * kd * (temp - last_temp) + (K1) * dTerm;
+  last_temp = temp;
+}
+
+/**
+ * Add the error to the integral, kept within iState_min...iState_max, and
+ * combine the P, I and (already updated) D terms plus an extra feed-forward
+ * term into an output limited to 0...max_output. Conditional un-integration
+ * takes the error back out when it would push a saturated output further.
+ * pTerm and iTerm are set for PID_DEBUG.
+ */
+inline float pid_float_output(float &iState, float &pTerm, float &iTerm, const float &error, const float &dTerm, const float &extra,
+                              const float &kp, const float &ki, const float &iState_min, const float &iState_max, const float &max_output) {
+  pTerm = kp * error;
+  iState += error;
+  iState = iState < iState_min ? iState_min : iState > iState_max ? iState_max : iState;
+  iTerm = ki * iState;
+
+  float output = pTerm + iTerm - dTerm + extra;
+  if (output > max_output) {
+    if (error > 0) iState -= error;
+    output = max_output;
+  }
+  else if (output < 0) {
+    if (error < 0) iState -= error;
+    output = 0;
+  }
+  return output;
+}
+
+#endif // PID_FLOAT_H
@@ -34,8 +34,9 @@
   #include "watchdog.h"
 #endif
 
-#ifdef K1 // Defined in Configuration.h in the PID settings
-  #define K2 (1.0-K1)
+#if ENABLED(MPCTEMP)
+  #define MPC_MAX_MODEL_ERROR 10  // (C) Restart the model if it strays this far from the sensor
+  #define MPC_INITIAL_AMBIENT 30  // (C) Upper bound for the first ambient guess of a warm hotend
 #endif
 
 #if ENABLED(TEMP_SENSOR_1_AS_REDUNDANT)
@@ -86,6 +87,10 @@ unsigned char Temperature::soft_pwm_bed;
   #endif
 #endif
 
+#if ENABLED(MPCTEMP)
+  Temperature::mpc_t Temperature::mpc_constants[HOTENDS];
+#endif
+
 #if ENABLED(PIDTEMPBED)
   float Temperature::bedKp = DEFAULT_bedKp,
         Temperature::bedKi = ((DEFAULT_bedKi) * PID_dT),
@@ -119,35 +124,59 @@ unsigned char Temperature::soft_pwm_bed;
 
 volatile bool Temperature::temp_meas_ready = false;
 
+#if ENABLED(MPCTEMP)
+  Temperature::mpc_state_t Temperature::mpc_state[HOTENDS];
+#endif
+
+#if ENABLED(BED_STABILITY_DETECTION)
+  float Temperature::bed_stability_temps[BED_STABILITY_SAMPLES];
+  uint8_t Temperature::bed_stability_index = 0,
+          Temperature::bed_stability_count = 0;
+  millis_t Temperature::next_bed_stability_ms = 0;
+#endif
+
+#if ENABLED(PID_ADD_EXTRUSION_RATE)
+  long Temperature::last_position[HOTENDS];
+  long Temperature::lpq[LPQ_MAX_LEN];
+  int Temperature::lpq_ptr = 0;
+#endif
+
 #if ENABLED(PIDTEMP)
-  float Temperature::temp_iState[HOTENDS] = { 0 };
-  float Temperature::temp_dState[HOTENDS] = { 0 };
-  float Temperature::pTerm[HOTENDS];
-  float Temperature::iTerm[HOTENDS];
-  float Temperature::dTerm[HOTENDS];
+  #if ENABLED(PID_FIXED_POINT)
+    pid_fp_t Temperature::pid_fp[HOTENDS];
+  #else
+    float Temperature::temp_iState[HOTENDS] = { 0 };
+    float Temperature::temp_dState[HOTENDS] = { 0 };
+    float Temperature::pTerm[HOTENDS];
+    float Temperature::iTerm[HOTENDS];
+    float Temperature::dTerm[HOTENDS];
+  #endif
 
   #if ENABLED(PID_ADD_EXTRUSION_RATE)
     float Temperature::cTerm[HOTENDS];
-    long Temperature::last_position[HOTENDS];
-    long Temperature::lpq[LPQ_MAX_LEN];
-    int Temperature::lpq_ptr = 0;
   #endif
 
-  float Temperature::pid_error[HOTENDS];
-  float Temperature::temp_iState_min[HOTENDS];
-  float Temperature::temp_iState_max[HOTENDS];
+  #if DISABLED(PID_FIXED_POINT)
+    float Temperature::pid_error[HOTENDS];
+    float Temperature::temp_iState_min[HOTENDS];
+    float Temperature::temp_iState_max[HOTENDS];
+  #endif
   bool Temperature::pid_reset[HOTENDS];
 #endif
 
 #if ENABLED(PIDTEMPBED)
-  float Temperature::temp_iState_bed = { 0 };
-  float Temperature::temp_dState_bed = { 0 };
-  float Temperature::pTerm_bed;
-  float Temperature::iTerm_bed;
-  float Temperature::dTerm_bed;
-  float Temperature::pid_error_bed;
-  float Temperature::temp_iState_min_bed;
-  float Temperature::temp_iState_max_bed;
+  #if ENABLED(PID_FIXED_POINT)
+    pid_fp_t Temperature::pid_fp_bed;
+  #else
+    float Temperature::temp_iState_bed = { 0 };
+    float Temperature::temp_dState_bed = { 0 };
+    float Temperature::pTerm_bed;
+    float Temperature::iTerm_bed;
+    float Temperature::dTerm_bed;
+    float Temperature::pid_error_bed;
+    float Temperature::temp_iState_min_bed;
+    float Temperature::temp_iState_max_bed;
+  #endif
 #else
   millis_t Temperature::next_bed_check_ms;
 #endif
@@ -425,6 +454,203 @@ unsigned char Temperature::soft_pwm[HOTENDS];
 
 #endif // HAS_PID_HEATING
 
+#if ENABLED(MPCTEMP)
+
+  #define MPC_AUTOTUNE_SAMPLES 32
+  #define MAX_OVERSHOOT_MPC_AUTOTUNE 20
+
+  /**
+   * Wait for the next temperature sample during MPC autotune. manage_heater
+   * runs every heater as usual, thermal protection included, and then with
+   * a power of 0 or more the hotend is driven at that power instead.
+   * Returns false if the hotend has run past the autotune temperature.
+   */
+  bool Temperature::MPC_autotune_sample(int hotend, int power, millis_t &next_report_ms) {
+    while (!temp_meas_ready) lcd_update();
+
+    manage_heater();
+    if (power >= 0) soft_pwm[hotend] = current_temperature[hotend] < maxttemp[hotend] ? power : 0;
+
+    millis_t ms = millis();
+    if (ELAPSED(ms, next_report_ms)) {
+      print_heaterstates();
+      SERIAL_EOL;
+      next_report_ms = ms + 2000UL;
+    }
+
+    if (current_temperature[hotend] > MPC_AUTOTUNE_TEMP + MAX_OVERSHOOT_MPC_AUTOTUNE) {
+      SERIAL_PROTOCOLLNPGM(MSG_MPC_TEMP_TOO_HIGH);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Identify the thermal model of a hotend (M306 T)
+   *
+   *  1. With the part fan on, let the hotend cool until it stops falling and
+   *     take that as the ambient temperature.
+   *  2. Heat at full power with the fan off, logging the temperature. Three
+   *     equally spaced points on the second part of the curve give the time
+   *     constant and final temperature of the block, hence its losses and heat
+   *     capacity. How late the fitted curve starts gives the sensor lag.
+   *  3. Hold MPC_AUTOTUNE_TEMP with the new model and average the power it
+   *     takes, with the fan off and then at full speed, for the ambient losses.
+   *
+   * Temperature alone can't tell heater power from heat capacity, so the
+   * configured heater power (or M306 P) is taken as given.
+   *
+   * manage_heater keeps running throughout, so thermal runaway protection
+   * watches the hotend heat. Cooling and heating give up after 10 minutes.
+   */
+  void Temperature::MPC_autotune(int hotend) {
+    mpc_t &constants = mpc_constants[hotend];
+    mpc_state_t &state = mpc_state[hotend];
+    millis_t report_ms = millis();
+
+    #if FAN_COUNT > 0
+      int old_fan_speed = fanSpeeds[0];
+      #define _MPC_SET_FAN(S) do{ fanSpeeds[0] = S; planner.check_axes_activity(); }while(0)
+    #else
+      #define _MPC_SET_FAN(S) NOOP
+    #endif
+
+    #define _MPC_AUTOTUNE_ABORT() do{ \
+        setTargetHotend(0, hotend); \
+        disable_all_heaters(); \
+        _MPC_SET_FAN(old_fan_speed); \
+        return; \
+      }while(0)
+
+    SERIAL_ECHOLNPGM(MSG_MPC_AUTOTUNE_START);
+
+    disable_all_heaters(); // switch off all heaters.
+
+    // Cool to ambient
+    SERIAL_ECHOLNPGM(MSG_MPC_COOLING_TO_AMBIENT);
+    _MPC_SET_FAN(255);
+    if (!MPC_autotune_sample(hotend, -1, report_ms)) _MPC_AUTOTUNE_ABORT();
+    float ambient_temp = current_temperature[hotend];
+    millis_t cool_start_ms = millis(), next_test_ms = cool_start_ms + 10000UL;
+    for (;;) {
+      if (!MPC_autotune_sample(hotend, -1, report_ms)) _MPC_AUTOTUNE_ABORT();
+      millis_t ms = millis();
+      if (ELAPSED(ms, next_test_ms)) {
+        if (ambient_temp - current_temperature[hotend] < 0.5) break;
+        ambient_temp = current_temperature[hotend];
+        next_test_ms = ms + 10000UL;
+      }
+      if (ELAPSED(ms, cool_start_ms + 10L * 60L * 1000L)) {
+        SERIAL_PROTOCOLLNPGM(MSG_MPC_TIMEOUT);
+        _MPC_AUTOTUNE_ABORT();
+      }
+    }
+    ambient_temp = current_temperature[hotend];
+
+    // Heat at full power, keeping up to MPC_AUTOTUNE_SAMPLES evenly spaced readings.
+    // When the log fills up every other reading is dropped and the spacing doubles.
+    SERIAL_ECHOLNPGM(MSG_MPC_HEATING);
+    _MPC_SET_FAN(0);
+    float heating_power = constants.heater_power * ((PID_MAX) >> 1) / 127.0,
+          temp_samples[MPC_AUTOTUNE_SAMPLES];
+    int sample_count = 0;
+    millis_t sample_interval = 1000UL,
+             heat_start_ms = millis(),
+             next_sample_ms = heat_start_ms;
+    setTargetHotend(MPC_AUTOTUNE_TEMP, hotend); // Only so thermal protection watches it heat
+    for (;;) {
+      if (!MPC_autotune_sample(hotend, (PID_MAX) >> 1, report_ms)) _MPC_AUTOTUNE_ABORT();
+      millis_t ms = millis();
+      if (ELAPSED(ms, next_sample_ms)) {
+        if (sample_count == MPC_AUTOTUNE_SAMPLES) {
+          for (int i = 0; i < MPC_AUTOTUNE_SAMPLES / 2; i++) temp_samples[i] = temp_samples[i * 2];
+          sample_count = MPC_AUTOTUNE_SAMPLES / 2;
+          sample_interval *= 2;
+        }
+        temp_samples[sample_count++] = current_temperature[hotend];
+        next_sample_ms = heat_start_ms + sample_count * sample_interval;
+      }
+      if (current_temperature[hotend] >= MPC_AUTOTUNE_TEMP) break;
+      if (ELAPSED(ms, heat_start_ms + 10L * 60L * 1000L)) {
+        SERIAL_PROTOCOLLNPGM(MSG_MPC_TIMEOUT);
+        _MPC_AUTOTUNE_ABORT();
+      }
+    }
+    soft_pwm[hotend] = 0;
+
+    // Fit T(t) = A - (A - ambient) * exp(-(t - t0) / tau) through three points
+    int step = (sample_count - 1) / 3,
+        i1 = sample_count - 1 - 2 * step;
+    float t1 = temp_samples[i1], t2 = temp_samples[i1 + step], t3 = temp_samples[i1 + 2 * step],
+          dt = step * sample_interval / 1000.0,
+          r = (t3 - t2) / (t2 - t1);
+    if (step < 2 || !(r > 0 && r < 1)) {
+      SERIAL_PROTOCOLLNPGM(MSG_MPC_AUTOTUNE_FAILED);
+      _MPC_AUTOTUNE_ABORT();
+    }
+    float tau = -dt / log(r),
+          asymp_temp = t1 + (t2 - t1) / (1 - r),
+          t0 = i1 * sample_interval / 1000.0 - tau * log((asymp_temp - ambient_temp) / (asymp_temp - t1));
+    constants.ambient_xfer_coeff_fan0 = heating_power / (asymp_temp - ambient_temp);
+    constants.block_heat_capacity = tau * constants.ambient_xfer_coeff_fan0;
+    if (t0 > 0) constants.sensor_responsiveness = 1.0 / t0;
+
+    // Hold the temperature with the new model and measure the power it needs
+    SERIAL_ECHOLNPGM(MSG_MPC_MEASURING_AMBIENT);
+    state.block_temp = state.sensor_temp = current_temperature[hotend];
+    state.ambient_temp = ambient_temp;
+    state.last_power = 0;
+    state.initialized = true;
+    setTargetHotend(MPC_AUTOTUNE_TEMP, hotend);
+
+    float xfer_coeff[2];
+    for (int pass = 0; pass < (FAN_COUNT > 0 ? 2 : 1); pass++) {
+      _MPC_SET_FAN(pass ? 255 : 0);
+      millis_t settle_ms = millis() + 30000UL, end_ms = settle_ms + 60000UL;
+      float total_power = 0, total_temp = 0;
+      long count = 0;
+      for (;;) {
+        if (!MPC_autotune_sample(hotend, -1, report_ms)) _MPC_AUTOTUNE_ABORT();
+        millis_t ms = millis();
+        if (ELAPSED(ms, end_ms)) break;
+        if (ELAPSED(ms, settle_ms)) {
+          total_power += state.last_power;
+          total_temp += current_temperature[hotend];
+          count++;
+        }
+      }
+      xfer_coeff[pass] = total_power / (total_temp - count * ambient_temp);
+    }
+    constants.ambient_xfer_coeff_fan0 = xfer_coeff[0];
+    #if FAN_COUNT > 0
+      constants.fan255_adjustment = xfer_coeff[1] - xfer_coeff[0];
+    #endif
+
+    setTargetHotend(0, hotend);
+    disable_all_heaters();
+    _MPC_SET_FAN(old_fan_speed);
+
+    SERIAL_PROTOCOLLNPGM(MSG_MPC_AUTOTUNE_FINISHED);
+    MPC_report(hotend);
+  }
+
+  /**
+   * Print the model of a hotend as an M306 command
+   */
+  void Temperature::MPC_report(int hotend) {
+    mpc_t &constants = mpc_constants[hotend];
+    SERIAL_ECHOPAIR("  M306 E", hotend);
+    SERIAL_ECHOPAIR(" P", constants.heater_power);
+    SERIAL_ECHOPAIR(" C", constants.block_heat_capacity);
+    SERIAL_ECHOPGM(" R"); SERIAL_ECHO_F(constants.sensor_responsiveness, 4);
+    SERIAL_ECHOPGM(" A"); SERIAL_ECHO_F(constants.ambient_xfer_coeff_fan0, 4);
+    SERIAL_ECHOPGM(" F"); SERIAL_ECHO_F(constants.ambient_xfer_coeff_fan0 + constants.fan255_adjustment, 4);
+    SERIAL_ECHOPGM(" H"); SERIAL_ECHO_F(constants.filament_heat_capacity_permm, 5);
+    SERIAL_EOL;
+  }
+
+#endif // MPCTEMP
+
 /**
  * Class and Instance Methods
  */
@@ -434,14 +660,22 @@ Temperature::Temperature() { }
 void Temperature::updatePID() {
   #if ENABLED(PIDTEMP)
     for (int e = 0; e < HOTENDS; e++) {
-      temp_iState_max[e] = (PID_INTEGRAL_DRIVE_MAX) / PID_PARAM(Ki, e);
+      #if ENABLED(PID_FIXED_POINT)
+        pid_fp_set_gains(pid_fp[e], PID_PARAM(Kp, e), PID_PARAM(Ki, e), PID_PARAM(Kd, e));
+      #else
+        temp_iState_max[e] = (PID_INTEGRAL_DRIVE_MAX) / PID_PARAM(Ki, e);
+      #endif
       #if ENABLED(PID_ADD_EXTRUSION_RATE)
         last_position[e] = 0;
       #endif
     }
   #endif
   #if ENABLED(PIDTEMPBED)
-    temp_iState_max_bed = (PID_BED_INTEGRAL_DRIVE_MAX) / bedKi;
+    #if ENABLED(PID_FIXED_POINT)
+      pid_fp_set_gains(pid_fp_bed, bedKp, bedKi, bedKd);
+    #else
+      temp_iState_max_bed = (PID_BED_INTEGRAL_DRIVE_MAX) / bedKi;
+    #endif
   #endif
 }
 
@@ -510,13 +744,75 @@ void Temperature::min_temp_error(uint8_t e) {
   _temp_error(e, PSTR(MSG_T_MINTEMP), PSTR(MSG_ERR_MINTEMP));
 }
 
+#if ENABLED(SINGLENOZZLE)
+  #define _NOZZLE_TEST     true
+  #define _NOZZLE_EXTRUDER active_extruder
+  #define _CTERM_INDEX     0
+#else
+  #define _NOZZLE_TEST     e == active_extruder
+  #define _NOZZLE_EXTRUDER e
+  #define _CTERM_INDEX     e
+#endif
+
+#if ENABLED(PID_ADD_EXTRUSION_RATE)
+  /**
+   * Push the E steps moved since the last temperature sample into the
+   * extrusion queue and return them. lpq[lpq_ptr] is then the oldest entry.
+   */
+  long Temperature::lpq_extruded_steps(int e) {
+    long e_position = stepper.position(E_AXIS), steps = 0;
+    if (e_position > last_position[e]) {
+      steps = e_position - last_position[e];
+      last_position[e] = e_position;
+    }
+    lpq[lpq_ptr++] = steps;
+    if (lpq_ptr >= lpq_len) lpq_ptr = 0;
+    return steps;
+  }
+#endif
+
 float Temperature::get_pid_output(int e) {
   float pid_output;
-  #if ENABLED(PIDTEMP)
-    #if DISABLED(PID_OPENLOOP)
+  #if ENABLED(MPCTEMP)
+    pid_output = get_mpc_output(e);
+  #elif ENABLED(PIDTEMP)
+    #if ENABLED(PID_OPENLOOP)
+      pid_output = constrain(target_temperature[e], 0, PID_MAX);
+    #elif ENABLED(PID_FIXED_POINT)
+      pid_fp_t &pid = pid_fp[e];
+      long temp_fp = current_temperature[e] * PID_FP_ONE,
+           error_fp = ((long)target_temperature[e] << (PID_FP_SHIFT)) - temp_fp;
+      pid_fp_derivative(pid, temp_fp);
+      if (error_fp > (PID_FUNCTIONAL_RANGE) * PID_FP_ONE) {
+        pid_output = BANG_MAX;
+        pid_reset[e] = true;
+      }
+      else if (error_fp < -(PID_FUNCTIONAL_RANGE) * PID_FP_ONE || target_temperature[e] == 0) {
+        pid_output = 0;
+        pid_reset[e] = true;
+      }
+      else {
+        if (pid_reset[e]) {
+          pid.iTerm = 0;
+          pid_reset[e] = false;
+        }
+        long extra_fp = 0;
+        #if ENABLED(PID_ADD_EXTRUSION_RATE)
+          cTerm[_CTERM_INDEX] = 0;
+          if (_NOZZLE_TEST) {
+            lpq_extruded_steps(_NOZZLE_EXTRUDER);
+            // Only pay for the float conversion while actually extruding
+            if (lpq[lpq_ptr]) {
+              cTerm[_CTERM_INDEX] = (lpq[lpq_ptr] / planner.axis_steps_per_mm[E_AXIS]) * PID_PARAM(Kc, e);
+              extra_fp = cTerm[_CTERM_INDEX] * PID_FP_ONE;
+            }
+          }
+        #endif //PID_ADD_EXTRUSION_RATE
+        pid_output = pid_fp_output(pid, error_fp, extra_fp, (long)(PID_MAX) << (PID_FP_SHIFT), (long)(PID_INTEGRAL_DRIVE_MAX) << (PID_FP_SHIFT * 2)) >> (PID_FP_SHIFT);
+      }
+    #else
       pid_error[e] = target_temperature[e] - current_temperature[e];
-      dTerm[e] = K2 * PID_PARAM(Kd, e) * (current_temperature[e] - temp_dState[e]) + K1 * dTerm[e];
-      temp_dState[e] = current_temperature[e];
+      pid_float_derivative(dTerm[e], temp_dState[e], PID_PARAM(Kd, e), current_temperature[e]);
       if (pid_error[e] > PID_FUNCTIONAL_RANGE) {
         pid_output = BANG_MAX;
         pid_reset[e] = true;
@@ -530,51 +826,19 @@ float Temperature::get_pid_output(int e) {
           temp_iState[e] = 0.0;
           pid_reset[e] = false;
         }
-        pTerm[e] = PID_PARAM(Kp, e) * pid_error[e];
-        temp_iState[e] += pid_error[e];
-        temp_iState[e] = constrain(temp_iState[e], temp_iState_min[e], temp_iState_max[e]);
-        iTerm[e] = PID_PARAM(Ki, e) * temp_iState[e];
-
-        pid_output = pTerm[e] + iTerm[e] - dTerm[e];
-
-        #if ENABLED(SINGLENOZZLE)
-          #define _NOZZLE_TEST     true
-          #define _NOZZLE_EXTRUDER active_extruder
-          #define _CTERM_INDEX     0
-        #else
-          #define _NOZZLE_TEST     e == active_extruder
-          #define _NOZZLE_EXTRUDER e
-          #define _CTERM_INDEX     e
-        #endif
-
+        float extra = 0;
         #if ENABLED(PID_ADD_EXTRUSION_RATE)
           cTerm[_CTERM_INDEX] = 0;
           if (_NOZZLE_TEST) {
-            long e_position = stepper.position(E_AXIS);
-            if (e_position > last_position[_NOZZLE_EXTRUDER]) {
-              lpq[lpq_ptr++] = e_position - last_position[_NOZZLE_EXTRUDER];
-              last_position[_NOZZLE_EXTRUDER] = e_position;
-            }
-            else {
-              lpq[lpq_ptr++] = 0;
-            }
-            if (lpq_ptr >= lpq_len) lpq_ptr = 0;
+            lpq_extruded_steps(_NOZZLE_EXTRUDER);
             cTerm[_CTERM_INDEX] = (lpq[lpq_ptr] / planner.axis_steps_per_mm[E_AXIS]) * PID_PARAM(Kc, e);
-            pid_output += cTerm[e];
+            extra = cTerm[e];
           }
         #endif //PID_ADD_EXTRUSION_RATE
 
-        if (pid_output > PID_MAX) {
-          if (pid_error[e] > 0) temp_iState[e] -= pid_error[e]; // conditional un-integration
-          pid_output = PID_MAX;
-        }
-        else if (pid_output < 0) {
-          if (pid_error[e] < 0) temp_iState[e] -= pid_error[e]; // conditional un-integration
-          pid_output = 0;
-        }
+        pid_output = pid_float_output(temp_iState[e], pTerm[e], iTerm[e], pid_error[e], dTerm[e], extra,
+                                      PID_PARAM(Kp, e), PID_PARAM(Ki, e), temp_iState_min[e], temp_iState_max[e], PID_MAX);
       }
-    #else
-      pid_output = constrain(target_temperature[e], 0, PID_MAX);
     #endif //PID_OPENLOOP
 
     #if ENABLED(PID_DEBUG)
@@ -582,9 +846,14 @@ float Temperature::get_pid_output(int e) {
       SERIAL_ECHOPAIR(MSG_PID_DEBUG, e);
       SERIAL_ECHOPAIR(MSG_PID_DEBUG_INPUT, current_temperature[e]);
       SERIAL_ECHOPAIR(MSG_PID_DEBUG_OUTPUT, pid_output);
-      SERIAL_ECHOPAIR(MSG_PID_DEBUG_PTERM, pTerm[e]);
-      SERIAL_ECHOPAIR(MSG_PID_DEBUG_ITERM, iTerm[e]);
-      SERIAL_ECHOPAIR(MSG_PID_DEBUG_DTERM, dTerm[e]);
+      #if ENABLED(PID_FIXED_POINT)
+        SERIAL_ECHOPAIR(MSG_PID_DEBUG_ITERM, pid_fp[e].iTerm / float(PID_FP_ONE * PID_FP_ONE));
+        SERIAL_ECHOPAIR(MSG_PID_DEBUG_DTERM, pid_fp[e].dTerm / float(PID_FP_ONE));
+      #else
+        SERIAL_ECHOPAIR(MSG_PID_DEBUG_PTERM, pTerm[e]);
+        SERIAL_ECHOPAIR(MSG_PID_DEBUG_ITERM, iTerm[e]);
+        SERIAL_ECHOPAIR(MSG_PID_DEBUG_DTERM, dTerm[e]);
+      #endif
       #if ENABLED(PID_ADD_EXTRUSION_RATE)
         SERIAL_ECHOPAIR(MSG_PID_DEBUG_CTERM, cTerm[e]);
       #endif
@@ -598,30 +867,95 @@ float Temperature::get_pid_output(int e) {
   return pid_output;
 }
 
+#if ENABLED(MPCTEMP)
+
+  /**
+   * Model predictive control of a hotend
+   *
+   * The hotend is modelled as a heater block and a sensor that lags behind it.
+   * Each sample the block is advanced by the power applied over the last period,
+   * less what it loses to ambient (more with the part fan on and while filament
+   * is pushed through), and the sensor is moved towards the block. The model is
+   * then pulled towards the real reading so small modelling errors don't build up.
+   *
+   * The output is the power that brings the modelled block to the target within
+   * one period, plus the power it will lose once it's there.
+   */
+  float Temperature::get_mpc_output(int e) {
+    mpc_t &constants = mpc_constants[e];
+    mpc_state_t &state = mpc_state[e];
+    float ct = current_temperature[e];
+
+    // (Re)start the model from the reading on the first sample or if it has lost track
+    if (!state.initialized || fabs(state.sensor_temp - ct) > MPC_MAX_MODEL_ERROR) {
+      state.block_temp = state.sensor_temp = ct;
+      if (!state.initialized) state.ambient_temp = min(ct, MPC_INITIAL_AMBIENT);
+      state.initialized = true;
+    }
+
+    // Heat lost per degree above ambient, including the part fan and the filament
+    float ambient_xfer_coeff = constants.ambient_xfer_coeff_fan0;
+    #if FAN_COUNT > 0
+      ambient_xfer_coeff += fanSpeeds[0] * constants.fan255_adjustment / 255.0;
+    #endif
+    #if ENABLED(PID_ADD_EXTRUSION_RATE)
+      if (_NOZZLE_TEST) {
+        long steps = lpq_extruded_steps(_NOZZLE_EXTRUDER);
+        if (steps) ambient_xfer_coeff += steps / (planner.axis_steps_per_mm[E_AXIS] * (PID_dT)) * constants.filament_heat_capacity_permm;
+      }
+    #endif
+
+    // Advance the model by one sample period
+    state.block_temp += (state.last_power - (state.block_temp - state.ambient_temp) * ambient_xfer_coeff) * (PID_dT) / constants.block_heat_capacity;
+    state.sensor_temp += (state.block_temp - state.sensor_temp) * constants.sensor_responsiveness * (PID_dT);
+
+    // Pull the model towards the reading
+    static const float smoothing = 1.0 - pow(1.0 - (MPC_SMOOTHING_FACTOR), PID_dT);
+    float delta = (ct - state.sensor_temp) * smoothing;
+    state.sensor_temp += delta;
+    state.block_temp += delta;
+
+    // While the heater is neither off nor saturated the remaining error is a wrong
+    // estimate of the losses, so fold it into the ambient temperature.
+    float max_power = constants.heater_power * ((PID_MAX) >> 1) / 127.0;
+    if (state.last_power > 0 && state.last_power < max_power)
+      state.ambient_temp += delta;
+
+    float power = 0;
+    if (target_temperature[e])
+      power = (target_temperature[e] - state.block_temp) * constants.block_heat_capacity / (PID_dT)
+            + (target_temperature[e] - state.ambient_temp) * ambient_xfer_coeff;
+    state.last_power = constrain(power, 0, max_power);
+
+    #if ENABLED(PID_DEBUG)
+      SERIAL_ECHO_START;
+      SERIAL_ECHOPAIR(MSG_PID_DEBUG, e);
+      SERIAL_ECHOPAIR(MSG_PID_DEBUG_INPUT, ct);
+      SERIAL_ECHOPAIR(MSG_MPC_DEBUG_BLOCK, state.block_temp);
+      SERIAL_ECHOPAIR(MSG_MPC_DEBUG_AMBIENT, state.ambient_temp);
+      SERIAL_ECHOPAIR(MSG_MPC_DEBUG_POWER, state.last_power);
+      SERIAL_EOL;
+    #endif
+
+    return state.last_power * 255.0 / constants.heater_power;
+  }
+
+#endif // MPCTEMP
+
 #if ENABLED(PIDTEMPBED)
   float Temperature::get_pid_output_bed() {
     float pid_output;
-    #if DISABLED(PID_OPENLOOP)
-      pid_error_bed = target_temperature_bed - current_temperature_bed;
-      pTerm_bed = bedKp * pid_error_bed;
-      temp_iState_bed += pid_error_bed;
-      temp_iState_bed = constrain(temp_iState_bed, temp_iState_min_bed, temp_iState_max_bed);
-      iTerm_bed = bedKi * temp_iState_bed;
-
-      dTerm_bed = K2 * bedKd * (current_temperature_bed - temp_dState_bed) + K1 * dTerm_bed;
-      temp_dState_bed = current_temperature_bed;
-
-      pid_output = pTerm_bed + iTerm_bed - dTerm_bed;
-      if (pid_output > MAX_BED_POWER) {
-        if (pid_error_bed > 0) temp_iState_bed -= pid_error_bed; // conditional un-integration
-        pid_output = MAX_BED_POWER;
-      }
-      else if (pid_output < 0) {
-        if (pid_error_bed < 0) temp_iState_bed -= pid_error_bed; // conditional un-integration
-        pid_output = 0;
-      }
-    #else
+    #if ENABLED(PID_OPENLOOP)
       pid_output = constrain(target_temperature_bed, 0, MAX_BED_POWER);
+    #elif ENABLED(PID_FIXED_POINT)
+      long temp_fp = current_temperature_bed * PID_FP_ONE;
+      pid_fp_derivative(pid_fp_bed, temp_fp);
+      pid_output = pid_fp_output(pid_fp_bed, ((long)target_temperature_bed << (PID_FP_SHIFT)) - temp_fp, 0, (long)(MAX_BED_POWER) << (PID_FP_SHIFT), (long)(PID_BED_INTEGRAL_DRIVE_MAX) << (PID_FP_SHIFT * 2)) >> (PID_FP_SHIFT);
+    #else
+      pid_error_bed = target_temperature_bed - current_temperature_bed;
+      pid_float_derivative(dTerm_bed, temp_dState_bed, bedKd, current_temperature_bed);
+      pid_output = pid_float_output(temp_iState_bed, pTerm_bed, iTerm_bed, pid_error_bed, dTerm_bed, 0,
+                                    bedKp, bedKi, temp_iState_min_bed, temp_iState_max_bed, MAX_BED_POWER);
     #endif // PID_OPENLOOP
 
     #if ENABLED(PID_BED_DEBUG)
@@ -631,12 +965,19 @@ float Temperature::get_pid_output(int e) {
       SERIAL_ECHO(current_temperature_bed);
       SERIAL_ECHOPGM(" Output ");
       SERIAL_ECHO(pid_output);
-      SERIAL_ECHOPGM(" pTerm ");
-      SERIAL_ECHO(pTerm_bed);
-      SERIAL_ECHOPGM(" iTerm ");
-      SERIAL_ECHO(iTerm_bed);
-      SERIAL_ECHOPGM(" dTerm ");
-      SERIAL_ECHOLN(dTerm_bed);
+      #if ENABLED(PID_FIXED_POINT)
+        SERIAL_ECHOPGM(" iTerm ");
+        SERIAL_ECHO(pid_fp_bed.iTerm / float(PID_FP_ONE * PID_FP_ONE));
+        SERIAL_ECHOPGM(" dTerm ");
+        SERIAL_ECHOLN(pid_fp_bed.dTerm / float(PID_FP_ONE));
+      #else
+        SERIAL_ECHOPGM(" pTerm ");
+        SERIAL_ECHO(pTerm_bed);
+        SERIAL_ECHOPGM(" iTerm ");
+        SERIAL_ECHO(iTerm_bed);
+        SERIAL_ECHOPGM(" dTerm ");
+        SERIAL_ECHOLN(dTerm_bed);
+      #endif
     #endif //PID_BED_DEBUG
 
     return pid_output;
@@ -664,7 +1005,7 @@ void Temperature::manage_heater() {
     if (ct < max(HEATER_0_MINTEMP, 0.01)) min_temp_error(0);
   #endif
 
-  #if (ENABLED(THERMAL_PROTECTION_HOTENDS) && WATCH_TEMP_PERIOD > 0) || (ENABLED(THERMAL_PROTECTION_BED) && WATCH_BED_TEMP_PERIOD > 0) || DISABLED(PIDTEMPBED) || HAS_AUTO_FAN
+  #if (ENABLED(THERMAL_PROTECTION_HOTENDS) && WATCH_TEMP_PERIOD > 0) || (ENABLED(THERMAL_PROTECTION_BED) && WATCH_BED_TEMP_PERIOD > 0) || DISABLED(PIDTEMPBED) || HAS_AUTO_FAN || ENABLED(BED_STABILITY_DETECTION)
     millis_t ms = millis();
   #endif
 
@@ -746,6 +1087,15 @@ void Temperature::manage_heater() {
     }
   #endif //FILAMENT_WIDTH_SENSOR
 
+  #if ENABLED(BED_STABILITY_DETECTION)
+    if (ELAPSED(ms, next_bed_stability_ms)) {
+      next_bed_stability_ms = ms + BED_STABILITY_INTERVAL;
+      bed_stability_temps[bed_stability_index] = current_temperature_bed;
+      if (++bed_stability_index >= BED_STABILITY_SAMPLES) bed_stability_index = 0;
+      if (bed_stability_count < BED_STABILITY_SAMPLES) bed_stability_count++;
+    }
+  #endif
+
   #if DISABLED(PIDTEMPBED)
     if (PENDING(ms, next_bed_check_ms)) return;
     next_bed_check_ms = ms + BED_CHECK_INTERVAL;
@@ -789,6 +1139,60 @@ void Temperature::manage_heater() {
 
 #define PGM_RD_W(x)   (short)pgm_read_word(&x)
 
+#if ENABLED(BED_STABILITY_DETECTION)
+
+  /**
+   * Least squares line through 'count' bed readings starting 'first'
+   * readings after the oldest. Gives the slope in degrees per minute and
+   * the spread of the readings around the line.
+   */
+  bool Temperature::bed_stability_fit(uint8_t first, uint8_t count, float &slope, float &stddev) {
+    if (bed_stability_count < BED_STABILITY_SAMPLES || count < 3) return false;
+
+    uint8_t oldest = bed_stability_index + first;
+    float mean_x = (count - 1) * 0.5, mean_y = 0, sxx = 0, sxy = 0, syy = 0;
+    for (uint8_t i = 0; i < count; i++)
+      mean_y += bed_stability_temps[(oldest + i) % (BED_STABILITY_SAMPLES)];
+    mean_y /= count;
+    for (uint8_t i = 0; i < count; i++) {
+      float dx = i - mean_x, dy = bed_stability_temps[(oldest + i) % (BED_STABILITY_SAMPLES)] - mean_y;
+      sxx += dx * dx;
+      sxy += dx * dy;
+      syy += dy * dy;
+    }
+    float b = sxy / sxx;
+    slope = b * (60000.0 / (BED_STABILITY_INTERVAL));
+    stddev = sqrt(max(syy - b * sxy, 0) / (count - 2));
+    return true;
+  }
+
+  bool Temperature::bedIsStable() {
+    float slope, stddev;
+    return bed_stability_fit(0, BED_STABILITY_SAMPLES, slope, stddev)
+      && fabs(slope) <= BED_STABILITY_MAX_SLOPE && stddev <= BED_STABILITY_MAX_STDDEV;
+  }
+
+  /**
+   * The drift of a bed settling on its target dies away exponentially.
+   * Compare the slopes of the two halves of the window to get the time
+   * constant and from that the time left until the slope is small enough.
+   */
+  long Temperature::bedStableRemainingSeconds() {
+    if (bedIsStable()) return 0;
+    float s1, s2, sd;
+    if (!bed_stability_fit(0, BED_STABILITY_SAMPLES / 2, s1, sd)
+      || !bed_stability_fit(BED_STABILITY_SAMPLES / 2, BED_STABILITY_SAMPLES / 2, s2, sd)) return -1;
+    float ratio = s2 / s1;
+    if (!(ratio > 0 && ratio < 1)) return -1;
+    if (fabs(s2) <= BED_STABILITY_MAX_SLOPE) return 1; // Slope is there, the scatter isn't yet
+    // s2 is the slope a quarter of the window ago
+    float tau = (BED_STABILITY_SAMPLES / 2) * (BED_STABILITY_INTERVAL) / 1000.0 / -log(ratio),
+          remaining = tau * log(fabs(s2) / (BED_STABILITY_MAX_SLOPE)) - (BED_STABILITY_SAMPLES / 4) * (BED_STABILITY_INTERVAL) / 1000.0;
+    return max(remaining, 0) + 1;
+  }
+
+#endif // BED_STABILITY_DETECTION
+
 // Derived from RepRap FiveD extruder::getTemperature()
 // For hot end temperature measurement.
 float Temperature::analog2temp(int raw, uint8_t e) {
@@ -933,19 +1337,23 @@ void Temperature::init() {
   for (int e = 0; e < HOTENDS; e++) {
     // populate with the first value
     maxttemp[e] = maxttemp[0];
-    #if ENABLED(PIDTEMP)
+    #if ENABLED(PIDTEMP) && DISABLED(PID_FIXED_POINT)
       temp_iState_min[e] = 0.0;
       temp_iState_max[e] = (PID_INTEGRAL_DRIVE_MAX) / PID_PARAM(Ki, e);
-      #if ENABLED(PID_ADD_EXTRUSION_RATE)
-        last_position[e] = 0;
-      #endif
     #endif //PIDTEMP
-    #if ENABLED(PIDTEMPBED)
+    #if ENABLED(PID_ADD_EXTRUSION_RATE)
+      last_position[e] = 0;
+    #endif
+    #if ENABLED(PIDTEMPBED) && DISABLED(PID_FIXED_POINT)
       temp_iState_min_bed = 0.0;
       temp_iState_max_bed = (PID_BED_INTEGRAL_DRIVE_MAX) / bedKi;
     #endif //PIDTEMPBED
   }
 
+  #if ENABLED(PID_FIXED_POINT)
+    updatePID(); // Derive the fixed-point gains
+  #endif
+
   #if HAS_HEATER_0
     SET_OUTPUT(HEATER_0_PIN);
   #endif
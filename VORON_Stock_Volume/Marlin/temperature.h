@@ -34,6 +34,12 @@
   #include "stepper.h"
 #endif
 
+#if ENABLED(PID_FIXED_POINT)
+  #include "pid_fixed_point.h"
+#elif HAS_PID_HEATING
+  #include "pid_float.h"
+#endif
+
 #ifndef SOFT_PWM_SCALE
   #define SOFT_PWM_SCALE 0
 #endif
@@ -60,10 +66,28 @@ class Temperature {
       static unsigned char fanSpeedSoftPwm[FAN_COUNT];
     #endif
 
-    #if ENABLED(PIDTEMP) || ENABLED(PIDTEMPBED)
+    #if ENABLED(PIDTEMP) || ENABLED(PIDTEMPBED) || ENABLED(MPCTEMP)
       #define PID_dT ((OVERSAMPLENR * 12.0)/(F_CPU / 64.0 / 256.0))
     #endif
 
+    #if ENABLED(MPCTEMP)
+
+      /**
+       * Thermal model of a hotend, used by the model predictive controller
+       */
+      typedef struct {
+        float heater_power;                 // (W) Heater power at full PWM
+        float block_heat_capacity;          // (J/K) Heat capacity of the heater block
+        float sensor_responsiveness;        // (1/s) Rate at which the sensor follows the block
+        float ambient_xfer_coeff_fan0;      // (W/K) Heat loss to ambient with the part fan off
+        float fan255_adjustment;            // (W/K) Extra heat loss with the part fan at full speed
+        float filament_heat_capacity_permm; // (J/K/mm) Heat taken away by each mm of filament
+      } mpc_t;
+
+      static mpc_t mpc_constants[HOTENDS];
+
+    #endif
+
     #if ENABLED(PIDTEMP)
 
       #if ENABLED(PID_PARAMS_PER_HOTEND)
@@ -126,35 +150,58 @@ class Temperature {
 
     static volatile bool temp_meas_ready;
 
+    #if ENABLED(MPCTEMP)
+      typedef struct {
+        float block_temp, sensor_temp, ambient_temp; // (°C) Modelled temperatures
+        float last_power;                            // (W) Power applied since the last sample
+        bool initialized;
+      } mpc_state_t;
+
+      static mpc_state_t mpc_state[HOTENDS];
+    #endif
+
+    #if ENABLED(PID_ADD_EXTRUSION_RATE)
+      static long last_position[HOTENDS];
+      static long lpq[LPQ_MAX_LEN];
+      static int lpq_ptr;
+    #endif
+
     #if ENABLED(PIDTEMP)
-      static float temp_iState[HOTENDS];
-      static float temp_dState[HOTENDS];
-      static float pTerm[HOTENDS];
-      static float iTerm[HOTENDS];
-      static float dTerm[HOTENDS];
+      #if ENABLED(PID_FIXED_POINT)
+        static pid_fp_t pid_fp[HOTENDS];
+      #else
+        static float temp_iState[HOTENDS];
+        static float temp_dState[HOTENDS];
+        static float pTerm[HOTENDS];
+        static float iTerm[HOTENDS];
+        static float dTerm[HOTENDS];
+      #endif
 
       #if ENABLED(PID_ADD_EXTRUSION_RATE)
         static float cTerm[HOTENDS];
-        static long last_position[HOTENDS];
-        static long lpq[LPQ_MAX_LEN];
-        static int lpq_ptr;
       #endif
 
-      static float pid_error[HOTENDS];
-      static float temp_iState_min[HOTENDS];
-      static float temp_iState_max[HOTENDS];
+      #if DISABLED(PID_FIXED_POINT)
+        static float pid_error[HOTENDS];
+        static float temp_iState_min[HOTENDS];
+        static float temp_iState_max[HOTENDS];
+      #endif
       static bool pid_reset[HOTENDS];
     #endif
 
     #if ENABLED(PIDTEMPBED)
-      static float temp_iState_bed;
-      static float temp_dState_bed;
-      static float pTerm_bed;
-      static float iTerm_bed;
-      static float dTerm_bed;
-      static float pid_error_bed;
-      static float temp_iState_min_bed;
-      static float temp_iState_max_bed;
+      #if ENABLED(PID_FIXED_POINT)
+        static pid_fp_t pid_fp_bed;
+      #else
+        static float temp_iState_bed;
+        static float temp_dState_bed;
+        static float pTerm_bed;
+        static float iTerm_bed;
+        static float dTerm_bed;
+        static float pid_error_bed;
+        static float temp_iState_min_bed;
+        static float temp_iState_max_bed;
+      #endif
     #else
       static millis_t next_bed_check_ms;
     #endif
@@ -270,6 +317,16 @@ class Temperature {
       static void start_watching_bed();
     #endif
 
+    #if ENABLED(BED_STABILITY_DETECTION)
+      /**
+       * Bed stability: a line fitted through the last BED_STABILITY_SAMPLES
+       * bed readings. The bed is stable once the line is flat enough and the
+       * readings scatter little around it.
+       */
+      static bool bedIsStable();
+      static long bedStableRemainingSeconds(); // 0 when stable, -1 if unknown
+    #endif
+
     static void setTargetHotend(const float& celsius, uint8_t hotend) {
       #if HOTENDS == 1
         UNUSED(hotend);
@@ -320,6 +377,14 @@ class Temperature {
       static void PID_autotune(float temp, int hotend, int ncycles, bool set_result=false);
     #endif
 
+    /**
+     * Identify the thermal model of a hotend in response to M306 T
+     */
+    #if ENABLED(MPCTEMP)
+      static void MPC_autotune(int hotend);
+      static void MPC_report(int hotend);
+    #endif
+
     /**
      * Update the temp manager when PID values change
      */
@@ -381,10 +446,26 @@ class Temperature {
 
     static float get_pid_output(int e);
 
+    #if ENABLED(PID_ADD_EXTRUSION_RATE)
+      static long lpq_extruded_steps(int e);
+    #endif
+
+    #if ENABLED(MPCTEMP)
+      static float get_mpc_output(int e);
+      static bool MPC_autotune_sample(int hotend, int power, millis_t &next_report_ms);
+    #endif
+
     #if ENABLED(PIDTEMPBED)
       static float get_pid_output_bed();
     #endif
 
+    #if ENABLED(BED_STABILITY_DETECTION)
+      static float bed_stability_temps[BED_STABILITY_SAMPLES];
+      static uint8_t bed_stability_index, bed_stability_count;
+      static millis_t next_bed_stability_ms;
+      static bool bed_stability_fit(uint8_t first, uint8_t count, float &slope, float &stddev);
+    #endif
+
     static void _temp_error(int e, const char* serial_msg, const char* lcd_msg);
     static void min_temp_error(uint8_t e);
     static void max_temp_error(uint8_t e);
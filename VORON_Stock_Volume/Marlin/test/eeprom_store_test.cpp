@@ -0,0 +1,159 @@
+/**
+ * Host test of the EEPROM record store (eeprom_store.cpp)
+ *
+ * A 4K EEPROM is simulated and every byte write is counted. The settings,
+ * the UBL State and six Mesh slots are saved over and over with new data:
+ *  - now and then the power is cut part way through a save, leaving the byte
+ *    being written with any value. After the reset every record must hold
+ *    what was last saved, or for the record being saved, the new data.
+ *  - every so often, and whenever a lap has just ended, the store is read
+ *    afresh, as at boot, and checked.
+ *  - at the end no cell may have been written much more than the rest, and
+ *    the bytes in front of the store not at all.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+// The few Marlin and AVR bits eeprom_store.cpp needs
+#define EEPROM_STORE_HOST_TEST
+#include "../macros.h"
+#define E2END 4095
+#define PROGMEM
+#define pgm_read_word(p) (*(p))
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define MSG_ERR_EEPROM_WRITE ""
+#define SERIAL_ECHO_START
+#define SERIAL_ECHOLNPGM(s)
+#define SERIAL_ERROR_START
+#define SERIAL_ERRORLNPGM(s) (store_errors++)
+
+static long store_errors = 0;
+
+// A pseudo-random 32-bit number, the same on every run
+static uint32_t next_random() {
+  static uint32_t x = 2463534242UL;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+static uint8_t eeprom[E2END + 1];
+static unsigned long wear[E2END + 1];
+static long writes_left = 0;   // The power is cut on the write that brings this to 0
+struct power_cut {};
+
+uint8_t eeprom_read_byte(const uint8_t* p) { return eeprom[(uintptr_t)p]; }
+void eeprom_read_block(void* dst, const void* src, size_t n) { memcpy(dst, eeprom + (uintptr_t)src, n); }
+void eeprom_write_byte(uint8_t* p, uint8_t value) {
+  uintptr_t pos = (uintptr_t)p;
+  wear[pos]++;
+  if (writes_left && !--writes_left) {
+    eeprom[pos] = next_random();  // Half written
+    throw power_cut();
+  }
+  eeprom[pos] = value;
+}
+
+#include "../eeprom_store.cpp"
+
+#define KEYS 8
+static const uint8_t key_type[KEYS] = {
+  EEPROM_RECORD_SETTINGS, EEPROM_RECORD_UBL_STATE,
+  EEPROM_RECORD_MESH, EEPROM_RECORD_MESH, EEPROM_RECORD_MESH, EEPROM_RECORD_MESH, EEPROM_RECORD_MESH, EEPROM_RECORD_MESH
+};
+static const uint8_t key_id[KEYS] = { 0, 0, 0, 1, 2, 3, 4, 5 };
+static const uint16_t key_length[KEYS] = { 240, 24, 196, 196, 196, 196, 196, 196 }; // 7 x 7 Mesh
+
+// The data saved for a key the nth time
+static void make_data(int k, uint32_t n, uint8_t* data) {
+  uint32_t x = (k + 1) * 2654435761UL ^ (n + 1) * 40503UL;
+  for (uint16_t i = 0; i < key_length[k]; i++) {
+    x = x * 1103515245UL + 12345;
+    data[i] = x >> 24;
+  }
+}
+
+static bool holds(int k, uint32_t n) {
+  uint8_t version, want[256];
+  uint16_t length;
+  int pos = eeprom_record_find(key_type[k], key_id[k], version, length);
+  if (pos < 0 || version != 1 || length != key_length[k]) return false;
+  make_data(k, n, want);
+  for (uint16_t i = 0; i < length; i++) if (eeprom[pos + i] != want[i]) return false;
+  return true;
+}
+
+int main() {
+  uint32_t saved[KEYS];   // What each key last saved. Every key is saved once before the test starts.
+  uint8_t data[256];
+  long failures = 0, cuts = 0, boots = 0, saves = 0;
+
+  memset(eeprom, 0xff, sizeof(eeprom));
+  eeprom_store_init();
+  for (int k = 0; k < KEYS; k++) {
+    make_data(k, saved[k] = 0, data);
+    eeprom_record_write(key_type[k], key_id[k], 1, data, key_length[k]);
+  }
+  memset(wear, 0, sizeof(wear));
+
+  for (long i = 0; i < 200000; i++) {
+    int k = next_random() % KEYS;
+    uint32_t n = saved[k] + 1;
+    bool cut = next_random() % 50 == 0, reset = false;
+
+    make_data(k, n, data);
+    writes_left = cut ? 1 + next_random() % 1000 : 0;
+    try {
+      if (eeprom_record_write(key_type[k], key_id[k], 1, data, key_length[k])) {
+        saved[k] = n;
+        saves++;
+      }
+      writes_left = 0;
+    }
+    catch (power_cut) {
+      writes_left = 0;
+      reset = true;
+      cuts++;
+      eeprom_store_init();
+      if (holds(k, n)) saved[k] = n;  // It got as far as the header
+    }
+
+    // A lap that ended right at the end of the EEPROM looks like one that runs all the way round
+    if (reset || i % 1000 == 0 || store_tail == EEPROM_STORE_START) {
+      if (!reset) eeprom_store_init();
+      boots++;
+      for (int j = 0; j < KEYS; j++) {
+        if (!holds(j, saved[j]) && ++failures <= 20)
+          printf("Record %d lost save %lu after %ld saves%s\n", j, (unsigned long)saved[j], i, reset ? " and a power cut" : "");
+      }
+    }
+  }
+
+  std::vector<unsigned long> cells(wear + EEPROM_STORE_START, wear + EEPROM_STORE_END);
+  std::sort(cells.begin(), cells.end());
+  unsigned long median = cells[cells.size() / 2], most = cells.back(), before = 0;
+  for (int pos = 0; pos < EEPROM_STORE_START; pos++) before += wear[pos];
+
+  printf("eeprom_store: %ld saves, %ld power cuts, %ld boots checked, %ld records lost\n", saves, cuts, boots, failures);
+  printf("eeprom_store: cell writes median %lu, most %lu, in front of the store %lu\n", median, most, before);
+  if (store_errors) {
+    printf("%ld saves failed with EEPROM full\n", store_errors);
+    failures++;
+  }
+  if (most > median * 3 / 2 || before) {
+    printf("Some cells wear faster than the rest\n");
+    failures++;
+  }
+  if (failures) {
+    printf("FAIL\n");
+    return 1;
+  }
+  return 0;
+}
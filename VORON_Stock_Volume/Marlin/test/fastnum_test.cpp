@@ -0,0 +1,126 @@
+/**
+ * Host test of the G-code number parser (fastnum.cpp)
+ *
+ * parse_float() must give the same float as the C library for the numbers
+ * G-code uses. strtof() is strtod() rounded once, straight to a float, so
+ * it's the reference:
+ *  - every value from -1000.000 to 1000.000 in steps of 0.001
+ *  - random mantissas of up to 9 digits with 0 to 9 decimals
+ *  - floats printed with 9 significant digits must read back unchanged
+ *  - signs, spaces, missing digits and halfway cases
+ * Numbers with more than 9 significant digits may be a unit in the last
+ * place out, which is all that's promised for them. Fractions below 10^-9
+ * read as 0.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The few Marlin and AVR bits fastnum.cpp needs
+#define FASTNUM_HOST_TEST
+#include "../macros.h"
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_dword(p) (*(p))
+#define strcpy_P strcpy
+#include "../fastnum.cpp"
+
+static long failures = 0;
+
+static void check(const char* text) {
+  const char* end;
+  float got = parse_float(text, &end), want = strtof(text, NULL);
+  if (memcmp(&got, &want, sizeof(float))) {
+    if (++failures <= 20) printf("\"%s\": %.9g, strtof %.9g\n", text, got, want);
+  }
+  else if (*end) {
+    if (++failures <= 20) printf("\"%s\": stopped at \"%s\"\n", text, end);
+  }
+}
+
+// A pseudo-random 32-bit number, the same on every run
+static uint32_t next_random() {
+  static uint32_t x = 2463534242UL;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+int main() {
+  char text[32];
+  long count = 0;
+
+  for (long n = -1000000; n <= 1000000; n++, count++) {
+    sprintf(text, "%s%ld.%03ld", n < 0 ? "-" : "", labs(n) / 1000, labs(n) % 1000);
+    check(text);
+  }
+
+  for (long i = 0; i < 2000000; i++, count++) {
+    uint32_t mantissa = next_random() % 1000000000UL;
+    int decimals = next_random() % 10, digits = sprintf(text + 1, "%09lu", (unsigned long)mantissa);
+    memmove(text, text + 1, digits - decimals);
+    text[digits - decimals] = '.';
+    check(text);
+  }
+
+  for (long i = 0; i < 1000000; i++, count++) {
+    float x;
+    uint32_t bits = (next_random() % (0x49800000UL - 0x3DCCCCCDUL)) + 0x3DCCCCCDUL; // 0.1 to 1048576
+    memcpy(&x, &bits, sizeof(x));
+    sprintf(text, "%.*f", 8 - (int)floor(log10(x)), x); // 9 significant digits
+    float got = parse_float(text);
+    if (memcmp(&got, &x, sizeof(float)) && ++failures <= 20)
+      printf("%.9g printed as \"%s\" reads back as %.9g\n", x, text, got);
+  }
+
+  static const char* const special[] = {
+    "0", "-0", "+0", "0.", ".5", "-.5", "+1.5", "5.", "007", "-0.000",
+    "0.1", "0.2", "0.3", "1.1", "123.456", "-123.456", "3.14159265",
+    "16777216", "16777217", "16777218", "16777219", "33554431", "33554433",
+    "0.000000001", "999999999", "999999999.", "99999999.9", "4294967295",
+    "0.123456789", "1.00000006", "1.00000018", "8388608.5", "8388609.5",
+    "1234567890", "16777217.0000001", "33554433.0000000000001", "0.1000000000000"
+  };
+  for (unsigned int i = 0; i < sizeof(special) / sizeof(*special); i++, count++) check(special[i]);
+
+  // Past 9 significant digits the rest only round or scale the result, so it may be a unit out
+  static const char* const longer[] = {
+    "12345678901", "98765432109876", "0.1234567890123", "1.0000000596046448",
+    "1.00000005960464477539", "1.00000005960464477540", "3.141592653589793"
+  };
+  for (unsigned int i = 0; i < sizeof(longer) / sizeof(*longer); i++, count++) {
+    float got = parse_float(longer[i]), want = strtof(longer[i], NULL);
+    if (got != want && got != nextafterf(want, 0) && got != nextafterf(want, 2 * want)) {
+      printf("\"%s\": %.9g, strtof %.9g\n", longer[i], got, want);
+      failures++;
+    }
+  }
+
+  // Fractions are only read to 9 decimals, so anything smaller is 0 (with its sign)
+  static const char* const tiny[] = { "0.0000000001", "0.00000000001", "-0.0000000009", "0.0000000000000000000001" };
+  for (unsigned int i = 0; i < sizeof(tiny) / sizeof(*tiny); i++, count++) {
+    float got = parse_float(tiny[i]);
+    if (got != 0 || signbit(got) != (tiny[i][0] == '-')) {
+      printf("\"%s\": %.9g, not 0\n", tiny[i], got);
+      failures++;
+    }
+  }
+
+  // Leading spaces are skipped and the number ends at the first other character
+  const char* end;
+  float x = parse_float("  -12.5X10", &end);
+  if (x != -12.5f || strcmp(end, "X10")) {
+    printf("\"  -12.5X10\": %.9g, stopped at \"%s\"\n", x, end);
+    failures++;
+  }
+
+  printf("fastnum: %ld numbers, %ld differ from strtof\n", count, failures);
+  if (failures) {
+    printf("FAIL\n");
+    return 1;
+  }
+  return 0;
+}